@@ -0,0 +1,433 @@
+// Mesure les structures de donnees utilisees pour chaque trame : file circulaire, conversion des paquets et des trames en octets,
+// copie et deplacement des buffers, comparaison des adresses MAC, files de timers et encodeurs/decodeurs de la couche physique.
+// Chaque mesure est repetee plusieurs fois et on garde la meilleure et la mediane, moins sensibles au bruit que la moyenne.
+// Les resultats sont ecrits en JSON sur la sortie standard pour pouvoir comparer deux versions du simulateur.
+//
+// Utilisation : CoreBenchmark [nombre d'operations par mesure] > resultats.json
+// Les resultats ne sont comparables qu'entre des constructions optimisees (CMAKE_BUILD_TYPE=Release) avec les memes options.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../Computer/Driver/Layer/DataType.h"
+#include "../Computer/Driver/Layer/PhysicalLayer.h"
+#include "../DataStructures/CircularQueue.h"
+#include "../DataStructures/DataBuffer.h"
+#include "../DataStructures/MACAddress.h"
+#include "../General/Timer.h"
+
+namespace
+{
+    constexpr size_t Repetitions = 5;
+
+    // Empeche le compilateur de retirer un calcul dont le resultat n'est jamais utilise
+    volatile uint64_t s_sink = 0;
+
+    void keep(uint64_t value)
+    {
+        s_sink = s_sink + value;
+    }
+
+    struct Result
+    {
+        std::string Name;
+        std::vector<std::pair<std::string, uint64_t>> Parameters;
+        size_t Operations;
+        double BestNanoseconds;
+        double MedianNanoseconds;
+    };
+
+    std::vector<Result> s_results;
+
+    // run execute operationCount operations et retourne le temps ecoule. prepare, appele avant chaque repetition,
+    // n'est pas mesure : il remet les structures dans leur etat initial.
+    void measure(const std::string& name, std::vector<std::pair<std::string, uint64_t>> parameters, size_t operationCount,
+        const std::function<std::chrono::steady_clock::duration()>& run, const std::function<void()>& prepare = nullptr)
+    {
+        std::vector<double> samples;
+        for (size_t i = 0; i < Repetitions; ++i)
+        {
+            if (prepare)
+            {
+                prepare();
+            }
+            samples.push_back(std::chrono::duration<double, std::nano>(run()).count() / (double)operationCount);
+        }
+        std::sort(samples.begin(), samples.end());
+        s_results.push_back(Result{ name, std::move(parameters), operationCount, samples.front(), samples[samples.size() / 2] });
+        std::cerr << name << " : " << std::fixed << std::setprecision(1) << samples.front() << " ns" << std::endl;
+    }
+
+    // Mesure operationCount appels a operation(i)
+    template<typename Operation>
+    void measureLoop(const std::string& name, std::vector<std::pair<std::string, uint64_t>> parameters, size_t operationCount,
+        Operation operation, const std::function<void()>& prepare = nullptr)
+    {
+        measure(name, std::move(parameters), operationCount, [&]()
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < operationCount; ++i)
+            {
+                operation(i);
+            }
+            return std::chrono::steady_clock::now() - start;
+        }, prepare);
+    }
+
+    DynamicDataBuffer randomBuffer(uint32_t size, std::mt19937& random)
+    {
+        DynamicDataBuffer buffer(size);
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            buffer[i] = (uint8_t)random();
+        }
+        return buffer;
+    }
+
+    MACAddress randomAddress(std::mt19937& random)
+    {
+        return MACAddress::FromValue(((uint64_t)random() << 32) | random());
+    }
+
+    //===========================================
+
+    // Le producteur et le consommateur sont dans le meme fil : on mesure le cout des copies et des index, pas la synchronisation.
+    // Les donnees sont ecrites par lots pour que les index traversent la fin du buffer circulaire.
+    void benchmarkCircularQueue(size_t operationCount)
+    {
+        std::mt19937 random(1);
+        for (uint32_t recordSize : { 16u, 64u, 256u, 1500u })
+        {
+            CircularQueue queue(64 * 1024);
+            DynamicDataBuffer record = randomBuffer(recordSize, random);
+            size_t batchSize = std::max<size_t>(1, queue.capacity() / 2 / SizeOf<DynamicDataBuffer>::data(record));
+            auto drain = [&queue]() { queue.consume(queue.size()); };
+
+            measureLoop("circular_queue.push_pop", { { "record_size", recordSize } }, operationCount, [&](size_t i)
+            {
+                queue.push(record);
+                if ((i + 1) % batchSize == 0)
+                {
+                    while (queue.size() > 0)
+                    {
+                        keep(queue.pop<DynamicDataBuffer>().size());
+                    }
+                }
+            }, drain);
+
+            // Ecriture directe dans l'espace reserve puis lecture sans copie, comme le fait la couche physique
+            measureLoop("circular_queue.reserve_peek", { { "record_size", recordSize } }, operationCount, [&](size_t i)
+            {
+                queue.reserve(recordSize).copyFrom(0, record.data(), recordSize);
+                queue.commit(recordSize);
+                if ((i + 1) % batchSize == 0)
+                {
+                    while (queue.size() > 0)
+                    {
+                        keep(queue.peek(recordSize).FirstSize);
+                        queue.consume(recordSize);
+                    }
+                }
+            }, drain);
+        }
+    }
+
+    // Les versions par copie construisent un nouveau buffer, les versions par deplacement reutilisent celui des donnees
+    template<typename T>
+    void benchmarkBuffering(const std::string& typeName, T value, size_t operationCount)
+    {
+        std::vector<std::pair<std::string, uint64_t>> parameters = { { "data_size", value.Data.size() } };
+
+        measureLoop("buffering.pack." + typeName, parameters, operationCount, [&](size_t)
+        {
+            keep(Buffering::pack(value).size());
+        });
+
+        DynamicDataBuffer packed = Buffering::pack(value);
+        measureLoop("buffering.unpack." + typeName, parameters, operationCount, [&](size_t)
+        {
+            keep(Buffering::unpack<T>(packed).Data.size());
+        });
+
+        // L'entete est ajoute dans l'espace libre devant les donnees puis retire : un aller-retour ne copie jamais les donnees
+        measureLoop("buffering.pack_unpack_move." + typeName, parameters, operationCount, [&](size_t)
+        {
+            value = Buffering::unpack<T>(Buffering::pack(std::move(value)));
+            keep(value.Data.size());
+        });
+    }
+
+    void benchmarkBuffering(size_t operationCount)
+    {
+        std::mt19937 random(2);
+        for (uint32_t dataSize : { 64u, 1500u })
+        {
+            Packet packet;
+            packet.Destination = randomAddress(random);
+            packet.Source = randomAddress(random);
+            packet.Number = 1;
+            packet.DataCount = (uint16_t)dataSize;
+            packet.Data = DynamicDataBuffer(dataSize, PacketHeadroom, 0);
+            packet.Data.replaceData(randomBuffer(dataSize, random));
+            benchmarkBuffering("packet", packet, operationCount);
+
+            Frame frame;
+            frame.Destination = packet.Destination;
+            frame.Source = packet.Source;
+            frame.Ack = 0;
+            frame.NumberSequence = 1;
+            frame.Data = DynamicDataBuffer(dataSize, HeaderLayout<Frame>::DataOffset, 0);
+            frame.Data.replaceData(randomBuffer(dataSize, random));
+            frame.Size = dataSize;
+            benchmarkBuffering("frame", frame, operationCount);
+        }
+    }
+
+    // Les tailles encadrent le seuil des petits buffers gardes dans l'objet
+    void benchmarkDynamicDataBuffer(size_t operationCount)
+    {
+        std::mt19937 random(3);
+        for (uint32_t size : { 16u, (uint32_t)DynamicDataBuffer::InlineCapacity, (uint32_t)DynamicDataBuffer::InlineCapacity + 1, 1500u })
+        {
+            DynamicDataBuffer source = randomBuffer(size, random);
+            measureLoop("dynamic_data_buffer.copy", { { "size", size } }, operationCount, [&](size_t)
+            {
+                DynamicDataBuffer copy(source);
+                keep(copy.size());
+            });
+
+            // Deux deplacements par operation pour que source retrouve ses donnees
+            measureLoop("dynamic_data_buffer.move", { { "size", size } }, operationCount, [&](size_t)
+            {
+                DynamicDataBuffer moved(std::move(source));
+                source = std::move(moved);
+                keep(source.size());
+            });
+        }
+    }
+
+    void benchmarkMACAddress(size_t operationCount)
+    {
+        std::mt19937 random(4);
+        std::vector<MACAddress> addresses;
+        for (size_t i = 0; i < 1024; ++i)
+        {
+            addresses.push_back(randomAddress(random));
+        }
+        // Les adresses egales sont le cas courant : une trame est comparee a l'adresse de la carte qui la recoit
+        addresses[1] = addresses[0];
+        size_t mask = addresses.size() - 1;
+
+        measureLoop("mac_address.equal", {}, operationCount, [&](size_t i)
+        {
+            keep(addresses[i & mask] == addresses[(i * 7 + 1) & mask]);
+        });
+        measureLoop("mac_address.less", {}, operationCount, [&](size_t i)
+        {
+            keep(addresses[i & mask] < addresses[(i * 7 + 1) & mask]);
+        });
+        measureLoop("mac_address.hash", {}, operationCount, [&](size_t i)
+        {
+            keep(std::hash<MACAddress>()(addresses[i & mask]));
+        });
+    }
+
+    // Patron d'utilisation de LinkLayer : chaque trame envoyee ajoute un timer de retransmission, chaque ACK recu en retire un,
+    // et le timer de ACK est redemarre souvent. activeTimers timers restent actifs pendant les mesures de redemarrage et de retrait.
+    // Si le redemarrage et le retrait sont en O(n), leur nombre est reduit pour les grandes files afin de borner la duree de la mesure.
+    template<typename Queue>
+    void benchmarkTimerQueue(const std::string& queueName, size_t maximumOperationCount, bool linearUpdates)
+    {
+        using Clock = TimerQueue::Clock;
+        for (size_t activeTimers : { 10, 100, 1000, 10000, 100000 })
+        {
+            size_t operationCount = linearUpdates ? std::min(maximumOperationCount, std::max<size_t>(10, 200000 / activeTimers)) : maximumOperationCount;
+            std::mt19937 random(5);
+            std::uniform_int_distribution<int> intervalDistribution(200, 1000);
+            std::uniform_int_distribution<size_t> idDistribution(0, activeTimers - 1);
+            size_t expiredCount = 0;
+            auto callback = [&expiredCount](size_t, NumberSequence) { ++expiredCount; };
+            std::vector<std::pair<std::string, uint64_t>> parameters = { { "timers", activeTimers } };
+
+            std::unique_ptr<Queue> timers;
+            std::vector<size_t> ids;
+            Clock::time_point now;
+            auto fill = [&]()
+            {
+                timers = std::make_unique<Queue>();
+                ids.clear();
+                now = Clock::now();
+                for (size_t i = 0; i < activeTimers; ++i)
+                {
+                    ids.push_back(timers->add(std::chrono::milliseconds(intervalDistribution(random)), callback, (NumberSequence)i, now));
+                }
+            };
+
+            measure("timer." + queueName + ".add", parameters, activeTimers, [&]()
+            {
+                timers = std::make_unique<Queue>();
+                ids.clear();
+                now = Clock::now();
+                auto start = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < activeTimers; ++i)
+                {
+                    ids.push_back(timers->add(std::chrono::milliseconds(intervalDistribution(random)), callback, (NumberSequence)i, now));
+                }
+                return std::chrono::steady_clock::now() - start;
+            });
+
+            measure("timer." + queueName + ".restart", parameters, operationCount, [&]()
+            {
+                auto start = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < operationCount; ++i)
+                {
+                    now += std::chrono::microseconds(10);
+                    keep(timers->restart(ids[idDistribution(random)], (NumberSequence)i, now));
+                }
+                return std::chrono::steady_clock::now() - start;
+            }, fill);
+
+            // Un retrait est toujours suivi d'un ajout pour garder le meme nombre de timers actifs
+            measure("timer." + queueName + ".remove_add", parameters, operationCount, [&]()
+            {
+                auto start = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < operationCount; ++i)
+                {
+                    now += std::chrono::microseconds(10);
+                    size_t& id = ids[idDistribution(random)];
+                    timers->remove(id);
+                    id = timers->add(std::chrono::milliseconds(intervalDistribution(random)), callback, (NumberSequence)i, now);
+                }
+                return std::chrono::steady_clock::now() - start;
+            }, fill);
+
+            // Le fil du Timer fait avancer le temps par pas de 1 ms jusqu'a ce que tous les timers aient expire
+            measure("timer." + queueName + ".expire", parameters, activeTimers, [&]()
+            {
+                std::vector<TimerQueue::TimerInfo> expired;
+                expiredCount = 0;
+                auto start = std::chrono::steady_clock::now();
+                while (timers->size() > 0)
+                {
+                    now += std::chrono::milliseconds(1);
+                    timers->popExpired(now, expired);
+                    for (TimerQueue::TimerInfo& info : expired)
+                    {
+                        info.Function(info.ID, info.NumberData);
+                    }
+                    expired.clear();
+                }
+                keep(expiredCount);
+                return std::chrono::steady_clock::now() - start;
+            }, fill);
+        }
+    }
+
+    // encodeInPlace et decodeBytes sont les versions utilisees par la couche physique
+    void benchmarkEncoderDecoder(const std::string& encoderName, const DataEncoderDecoder& encoderDecoder, size_t operationCount)
+    {
+        std::mt19937 random(6);
+        for (uint32_t dataSize : { 64u, 1500u })
+        {
+            std::vector<std::pair<std::string, uint64_t>> parameters = { { "data_size", dataSize } };
+            DynamicDataBuffer data(dataSize, 0, encoderDecoder.trailerSize());
+            data.replaceData(randomBuffer(dataSize, random));
+            DynamicDataBuffer encoded = encoderDecoder.encode(data);
+
+            measureLoop("encoder_decoder." + encoderName + ".encode", parameters, operationCount, [&](size_t)
+            {
+                keep(encoderDecoder.encode(data).size());
+            });
+            measureLoop("encoder_decoder." + encoderName + ".encode_in_place", parameters, operationCount, [&](size_t)
+            {
+                DynamicDataBuffer copy(data);
+                encoderDecoder.encodeInPlace(copy);
+                keep(copy.size());
+            });
+            measureLoop("encoder_decoder." + encoderName + ".decode", parameters, operationCount, [&](size_t)
+            {
+                keep(encoderDecoder.decode(encoded).second.size());
+            });
+            measureLoop("encoder_decoder." + encoderName + ".decode_bytes", parameters, operationCount, [&](size_t)
+            {
+                keep(encoderDecoder.decodeBytes(encoded.data(), encoded.size()).second.size());
+            });
+        }
+    }
+
+    std::string escape(const std::string& text)
+    {
+        std::string escaped;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    void printJson(std::ostream& out, size_t operationCount)
+    {
+        out << "{" << std::endl;
+        out << "  \"benchmark\": \"CoreBenchmark\"," << std::endl;
+        out << "  \"configuration\": {" << std::endl;
+        out << "    \"operations\": " << operationCount << "," << std::endl;
+        out << "    \"repetitions\": " << Repetitions << "," << std::endl;
+        out << "    \"dynamic_data_buffer_inline_capacity\": " << DYNAMIC_DATA_BUFFER_INLINE_CAPACITY << "," << std::endl;
+        out << "    \"data_buffer_use_pool\": " << (DATA_BUFFER_USE_POOL ? "true" : "false") << std::endl;
+        out << "  }," << std::endl;
+        out << "  \"results\": [" << std::endl;
+        out << std::fixed << std::setprecision(2);
+        for (size_t i = 0; i < s_results.size(); ++i)
+        {
+            const Result& result = s_results[i];
+            out << "    { \"name\": \"" << escape(result.Name) << "\", \"parameters\": {";
+            for (size_t j = 0; j < result.Parameters.size(); ++j)
+            {
+                out << (j == 0 ? " " : ", ") << "\"" << escape(result.Parameters[j].first) << "\": " << result.Parameters[j].second;
+            }
+            out << (result.Parameters.empty() ? "}" : " }")
+                << ", \"operations\": " << result.Operations
+                << ", \"best_ns_per_op\": " << result.BestNanoseconds
+                << ", \"median_ns_per_op\": " << result.MedianNanoseconds << " }"
+                << (i + 1 < s_results.size() ? "," : "") << std::endl;
+        }
+        out << "  ]" << std::endl;
+        out << "}" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    size_t operationCount = 100000;
+    if (argc > 1)
+    {
+        operationCount = (size_t)std::stoul(argv[1]);
+    }
+
+    // La progression va sur la sortie d'erreur pour que la sortie standard ne contienne que le JSON
+    benchmarkCircularQueue(operationCount);
+    benchmarkBuffering(operationCount);
+    benchmarkDynamicDataBuffer(operationCount);
+    benchmarkMACAddress(operationCount);
+    benchmarkTimerQueue<HeapTimerQueue>("heap", operationCount, true);
+    benchmarkTimerQueue<TimingWheelTimerQueue>("wheel", operationCount, false);
+    benchmarkEncoderDecoder("passthrough", PassthroughDataEncoderDecoder(), operationCount);
+    benchmarkEncoderDecoder("hamming", HammingDataEncoderDecoder(), operationCount);
+    benchmarkEncoderDecoder("crc", CRCDataEncoderDecoder(), operationCount);
+
+    printJson(std::cout, operationCount);
+    return 0;
+}
\ No newline at end of file
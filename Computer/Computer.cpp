@@ -1,7 +1,7 @@
 #include "Computer.h"
 
 #include "../DataStructures/MACAddress.h"
-#include "../General/Logger.h"
+#include "../General/Log.h"
 
 #include <fstream>
 #include <iostream>
@@ -9,25 +9,46 @@
 Computer::Computer(size_t numberID)
     : m_id(numberID)
     , m_configuration(std::string("Computer") + std::to_string(numberID) + ".txt")
-    , m_sendingFileCount(0)
     , m_continueSending(false)
+    , m_sendingFileCount(0)
+    , m_nextFileToSend(0)
 {
     m_card = std::make_unique<NetworkInterfaceCard>(m_configuration);
 
     std::ifstream filesNames(std::string("Computer") + std::to_string(numberID) + "Files.txt");
     if (filesNames.is_open())
     {
+        // Chaque ligne est de la forme fichier=adresse MAC de destination
         std::string line;
         while (std::getline(filesNames, line))
         {
-            m_filesToTransfert.push_back(line);
+            size_t pos = line.find('=');
+            if (pos != std::string::npos)
+            {
+                m_filesToTransfert.push_back(FileTransfer{ line.substr(0, pos), MACAddress::FromString(line.substr(pos + 1)) });
+            }
         }
         filesNames.close();
     }
 }
 
+Computer::Computer(size_t numberID, const Configuration& config, std::vector<FileTransfer> filesToTransfert)
+    : m_id(numberID)
+    , m_configuration(config)
+    , m_filesToTransfert(std::move(filesToTransfert))
+    , m_continueSending(false)
+    , m_sendingFileCount(0)
+    , m_nextFileToSend(0)
+{
+    m_card = std::make_unique<NetworkInterfaceCard>(m_configuration);
+}
+
 Computer::~Computer()
 {
+    if (m_sendingTask)
+    {
+        m_sendingTask->stop();
+    }
     if (m_sendingThread.joinable())
     {
         m_sendingThread.join();
@@ -36,47 +57,55 @@ Computer::~Computer()
 
 void Computer::sendAllFiles()
 {
-    for (auto it = m_filesToTransfert.cbegin(); it != m_filesToTransfert.cend(); ++it)
+    while (m_continueSending && !sendingTerminated())
     {
-        if (m_continueSending)
-        {
-            const std::string& line = *it;
-            size_t pos = line.find('=');
-            if (pos != std::string::npos)
-            {
-                std::string fileName = line.substr(0, pos);
-                std::string mac = line.substr(pos + 1);
-
-                uint8_t adr[6] = { (uint8_t)0xFF, (uint8_t)0xFF, (uint8_t)0xFF, (uint8_t)0xFF, (uint8_t)0xFF, (uint8_t)0xFF };
-                size_t posMac = mac.find(':');
-                size_t start = 0;
-                size_t index = 0;
-                while (posMac != std::string::npos)
-                {
-                    std::string subAdr = mac.substr(start, posMac - start);
-                    adr[index] = (uint8_t)std::stoi(subAdr, nullptr, 16);
-                    ++index;
-                    start = posMac + 1;
-                    posMac = mac.find(':', posMac + 1);
-                }
-                std::string lastSubAdr = mac.substr(start, mac.size() - start);
-                adr[index] = (uint8_t)std::stoi(lastSubAdr, nullptr, 16);
-                MACAddress address = MACAddress(adr);
-                send_file_to(address, fileName);
-                m_sendingFileCount++;
-            }
-        }
-        else
+        if (!sendingStep())
         {
-            break;
+            // Attente passive de la fin de l'envoi du fichier en cours
+            m_sendingNotifier.wait([this]() { return !m_continueSending || m_card->sendingFinished(); });
         }
     }
 }
 
+bool Computer::sendingStep()
+{
+    if (!m_continueSending || !m_card->sendingFinished())
+    {
+        return false;
+    }
+
+    if (m_sendingFileCount < m_nextFileToSend)
+    {
+        LOG_INFO(LogCategory::Net, "Fichier {} envoye.", m_filesToTransfert[m_sendingFileCount].FileName);
+        m_sendingFileCount++;
+    }
+    if (m_nextFileToSend >= m_filesToTransfert.size())
+    {
+        return false;
+    }
+
+    const FileTransfer& transfer = m_filesToTransfert[m_nextFileToSend++];
+    LOG_INFO(LogCategory::Net, "Debut de l'envoi du fichier {} par l'ordinateur {} a l'adresse {}", transfer.FileName, m_id, transfer.Destination);
+    m_card->start_sending_process(transfer);
+    return true;
+}
+
 void Computer::start()
 {
+    m_card->getDriver().getNetworkLayer().setSendingFinishedNotifier(&m_sendingNotifier);
+    m_card->start();
     m_continueSending = true;
-    m_sendingThread = std::thread(&Computer::sendAllFiles, this);
+    TaskScheduler* scheduler = TaskScheduler::Active();
+    if (scheduler)
+    {
+        m_sendingTask = std::make_unique<Task>(*scheduler, [this]() { return sendingStep(); });
+        m_sendingNotifier.setTask(m_sendingTask.get());
+        m_sendingTask->start();
+    }
+    else
+    {
+        m_sendingThread = std::thread(&Computer::sendAllFiles, this);
+    }
 }
 
 bool Computer::sendingTerminated() const
@@ -99,23 +128,27 @@ NetworkInterfaceCard& Computer::getNetworkInterfaceCard()
     return *m_card;
 }
 
+const Configuration& Computer::getConfiguration() const
+{
+    return m_configuration;
+}
+
 void Computer::send_file_to(const MACAddress& to, const std::string& fileName)
 {
+    LOG_INFO(LogCategory::Net, "Debut de l'envoi du fichier {} par l'ordinateur {} a l'adresse {}", fileName, m_id, to);
+    m_card->start_sending_process(to, fileName);
+    // Attente passive de l'envoi complet du fichier
+    while (m_continueSending && !m_card->sendingFinished())
     {
-        Logger log(std::cout);
-        log << "Debut de l'envoi du fichier " << fileName << " par l'ordinateur " << m_id << " a l'adresse " << to << std::endl;
+        m_sendingNotifier.wait([this]() { return !m_continueSending || m_card->sendingFinished(); });
     }
-    m_card->start_sending_process(to, fileName);
-    while (m_continueSending && !m_card->sendingFinished()); // Attente active pour l'envoi complet du fichier
 
     if (m_continueSending)
     {
-        Logger log(std::cout);
-        log << "Fichier " << fileName << " envoye." << std::endl;
+        LOG_INFO(LogCategory::Net, "Fichier {} envoye.", fileName);
     }
     else
     {
-        Logger log(std::cout);
-        log << "Envoi arrete" << std::endl;
+        LOG_INFO(LogCategory::Net, "Envoi arrete");
     }
 }
\ No newline at end of file
@@ -6,34 +6,44 @@
 #include <thread>
 #include <vector>
 
+#include "../DataStructures/MACAddress.h"
 #include "../General/Configuration.h"
+#include "../General/Executor.h"
+#include "../General/Notifier.h"
 #include "Hardware/NetworkInterfaceCard.h"
 
-class MACAddress;
-
 class Computer
 {
     size_t m_id;
     Configuration m_configuration;
+    std::unique_ptr<Task> m_sendingTask; // Remplace le fil d'envoi des fichiers lorsque l'Executor est utilise
+    Notifier m_sendingNotifier; // Notifie par la couche reseau a la fin de l'envoi de chaque fichier
     std::unique_ptr<NetworkInterfaceCard> m_card;
-    std::vector<std::string> m_filesToTransfert;
+    std::vector<FileTransfer> m_filesToTransfert;
     std::atomic<bool> m_continueSending;
     std::atomic<unsigned int> m_sendingFileCount;
+    size_t m_nextFileToSend;
     std::thread m_sendingThread;
 
     void sendAllFiles();
+    // Commence l'envoi du prochain fichier lorsque le precedent est termine. Retourne faux s'il n'y avait rien a faire.
+    bool sendingStep();
 
 public:
+    // Lit la configuration dans ComputerN.txt et les fichiers a envoyer dans ComputerNFiles.txt
     Computer(size_t numberID);
+    Computer(size_t numberID, const Configuration& config, std::vector<FileTransfer> filesToTransfert);
     ~Computer();
 
     bool sendingTerminated() const;
     unsigned int sentFileCount() const;
     unsigned int receivedFileCount() const;
 
+    // Demarre les fils d'execution de la carte reseau puis l'envoi des fichiers
     void start();
 
     NetworkInterfaceCard& getNetworkInterfaceCard();
+    const Configuration& getConfiguration() const;
 
     void send_file_to(const MACAddress& address, const std::string& fileName);
 };
@@ -1,7 +1,12 @@
 #ifndef _COMPUTER_DRIVER_LAYER_DATA_TYPE_H_
 #define _COMPUTER_DRIVER_LAYER_DATA_TYPE_H_
 
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 #include "../../../DataStructures/DataBuffer.h"
 #include "../../../DataStructures/MACAddress.h"
@@ -31,36 +36,62 @@ struct Frame
 {
     MACAddress Destination; // 6 octets
     MACAddress Source; // 6 octets
-    NumberSequence Ack; // 2 octets
-    NumberSequence NumberSequence; // 2 octets
+    ::NumberSequence Ack; // 2 octets
+    ::NumberSequence NumberSequence; // 2 octets
     uint32_t Size; // 4 octets
     DynamicDataBuffer Data; // 4 + X octets. Les 4 premiers octets indique la valeur de X
 };
 
-// Structure utilitaire permettant de creer un Buffer a partir d'un objet ou de creer un objet a partir d'un Buffer
-// Voir PhysicalLayer.cpp, methodes sending() et receiving() pour un exemple d'utilisation
-struct Buffering
+
+// Disposition de l'entete d'un objet de type Packet et Frame dans sa representation en octets.
+// L'entete est suivi de la taille des donnees (4 octets) puis des donnees.
+template<typename T>
+struct HeaderLayout;
+
+template<>
+struct HeaderLayout<Packet>
 {
-    template<typename T>
-    static DynamicDataBuffer pack(const T& value)
-    {
-        ToDataPtr<T> toDataPtr(value);
-        uint32_t bufferSize = (uint32_t)toDataPtr.size();
-        DynamicDataBuffer buffer = DynamicDataBuffer(bufferSize);
-        for (uint32_t i = 0; i < bufferSize; ++i)
-        {
-            buffer[i] = toDataPtr[i];
-        }
-        return buffer;
-    }
+    static constexpr size_t DestinationOffset = 0;
+    static constexpr size_t SourceOffset = DestinationOffset + SizeOf<MACAddress>::value;
+    static constexpr size_t NumberOffset = SourceOffset + SizeOf<MACAddress>::value;
+    static constexpr size_t DataCountOffset = NumberOffset + sizeof(NumberSequence);
+    static constexpr size_t Size = DataCountOffset + sizeof(uint16_t);
+    static constexpr size_t DataOffset = Size + sizeof(uint32_t); // Debut des donnees, apres leur taille
+};
 
-    template<typename T>
-    static T unpack(const DynamicDataBuffer& buffer)
-    {
-        return FromDataPtr<T>::get(buffer.data(), buffer.size());
-    }
+template<>
+struct HeaderLayout<Frame>
+{
+    static constexpr size_t DestinationOffset = 0;
+    static constexpr size_t SourceOffset = DestinationOffset + SizeOf<MACAddress>::value;
+    static constexpr size_t AckOffset = SourceOffset + SizeOf<MACAddress>::value;
+    static constexpr size_t NumberSequenceOffset = AckOffset + sizeof(NumberSequence);
+    static constexpr size_t SizeOffset = NumberSequenceOffset + sizeof(NumberSequence);
+    static constexpr size_t Size = SizeOffset + sizeof(uint32_t);
+    static constexpr size_t DataOffset = Size + sizeof(uint32_t); // Debut des donnees, apres leur taille
 };
 
+// L'entete est copie en un seul bloc a partir du debut de la structure : les membres doivent donc etre
+// exactement a la meme position dans la structure que dans la representation en octets.
+static_assert(std::is_standard_layout<Packet>::value && std::is_standard_layout<Frame>::value, "Packet et Frame doivent avoir une disposition standard pour copier leur entete en bloc");
+static_assert(offsetof(Packet, Destination) == HeaderLayout<Packet>::DestinationOffset, "Disposition de l'entete de Packet invalide");
+static_assert(offsetof(Packet, Source) == HeaderLayout<Packet>::SourceOffset, "Disposition de l'entete de Packet invalide");
+static_assert(offsetof(Packet, Number) == HeaderLayout<Packet>::NumberOffset, "Disposition de l'entete de Packet invalide");
+static_assert(offsetof(Packet, DataCount) == HeaderLayout<Packet>::DataCountOffset, "Disposition de l'entete de Packet invalide");
+static_assert(offsetof(Packet, Data) >= HeaderLayout<Packet>::Size, "Disposition de l'entete de Packet invalide");
+static_assert(offsetof(Frame, Destination) == HeaderLayout<Frame>::DestinationOffset, "Disposition de l'entete de Frame invalide");
+static_assert(offsetof(Frame, Source) == HeaderLayout<Frame>::SourceOffset, "Disposition de l'entete de Frame invalide");
+static_assert(offsetof(Frame, Ack) == HeaderLayout<Frame>::AckOffset, "Disposition de l'entete de Frame invalide");
+static_assert(offsetof(Frame, NumberSequence) == HeaderLayout<Frame>::NumberSequenceOffset, "Disposition de l'entete de Frame invalide");
+static_assert(offsetof(Frame, Size) == HeaderLayout<Frame>::SizeOffset, "Disposition de l'entete de Frame invalide");
+static_assert(offsetof(Frame, Data) >= HeaderLayout<Frame>::Size, "Disposition de l'entete de Frame invalide");
+// Le format sur le reseau ne doit pas changer
+static_assert(HeaderLayout<Packet>::Size == 16 && HeaderLayout<Frame>::Size == 20, "La taille des entetes a change");
+
+// Espace libre a reserver devant les donnees d'un paquet pour que la couche liaison puis la couche physique
+// y ajoutent leurs entetes sans copie : entete du paquet et taille de ses donnees, puis entete de la trame et taille de ses donnees
+static constexpr uint32_t PacketHeadroom = (uint32_t)(HeaderLayout<Packet>::DataOffset + HeaderLayout<Frame>::DataOffset);
+
 
 // Utilitaire pour verifier la taille reelle d'un objet de type Packet et Frame
 // Cette specialisation remplace l'implementation de base de la structure dans Utils.h lorsque le type T est Packet ou Frame
@@ -69,7 +100,7 @@ struct SizeOf<Packet>
 {
     static size_t data(const Packet& data)
     {
-        return 2* SizeOf<MACAddress>::value + sizeof(NumberSequence) + sizeof(uint16_t) + SizeOf<DynamicDataBuffer>::data(data.Data);
+        return HeaderLayout<Packet>::Size + SizeOf<DynamicDataBuffer>::data(data.Data);
     }
 };
 
@@ -78,19 +109,36 @@ struct SizeOf<Frame>
 {
     static size_t data(const Frame& data)
     {
-        return 2 * SizeOf<MACAddress>::value + 2 * sizeof(NumberSequence) + sizeof(uint32_t) + SizeOf<DynamicDataBuffer>::data(data.Data);
+        return HeaderLayout<Frame>::Size + SizeOf<DynamicDataBuffer>::data(data.Data);
     }
 };
 
 
+// Paquet et trame de taille nominale, transportant dataSize octets de donnees de la couche reseau.
+// Servent a convertir les tailles de buffer configurees (en octets) en nombre d'objets.
+inline Packet NominalPacket(uint32_t dataSize)
+{
+    Packet packet;
+    packet.Data = DynamicDataBuffer(dataSize);
+    return packet;
+}
+
+inline Frame NominalFrame(uint32_t dataSize)
+{
+    Frame frame;
+    frame.Data = DynamicDataBuffer((uint32_t)SizeOf<Packet>::data(NominalPacket(dataSize)));
+    return frame;
+}
+
+
 // Utilitaire pour verifier s'il y a assez de donnee dans une suite d'octet pour reconstruire correctement un objet de type Packet et Frame
 // Cette specialisation remplace l'implementation de base de la structure dans Utils.h lorsque le type T est Packet ou Frame
-template<>
-struct EnoughDataFor<Packet>
+template<typename T>
+struct HeaderEnoughDataFor
 {
     static bool in(const uint8_t* dataBuffer, size_t bufferStart, size_t bufferSize, size_t bufferCapacity)
     {
-        size_t minimumSizeNeeded = 2 * SizeOf<MACAddress>::value + sizeof(NumberSequence) + sizeof(uint16_t);
+        size_t minimumSizeNeeded = HeaderLayout<T>::Size;
         if (bufferSize > minimumSizeNeeded)
         {
             return EnoughDataFor<DynamicDataBuffer>::in(dataBuffer, bufferStart + minimumSizeNeeded, bufferSize - minimumSizeNeeded, bufferCapacity);
@@ -103,121 +151,176 @@ struct EnoughDataFor<Packet>
 };
 
 template<>
-struct EnoughDataFor<Frame>
+struct EnoughDataFor<Packet> : HeaderEnoughDataFor<Packet>
+{
+};
+
+template<>
+struct EnoughDataFor<Frame> : HeaderEnoughDataFor<Frame>
 {
-    static bool in(const uint8_t* dataBuffer, size_t bufferStart, size_t bufferSize, size_t bufferCapacity)
-    {
-        size_t minimumSizeNeeded = 2 * SizeOf<MACAddress>::value + 2 * sizeof(NumberSequence) + sizeof(uint32_t);
-        if (bufferSize > minimumSizeNeeded)
-        {
-            return EnoughDataFor<DynamicDataBuffer>::in(dataBuffer, bufferStart + minimumSizeNeeded, bufferSize - minimumSizeNeeded, bufferCapacity);
-        }
-        else
-        {
-            return false;
-        }
-    }
 };
 
 // Utilitaire pour acceder a la representation equivalente a une suite d'octet pour ecrire correctement un objet de type Packet et Frame
 // Cette specialisation remplace l'implementation de base de la structure dans Utils.h lorsque le type T est Packet ou Frame
-template<>
-struct ToDataPtr<Packet>
+// L'entete est ecrit en une seule copie, puis les donnees avec leur taille
+template<typename T>
+struct HeaderToDataPtr
 {
-    const Packet& Data;
-    ToDataPtr<DynamicDataBuffer> DataBufferToPtrObj;
+    const T& Data;
+
+    HeaderToDataPtr(const T& data) : Data(data) {}
 
-    ToDataPtr(const Packet& data) : Data(data), DataBufferToPtrObj(data.Data) {}
+    size_t size() const { return SizeOf<T>::data(Data); }
 
-    uint8_t operator[](size_t byteIndex)
+    size_t serializeInto(ByteSpan buffer) const
     {
-        size_t bufferOffset = 2 * SizeOf<MACAddress>::value + sizeof(NumberSequence) + sizeof(uint16_t);
-        if (byteIndex < bufferOffset)
-        {
-            const uint8_t* dataPtr = reinterpret_cast<const uint8_t*>(&Data);
-            return dataPtr[byteIndex];
-        }
-        else
+        size_t headerSize = HeaderLayout<T>::Size;
+        if (buffer.Size < headerSize)
         {
-            return  DataBufferToPtrObj[byteIndex - bufferOffset];
+            throw std::out_of_range("Le buffer est trop petit pour contenir la representation de l'objet.");
         }
+        std::memcpy(buffer.Data, reinterpret_cast<const uint8_t*>(&Data), headerSize);
+        return headerSize + ToDataPtr<DynamicDataBuffer>(Data.Data).serializeInto(ByteSpan{ buffer.Data + headerSize, buffer.Size - headerSize });
     }
 
-    size_t size() const { return SizeOf<Packet>::data(Data); }
+    template<typename Function>
+    void forEachSegment(Function function) const
+    {
+        function(reinterpret_cast<const uint8_t*>(&Data), HeaderLayout<T>::Size);
+        ToDataPtr<DynamicDataBuffer>(Data.Data).forEachSegment(function);
+    }
 };
 
 template<>
-struct ToDataPtr<Frame>
+struct ToDataPtr<Packet> : HeaderToDataPtr<Packet>
 {
-    const Frame& Data;
-    ToDataPtr<DynamicDataBuffer> DataBufferToPtrObj;
-
-    ToDataPtr(const Frame& data) : Data(data), DataBufferToPtrObj(data.Data) {}
-
-    uint8_t operator[](size_t byteIndex)
-    {
-        size_t bufferOffset = 2 * SizeOf<MACAddress>::value + 2 * sizeof(NumberSequence) + sizeof(uint32_t);
-        if (byteIndex < bufferOffset)
-        {
-            const uint8_t* dataPtr = reinterpret_cast<const uint8_t*>(&Data);
-            return dataPtr[byteIndex];
-        }
-        else
-        {
-            return  DataBufferToPtrObj[byteIndex - bufferOffset];
-        }
-    }
+    ToDataPtr(const Packet& data) : HeaderToDataPtr<Packet>(data) {}
+};
 
-    size_t size() const { return SizeOf<Frame>::data(Data); }
+template<>
+struct ToDataPtr<Frame> : HeaderToDataPtr<Frame>
+{
+    ToDataPtr(const Frame& data) : HeaderToDataPtr<Frame>(data) {}
 };
 
 // Utilitaire pour lire un objet dans une suite d'octet pour reconstruire correctement un objet de type Packet et Frame
 // Cette specialisation remplace l'implementation de base de la structure dans Utils.h lorsque le type T est Packet ou Frame
-template<>
-struct FromDataPtr<Packet>
+template<typename T>
+struct HeaderFromDataPtr
 {
     static size_t size(const uint8_t* dataBuffer, size_t bufferStart, size_t bufferCapacity)
     {
-        size_t bufferOffset = 2 * SizeOf<MACAddress>::value + sizeof(NumberSequence) + sizeof(uint16_t);
-        return bufferOffset + FromDataPtr<DynamicDataBuffer>::size(dataBuffer, (bufferStart + bufferOffset) % bufferCapacity, bufferCapacity);
+        size_t headerSize = HeaderLayout<T>::Size;
+        return headerSize + FromDataPtr<DynamicDataBuffer>::size(dataBuffer, (bufferStart + headerSize) % bufferCapacity, bufferCapacity);
     }
 
-    static Packet get(const uint8_t* data, size_t dataSize)
+    static T get(const uint8_t* data, size_t dataSize)
     {
-        Packet packet;
-        uint8_t* packetData = reinterpret_cast<uint8_t*>(&packet);
-        size_t bufferOffset = 2 * SizeOf<MACAddress>::value + sizeof(NumberSequence) + sizeof(uint16_t);
-        for (size_t i = 0; i < bufferOffset; ++i)
-        {
-            packetData[i] = data[i];
-        }
-        packet.Data = FromDataPtr<DynamicDataBuffer>::get(&data[bufferOffset], dataSize-bufferOffset);
-        return packet;
+        size_t headerSize = HeaderLayout<T>::Size;
+        T value;
+        std::memcpy(reinterpret_cast<uint8_t*>(&value), data, headerSize);
+        value.Data = FromDataPtr<DynamicDataBuffer>::get(&data[headerSize], dataSize - headerSize);
+        return value;
+    }
+
+    static T deserializeFrom(ConstByteSpan buffer)
+    {
+        return get(buffer.Data, buffer.Size);
     }
 };
 
 template<>
-struct FromDataPtr<Frame>
+struct FromDataPtr<Packet> : HeaderFromDataPtr<Packet>
 {
-    static size_t size(const uint8_t* dataBuffer, size_t bufferStart, size_t bufferCapacity)
+};
+
+template<>
+struct FromDataPtr<Frame> : HeaderFromDataPtr<Frame>
+{
+};
+
+
+// Structure utilitaire permettant de creer un Buffer a partir d'un objet ou de creer un objet a partir d'un Buffer
+// Voir PhysicalLayer.cpp, methodes sending() et receiving() pour un exemple d'utilisation
+// Les versions qui prennent l'objet ou le buffer par deplacement (&&) reutilisent le buffer de donnees :
+// l'entete est ecrit dans son espace libre ou retire de son debut, sans recopier les donnees.
+struct Buffering
+{
+    template<typename T>
+    static DynamicDataBuffer pack(const T& value)
+    {
+        ToDataPtr<T> toDataPtr(value);
+        DynamicDataBuffer buffer = DynamicDataBuffer((uint32_t)toDataPtr.size());
+        toDataPtr.serializeInto(ByteSpan{ buffer.data(), buffer.size() });
+        return buffer;
+    }
+
+    template<typename T>
+    static T unpack(const DynamicDataBuffer& buffer)
+    {
+        return FromDataPtr<T>::deserializeFrom(ConstByteSpan{ buffer.data(), buffer.size() });
+    }
+
+    static DynamicDataBuffer pack(Packet&& packet)
+    {
+        return prependHeader(packet, std::move(packet.Data));
+    }
+
+    static DynamicDataBuffer pack(Frame&& frame)
+    {
+        return prependHeader(frame, std::move(frame.Data));
+    }
+
+    template<typename T>
+    static T unpack(DynamicDataBuffer&& buffer);
+
+private:
+    // Ajoute devant les donnees la taille des donnees puis l'entete, comme le fait ToDataPtr
+    template<typename T>
+    static DynamicDataBuffer prependHeader(const T& value, DynamicDataBuffer&& data)
     {
-        size_t bufferOffset = 2 * SizeOf<MACAddress>::value + 2 * sizeof(NumberSequence) + sizeof(uint32_t);
-        return bufferOffset + FromDataPtr<DynamicDataBuffer>::size(dataBuffer, (bufferStart + bufferOffset) % bufferCapacity, bufferCapacity);
+        size_t headerSize = HeaderLayout<T>::Size;
+        DynamicDataBuffer buffer(std::move(data));
+        uint32_t dataSize = buffer.size();
+        std::memcpy(buffer.prepend(sizeof(uint32_t)), &dataSize, sizeof(uint32_t));
+        std::memcpy(buffer.prepend((uint32_t)headerSize), reinterpret_cast<const uint8_t*>(&value), headerSize);
+        return buffer;
     }
 
-    static Frame get(const uint8_t* data, size_t dataSize)
+    // Copie l'entete dans l'objet puis retire l'entete et la taille du debut du buffer, qui devient le buffer de donnees de l'objet.
+    // Le buffer doit contenir au moins l'entete et la taille (voir HeaderLayout<T>::DataOffset).
+    template<typename T>
+    static T stripHeader(DynamicDataBuffer&& buffer)
     {
-        Frame packet;
-        uint8_t* packetData = reinterpret_cast<uint8_t*>(&packet);
-        size_t bufferOffset = 2 * SizeOf<MACAddress>::value + 2 * sizeof(NumberSequence) + sizeof(uint32_t);
-        for (size_t i = 0; i < bufferOffset; ++i)
+        if (buffer.size() < HeaderLayout<T>::DataOffset)
         {
-            packetData[i] = data[i];
+            throw std::out_of_range("Le buffer est trop petit pour contenir l'entete de l'objet.");
         }
-        packet.Data = FromDataPtr<DynamicDataBuffer>::get(&data[bufferOffset], dataSize - bufferOffset);
-        return packet;
+        T value;
+        std::memcpy(reinterpret_cast<uint8_t*>(&value), buffer.data(), HeaderLayout<T>::Size);
+        buffer.trimFront((uint32_t)HeaderLayout<T>::DataOffset);
+        value.Data = std::move(buffer);
+        return value;
     }
 };
 
+template<typename T>
+T Buffering::unpack(DynamicDataBuffer&& buffer)
+{
+    return unpack<T>(static_cast<const DynamicDataBuffer&>(buffer));
+}
+
+template<>
+inline Packet Buffering::unpack<Packet>(DynamicDataBuffer&& buffer)
+{
+    return stripHeader<Packet>(std::move(buffer));
+}
+
+template<>
+inline Frame Buffering::unpack<Frame>(DynamicDataBuffer&& buffer)
+{
+    return stripHeader<Frame>(std::move(buffer));
+}
+
 
 #endif //_COMPUTER_DRIVER_LAYER_DATA_TYPE_H_
@@ -2,7 +2,9 @@
 #include "../NetworkDriver.h"
 
 #include "../../../General/Configuration.h"
-#include "../../../General/Logger.h"
+#include "../../../General/Executor.h"
+#include "../../../General/Log.h"
+#include "../../../Simulation/EventSimulator.h"
 
 #include <iostream>
 #include <map>
@@ -11,16 +13,42 @@
 LinkLayer::LinkLayer(NetworkDriver* driver, const Configuration& config)
     : m_driver(driver)
     , m_address(config)
-    , m_receivingQueue(config.get(Configuration::LINK_LAYER_RECEIVING_BUFFER_SIZE))
-    , m_sendingQueue(config.get(Configuration::LINK_LAYER_SENDING_BUFFER_SIZE))
     , m_maximumBufferedFrameCount(config.get(Configuration::LINK_LAYER_MAXIMUM_BUFFERED_FRAME))
     , m_transmissionTimeout(config.get(Configuration::LINK_LAYER_TIMEOUT))
+    , m_sendingQueue(ObjectQueue<Frame>::CapacityFor(config.get(Configuration::LINK_LAYER_SENDING_BUFFER_SIZE), NominalFrame(config.get(Configuration::NETWORK_LAYER_DATA_SIZE))))
+    , m_receivingQueue(ObjectQueue<Frame>::CapacityFor(config.get(Configuration::LINK_LAYER_RECEIVING_BUFFER_SIZE), NominalFrame(config.get(Configuration::NETWORK_LAYER_DATA_SIZE))))
+    , m_sendingQueueWatch("link_sending", m_address, m_sendingQueue)
+    , m_receivingQueueWatch("link_receiving", m_address, m_receivingQueue)
+    , m_ackTimerID(Timer::InvalidTimerID)
+    , m_sentFrameCount(0)
+    , m_retransmissionCount(0)
     , m_executeReceiving(false)
     , m_executeSending(false)
 {
     m_maximumSequence = m_maximumBufferedFrameCount * 2 - 1;
     m_ackTimeout = m_transmissionTimeout / 4;
-    m_timers = std::make_unique<Timer>();
+    if (EventSimulator::Enabled())
+    {
+        m_timers = std::make_unique<TimerHandle>(EventSimulator::Shared());
+    }
+    else
+    {
+        m_timers = std::make_unique<TimerHandle>(TimerService::Shared());
+    }
+
+    // Le fil d'envoi attend de l'espace dans le buffer de sortie, le fil de reception attend des trames dans le buffer d'entree
+    m_sendingQueue.setSpaceNotifier(&m_senderNotifier);
+    m_receivingQueue.setDataNotifier(&m_receiverNotifier);
+
+    m_windowSize = (m_maximumSequence + 1) / 2;
+    TaskScheduler* scheduler = TaskScheduler::Active();
+    if (scheduler)
+    {
+        m_senderTask = std::make_unique<Task>(*scheduler, [this]() { return senderStep(); });
+        m_receiverTask = std::make_unique<Task>(*scheduler, [this]() { return receiverStep(); });
+        m_senderNotifier.setTask(m_senderTask.get());
+        m_receiverNotifier.setTask(m_receiverTask.get());
+    }
 }
 
 LinkLayer::~LinkLayer()
@@ -41,11 +69,27 @@ void LinkLayer::start()
 
     m_timers->start();
 
-    m_executeReceiving = true;
-    m_receiverThread = std::thread(&LinkLayer::receiverCallback, this);
+    // Les fenetres d'envoi et de reception repartent de zero a chaque demarrage
+	m_sendingWindows.clear();
+	m_bufferedCount = 0;
+	m_pendingFrames.clear();
+	m_ackTimerID = Timer::InvalidTimerID;
 
+	m_receivingWindows.clear();
+	m_pendingPackets.clear();
+
+    m_executeReceiving = true;
     m_executeSending = true;
-    m_senderThread = std::thread(&LinkLayer::senderCallback, this);
+    if (m_senderTask)
+    {
+        m_receiverTask->start();
+        m_senderTask->start();
+    }
+    else
+    {
+        m_receiverThread = std::thread(&LinkLayer::receiverCallback, this);
+        m_senderThread = std::thread(&LinkLayer::senderCallback, this);
+    }
 }
 
 // Arrete les fils d'execution pour l'envoi et la reception des trames
@@ -54,12 +98,22 @@ void LinkLayer::stop()
     m_timers->stop();
 
     m_executeReceiving = false;
+    if (m_receiverTask)
+    {
+        m_receiverTask->stop();
+    }
+    m_receiverNotifier.notify();
     if (m_receiverThread.joinable())
     {
         m_receiverThread.join();
     }
 
     m_executeSending = false;
+    if (m_senderTask)
+    {
+        m_senderTask->stop();
+    }
+    m_senderNotifier.notify();
     if (m_senderThread.joinable())
     {
         m_senderThread.join();
@@ -67,62 +121,139 @@ void LinkLayer::stop()
 }
 
 // Indique vrai si on peut envoyer des donnees dans le buffer de sortie, faux si le buffer est plein
-bool LinkLayer::canSendData(const Frame& data) const
+bool LinkLayer::canSendData() const
 {
-    return m_sendingQueue.canWrite<Frame>(data);
+    return m_sendingQueue.canWrite();
 }
 
 // Indique vrai si des donnees sont disponibles dans le buffer d'entree, faux s'il n'y a rien
 bool LinkLayer::dataReceived() const
 {
-    return m_receivingQueue.canRead<Frame>();
+    return m_receivingQueue.canRead();
 }
 
 // Indique vrai s'il y a des donnees dans le buffer de sortie
 bool LinkLayer::dataReady() const
 {
-    return m_sendingQueue.canRead<Frame>();
+    return m_sendingQueue.canRead();
 }
 
 // Recupere la prochaine donnee du buffer de sortie
 Frame LinkLayer::getNextData()
 {
-    return m_sendingQueue.pop<Frame>();
+    return m_sendingQueue.pop();
 }
 
-// Envoit une trame dans le buffer de sortie
-// Cette fonction retourne faux si la trame n'a pas ete envoyee. Ce cas arrive seulement si le programme veut se terminer.
-// Fait de l'attente active jusqu'a ce qu'il puisse envoyer la trame sinon.
-bool LinkLayer::sendFrame(const Frame& frame)
+// Indique le notificateur a utiliser lorsqu'une trame est prete a etre recuperee par getNextData
+void LinkLayer::setDataReadyNotifier(Notifier* notifier)
 {
-    while (m_executeSending)
+    m_sendingQueue.setDataNotifier(notifier);
+}
+
+// Notificateur sur lequel attend le fil d'envoi. La couche reseau l'utilise pour signaler qu'un paquet est pret.
+Notifier* LinkLayer::getSenderNotifier()
+{
+    return &m_senderNotifier;
+}
+
+// Notificateur sur lequel attend le fil de reception. La couche reseau l'utilise pour signaler qu'elle peut recevoir des paquets.
+Notifier* LinkLayer::getReceiverNotifier()
+{
+    return &m_receiverNotifier;
+}
+
+// Envoit une trame dans le buffer de sortie, qui doit avoir assez d'espace pour la recevoir (voir canSendData)
+void LinkLayer::sendFrame(const Frame& frame)
+{
+    if (frame.Size == FrameType::NAK)
     {
-        if (canSendData(frame))
-        {
-            Logger log(std::cout);
-
-            if (frame.Size == FrameType::NAK)
-            {
-                log << "SENDER  :" << frame.Source << " : Sending NAK  to " << frame.Destination << " : " << frame.Ack << std::endl;
-				m_sendingQueue.push(frame);
-            }
-            else if (frame.Size == FrameType::ACK)
-            {
-                log << "SENDER  :" << frame.Source << " : Sending ACK  to " << frame.Destination << " : " << frame.Ack << std::endl;
-				m_sendingQueue.push(frame);
-				startAckTimer(-1, frame.Ack);
-            }
-            else
-            {
-                log << "SENDER  :" << frame.Source << " : Sending DATA to " << frame.Destination << " : " << frame.NumberSequence << std::endl;
-				startTimeoutTimer(frame.NumberSequence);
-				m_sendingQueue.push(frame);
-            }
-			stopAckTimer(frame.Ack);
-            return true;
-        }
+        LOG_TRACE(LogCategory::Link, "SENDER  :{} : Sending NAK  to {} : {}", frame.Source, frame.Destination, frame.Ack);
+		Metrics::Add(Metric::NaksSent);
+		m_sendingQueue.push(frame);
+    }
+    else if (frame.Size == FrameType::ACK)
+    {
+        LOG_TRACE(LogCategory::Link, "SENDER  :{} : Sending ACK  to {} : {}", frame.Source, frame.Destination, frame.Ack);
+		m_sendingQueue.push(frame);
+		m_ackTimerID = startAckTimer(m_ackTimerID, frame.Ack);
     }
-    return false;
+    else
+    {
+        LOG_TRACE(LogCategory::Link, "SENDER  :{} : Sending DATA to {} : {}", frame.Source, frame.Destination, frame.NumberSequence);
+		startTimeoutTimer(frame.Destination, frame.NumberSequence);
+		m_sendingQueue.push(frame);
+    }
+	// Les autres trames portent le ACK en piggybacking : le timer du ACK en attente n'a plus de raison d'etre
+	if (frame.Size != FrameType::ACK)
+	{
+		stopAckTimer(m_ackTimerID);
+		m_ackTimerID = Timer::InvalidTimerID;
+	}
+	Metrics::Add(Metric::LinkFramesSent);
+	Metrics::Add(Metric::LinkBytesSent, SizeOf<Frame>::data(frame));
+	// Un seul fil ecrit le compteur : pas besoin d'une operation atomique de lecture-modification-ecriture
+	m_sentFrameCount.store(m_sentFrameCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+// Envoit les trames en attente tant qu'il y a de l'espace dans le buffer de sortie. Retourne vrai si au moins une trame a ete envoyee.
+bool LinkLayer::sendPendingFrames()
+{
+    bool sent = false;
+    while (!m_pendingFrames.empty() && canSendData())
+    {
+        sendFrame(m_pendingFrames.front());
+        m_pendingFrames.pop_front();
+        sent = true;
+    }
+    return sent;
+}
+
+// Passe a la couche reseau les paquets recus tant qu'elle a de l'espace. Retourne vrai si au moins un paquet a ete passe.
+bool LinkLayer::deliverPendingPackets()
+{
+    bool delivered = false;
+    NetworkLayer& networkLayer = m_driver->getNetworkLayer();
+    while (!m_pendingPackets.empty() && networkLayer.canReceiveData())
+    {
+        networkLayer.receiveData(std::move(m_pendingPackets.front()));
+        m_pendingPackets.pop_front();
+        delivered = true;
+    }
+    return delivered;
+}
+
+// Ajoute un evenement de communication pour l'envoi de donnees et reveille le fil d'envoi
+void LinkLayer::pushSendingEvent(const Event& ev)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sendEventMutex);
+        m_sendingEventQueue.push(ev);
+    }
+    m_senderNotifier.notify();
+}
+
+// Ajoute un evenement de communication pour la reception de donnees et reveille le fil de reception
+void LinkLayer::pushReceivingEvent(const Event& ev)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_receiveEventMutex);
+        m_receivingEventQueue.push(ev);
+    }
+    m_receiverNotifier.notify();
+}
+
+// Indique s'il y a un evenement de communication a gerer pour l'envoi de donnees
+bool LinkLayer::hasSendingEvent()
+{
+    std::lock_guard<std::mutex> lock(m_sendEventMutex);
+    return !m_sendingEventQueue.empty();
+}
+
+// Indique s'il y a un evenement de communication a gerer pour la reception de donnees
+bool LinkLayer::hasReceivingEvent()
+{
+    std::lock_guard<std::mutex> lock(m_receiveEventMutex);
+    return !m_receivingEventQueue.empty();
 }
 
 // Recupere le prochain evenement de communication a gerer pour l'envoi de donnees
@@ -158,6 +289,33 @@ bool LinkLayer::between(NumberSequence value, NumberSequence first, NumberSequen
     return ((first <= value) && (value < last)) || ((last < first) && (first <= value)) || ((value < last) && (last < first));
 }
 
+// Fenetre d'envoi vers un destinataire, creee vide au premier envoi
+LinkLayer::SendingWindow& LinkLayer::sendingWindow(const MACAddress& to)
+{
+    auto it = m_sendingWindows.find(to);
+    if (it == m_sendingWindows.end())
+    {
+        it = m_sendingWindows.insert(std::make_pair(to, SendingWindow())).first;
+        it->second.OutBuffer.assign(m_windowSize, Frame());
+        it->second.SentTimes.assign(m_windowSize, std::chrono::nanoseconds(0));
+    }
+    return it->second;
+}
+
+// Fenetre de reception d'un emetteur, creee a la premiere trame recue
+LinkLayer::ReceivingWindow& LinkLayer::receivingWindow(const MACAddress& from)
+{
+    auto it = m_receivingWindows.find(from);
+    if (it == m_receivingWindows.end())
+    {
+        it = m_receivingWindows.insert(std::make_pair(from, ReceivingWindow())).first;
+        it->second.TooFar = (NumberSequence)m_windowSize;
+        it->second.InBuffer.assign(m_windowSize, 0);
+        it->second.Arrived.assign(m_windowSize, false);
+    }
+    return it->second;
+}
+
 // Envoit un evenement de communication pour indiquer a l'envoi d'envoyer un ACK
 // L'evenement contiendra l'adresse a qui il faut envoyer un ACK et le numero du ACK
 void LinkLayer::sendAck(const MACAddress& to, NumberSequence ackNumber)
@@ -166,8 +324,7 @@ void LinkLayer::sendAck(const MACAddress& to, NumberSequence ackNumber)
     ev.Type = EventType::SEND_ACK_REQUEST;
     ev.Number = ackNumber;
     ev.Address = to;
-    std::lock_guard<std::mutex> lock(m_sendEventMutex);
-    m_sendingEventQueue.push(ev);
+    pushSendingEvent(ev);
 }
 
 // Envoit un evenement de communication pour indiquer a l'envoi d'envoyer un NAK
@@ -178,8 +335,7 @@ void LinkLayer::sendNak(const MACAddress& to, NumberSequence nakNumber)
     ev.Type = EventType::SEND_NAK_REQUEST;
     ev.Number = nakNumber;
     ev.Address = to;
-    std::lock_guard<std::mutex> lock(m_sendEventMutex);
-    m_sendingEventQueue.push(ev);
+    pushSendingEvent(ev);
 }
 
 // Envoit un evenement de communication pour indiquer a l'envoi qu'on a recu une trame avec potentiellement un ACK (piggybacking)
@@ -191,8 +347,7 @@ void LinkLayer::notifyACK(const Frame& frame, NumberSequence piggybackAck)
     ev.Number = frame.Ack;
     ev.Address = frame.Source;
     ev.Next = piggybackAck;
-    std::lock_guard<std::mutex> lock(m_sendEventMutex);
-    m_sendingEventQueue.push(ev);
+    pushSendingEvent(ev);
 }
 
 // Envoit un evenement de communication pour indiquer a l'envoi qu'on a recu un NAK
@@ -203,41 +358,40 @@ void LinkLayer::notifyNAK(const Frame& frame)
     ev.Type = EventType::NAK_RECEIVED;
     ev.Number = frame.Ack;
     ev.Address = frame.Source;
-    std::lock_guard<std::mutex> lock(m_sendEventMutex);
-    m_sendingEventQueue.push(ev);
+    pushSendingEvent(ev);
 }
 
 // Envoit un evenement de communication pour indiquer au recepteur qu'on a atteint un timeout pour un ACK
 // L'evenement contiendra le numero du Timer qui est arrive a echeance et le numero de la trame associe au Timer
 void LinkLayer::ackTimeout(size_t timerID, NumberSequence numberData)
 {
+    Metrics::Add(Metric::AckTimeouts);
     Event ev;
     ev.Type = EventType::ACK_TIMEOUT;
     ev.Number = numberData;
     ev.TimerID = timerID;
-    std::lock_guard<std::mutex> guard(m_receiveEventMutex);
-    m_receivingEventQueue.push(ev);
+    pushReceivingEvent(ev);
 }
 
 // Envoit un evenement de communication pour indiquer a l'envoi qu'on n'a aps recu de reponse a un envoit et qu'il faut reenvoyer la trame
-// L'evenement contiendra le numero de la trame et le numero du Timer qui est arrive a echeance
-void LinkLayer::transmissionTimeout(size_t timerID, NumberSequence numberData)
+// L'evenement contiendra le numero de la trame, le destinataire de la trame et le numero du Timer qui est arrive a echeance
+void LinkLayer::transmissionTimeout(size_t timerID, NumberSequence numberData, const MACAddress& to)
 {
     Event ev;
     ev.Type = EventType::SEND_TIMEOUT;
     ev.Number = numberData;
     ev.TimerID = timerID;
-    std::lock_guard<std::mutex> guard(m_sendEventMutex);
-    m_sendingEventQueue.push(ev);
+    ev.Address = to;
+    pushSendingEvent(ev);
 }
 
 
 // Demarre un nouveau Timer d'attente pour l'envoi a nouveau d'une trame
 // La methode retourne le numero du Timer qui vient d'etre demarre. Cette valeur doit etre garder pour pouvoir retrouver quel evenement y sera associe lorsque
 // le timer arrivera a echeance
-size_t LinkLayer::startTimeoutTimer(NumberSequence numberData)
+size_t LinkLayer::startTimeoutTimer(const MACAddress& to, NumberSequence numberData)
 {
-    return m_timers->addTimer(m_transmissionTimeout, std::bind(&LinkLayer::transmissionTimeout, this, std::placeholders::_1, std::placeholders::_2), numberData);
+    return m_timers->addTimer(m_transmissionTimeout, std::bind(&LinkLayer::transmissionTimeout, this, std::placeholders::_1, std::placeholders::_2, to), numberData);
 }
 
 // Demarre un nouveau Timer pour l'envoi d'un ACK, pour garantir un niveau de service minimal dans une communication unidirectionnelle
@@ -258,8 +412,7 @@ void LinkLayer::notifyStopAckTimers(const MACAddress& to)
     Event ev;
     ev.Type = EventType::STOP_ACK_TIMER_REQUEST;
     ev.Address = to;
-    std::lock_guard<std::mutex> guard(m_receiveEventMutex);
-    m_receivingEventQueue.push(ev);
+    pushReceivingEvent(ev);
 }
 
 // Arrete le Timer de ACK avec le TimerID specifie
@@ -269,25 +422,35 @@ void LinkLayer::stopAckTimer(size_t timerID)
 }
 
 // Indique s'il y a assez de place dans le buffer de reception pour recevoir des donnees de la couche physique
-bool LinkLayer::canReceiveDataFromPhysicalLayer(const Frame& data) const
+bool LinkLayer::canReceiveDataFromPhysicalLayer() const
 {
-    return m_receivingQueue.canWrite<Frame>(data);
+    return m_receivingQueue.canWrite();
 }
 
 // Recoit des donnees de la couche physique
 void LinkLayer::receiveData(Frame data)
 {
     // Si la couche est pleine, la trame est perdue. Elle devra etre envoye a nouveau par l'emetteur
-    if (canReceiveDataFromPhysicalLayer(data))
+    if (canReceiveDataFromPhysicalLayer())
     {
         // Est-ce que la trame reue est pour nous?
         if (data.Destination == m_address || data.Destination.isMulticast())
         {			
-            m_receivingQueue.push(data);
+            m_receivingQueue.push(std::move(data));
         }
     }
 }
 
+uint64_t LinkLayer::sentFrameCount() const
+{
+    return m_sentFrameCount.load(std::memory_order_relaxed);
+}
+
+uint64_t LinkLayer::retransmissionCount() const
+{
+    return m_retransmissionCount.load(std::memory_order_relaxed);
+}
+
 // Fonction qui retourne l'adresse MAC du destinataire d'un packet particulier de la couche Reseau.
 // Dans la realite, cette fonction ferait un lookup dans une table a partir des adresses IP pour recupere les addresse MAC.
 // Ici, on utilise directement seulement les adresse MAC.
@@ -296,188 +459,234 @@ MACAddress LinkLayer::arp(const Packet& packet) const
     return packet.Destination;
 }
 
-// Fonction qui fait l'envoi des trames et qui gere la fenetre d'envoi
-void LinkLayer::senderCallback()
+// Indique si la boucle d'envoi peut avancer
+bool LinkLayer::senderReady()
 {
-	int NR_BUFS = (m_maximumSequence + 1) / 2;
-	NumberSequence ack_expected = 0;
-	NumberSequence next_frame_to_send = 0;
-	Frame* out_buf = new Frame[NR_BUFS];
-	NumberSequence nbuffered = 0;
-	bool no_nak = true;
-
-    while (m_executeSending)
+    if (!m_pendingFrames.empty())
     {
-		Logger log(std::cout);
-		// Check if there is an event
-		Event next_sending_event = getNextSendingEvent();
-		if (next_sending_event.Type == EventType::SEND_ACK_REQUEST) {
-			
-			Frame frame;
-			frame.Destination = next_sending_event.Address;
-			frame.Source = m_address;
-			frame.NumberSequence = next_sending_event.Number;
-			frame.Ack = next_sending_event.Number;
-			frame.Size = FrameType::ACK;
-
-			if (!sendFrame(frame))
-			{
-				return;
-			}
-		}
+        return canSendData();
+    }
+    return hasSendingEvent() || (m_bufferedCount < m_windowSize && m_driver->getNetworkLayer().dataReady());
+}
 
-		if (next_sending_event.Type == EventType::ACK_RECEIVED) {
-			Logger log2(std::cout);
-			log2 << "SENDER: received ACK: " << next_sending_event.Number <<std::endl;
+// Indique si la boucle de reception peut avancer
+bool LinkLayer::receiverReady()
+{
+    if (!m_pendingPackets.empty())
+    {
+        return m_driver->getNetworkLayer().canReceiveData();
+    }
+    return hasReceivingEvent() || m_receivingQueue.canRead();
+}
 
-			Frame* temp_buf = new Frame[NR_BUFS];
-			int newInt = 0;
-			for (int i = 0; i < NR_BUFS; i++) {
+// Fonction qui fait l'envoi des trames
+void LinkLayer::senderCallback()
+{
+    while (m_executeSending)
+    {
+		// Attend un evenement ou un paquet a envoyer si la fenetre le permet
+        if (!senderStep())
+        {
+            m_senderNotifier.wait([this]() { return !m_executeSending || senderReady(); });
+        }
+    }
+}
 
-				if (out_buf[i].NumberSequence > next_sending_event.Number) {
-					temp_buf[newInt] = out_buf[i];
-					newInt++;
+// Fait avancer l'envoi et gere la fenetre d'envoi, sans jamais bloquer. Retourne faux s'il n'y avait rien a faire.
+bool LinkLayer::senderStep()
+{
+	// Les trames deja pretes doivent entrer dans le buffer de sortie avant qu'on traite autre chose
+	if (!m_pendingFrames.empty())
+	{
+		return sendPendingFrames();
+	}
+
+	// Check if there is an event
+	Event next_sending_event = getNextSendingEvent();
+	if (next_sending_event.Type == EventType::SEND_ACK_REQUEST) {
+		
+		Frame frame;
+		frame.Destination = next_sending_event.Address;
+		frame.Source = m_address;
+		frame.NumberSequence = next_sending_event.Number;
+		frame.Ack = next_sending_event.Number;
+		frame.Size = FrameType::ACK;
+
+		m_pendingFrames.push_back(frame);
+	}
+
+	if (next_sending_event.Type == EventType::ACK_RECEIVED) {
+		LOG_TRACE(LogCategory::Link, "SENDER: received ACK: {}", next_sending_event.Number);
+
+		// Les trames qui attendent encore un ACK sont ramenees au debut de la fenetre, sans allocation
+		SendingWindow& window = sendingWindow(next_sending_event.Address);
+		std::chrono::nanoseconds now = Latencies::Now();
+		int newInt = 0;
+		for (int i = 0; i < window.BufferedCount; i++) {
+
+			if (window.OutBuffer[i].NumberSequence > next_sending_event.Number) {
+				if (newInt != i) {
+					window.OutBuffer[newInt] = std::move(window.OutBuffer[i]);
+					window.SentTimes[newInt] = window.SentTimes[i];
 				}
+				newInt++;
+			}
+			else {
+				Latencies::Record(Latency::FrameRoundTrip, now - window.SentTimes[i]);
+				// Rend les donnees de la trame confirmee sans attendre que sa case soit reutilisee
+				window.OutBuffer[i].Data = DynamicDataBuffer();
 			}
-
-			out_buf = temp_buf;
-
-			nbuffered--;
-			ack_expected = next_sending_event.Number + 1;
-			
 		}
 
-		if (next_sending_event.Type == EventType::SEND_TIMEOUT) {
-			log << "SENDER: DATA TIMEOUT " << std::endl;
-
-			for (int i = 0; i < NR_BUFS; i++) { 
-				if (out_buf[i].NumberSequence == next_sending_event.Number) {
-					sendFrame(out_buf[i]);
-				}
+		// Un ACK en double ne libere aucune trame
+		m_bufferedCount -= window.BufferedCount - newInt;
+		window.BufferedCount = (NumberSequence)newInt;
+		window.AckExpected = next_sending_event.Number + 1;
+		
+	}
+
+	if (next_sending_event.Type == EventType::SEND_TIMEOUT) {
+		LOG_DEBUG(LogCategory::Link, "SENDER: DATA TIMEOUT {}", next_sending_event.Number);
+
+		// Seules les cases qui contiennent une trame de la fenetre sont reenvoyees, les autres sont vides
+		SendingWindow& window = sendingWindow(next_sending_event.Address);
+		for (int i = 0; i < window.BufferedCount; i++) { 
+			if (window.OutBuffer[i].NumberSequence == next_sending_event.Number) {
+				m_pendingFrames.push_back(window.OutBuffer[i]);
+				Metrics::Add(Metric::Retransmissions);
+				m_retransmissionCount.store(m_retransmissionCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
 			}
 		}
+	}
+
+	if (next_sending_event.Type == EventType::ACK_TIMEOUT) {
+		LOG_DEBUG(LogCategory::Link, "SENDER: ACK TIMEOUT {}", next_sending_event.Address);
 
-		if (next_sending_event.Type == EventType::ACK_TIMEOUT) {
-			log << "SENDER: ACK TIMEOUT " << next_sending_event.Address << std::endl;
+		Frame frame;
+		frame.Destination = next_sending_event.Address;
+		frame.Source = m_address;
+		frame.NumberSequence = next_sending_event.Number;
+		frame.Ack = next_sending_event.Number;
+		frame.Size = FrameType::ACK;
+	}
 
-			Frame frame;
-			frame.Destination = next_sending_event.Address;
-			frame.Source = m_address;
-			frame.NumberSequence = next_sending_event.Number;
-			frame.Ack = next_sending_event.Number;
-			frame.Size = FrameType::ACK;
+	// S'il n'y a pas d'event
+	if (next_sending_event.Type == EventType::INVALID) {
+
+		// On valid si l'on peux envoyer une nouvelle trame
+		if (m_bufferedCount >= m_windowSize || !m_driver->getNetworkLayer().dataReady()) {
+			return false;
 		}
 
-		// S'il n'y a pas d'event
-		if (next_sending_event.Type == EventType::INVALID) {
-
-			// On valid si l'on peux envoy une nouvelle trame
-			if (nbuffered < NR_BUFS) {
-
-				// On envoie une trame
-				if (m_driver->getNetworkLayer().dataReady())
-				{
-					log << "Adding to window" << std::endl;
-					log << "buf_index:" << nbuffered << std::endl;
-					log << "first_frame_number:" << out_buf[0].NumberSequence << std::endl;
-					log << "last_frame_number:" << next_frame_to_send << std::endl;
-
-
-					Packet packet = m_driver->getNetworkLayer().getNextData();
-										
-					Frame frame;
-					frame.Destination = arp(packet);
-					frame.Source = m_address;
-					frame.NumberSequence = next_frame_to_send;
-					frame.Data = Buffering::pack<Packet>(packet);
-					frame.Size = (uint16_t)frame.Data.size();
-
-					out_buf[nbuffered] = frame;
-					
-					nbuffered++;
-					next_frame_to_send++;
-
-					// On envoit la trame. Si la trame n'est pas envoye, c'est qu'on veut arreter le simulateur
-					if (!sendFrame(frame))
-					{
-						return;
-					}
-				}
-			}
-			
-		} 
-    }
+		// On envoie une trame
+		Packet packet = m_driver->getNetworkLayer().getNextData();
+		SendingWindow& window = sendingWindow(arp(packet));
+		LOG_TRACE(LogCategory::Link, "Adding to window - buf_index:{} first_frame_number:{} last_frame_number:{}", window.BufferedCount, window.OutBuffer[0].NumberSequence, window.NextFrameToSend);
+							
+		Frame frame;
+		frame.Destination = arp(packet);
+		frame.Source = m_address;
+		frame.NumberSequence = window.NextFrameToSend;
+		frame.Data = Buffering::pack(std::move(packet));
+		frame.Size = (uint16_t)frame.Data.size();
+
+		// La limite de m_windowSize trames s'applique a toutes les fenetres ensemble : une fenetre ne peut donc jamais deborder
+		window.OutBuffer[window.BufferedCount] = frame;
+		window.SentTimes[window.BufferedCount] = Latencies::Now();
+		
+		window.BufferedCount++;
+		m_bufferedCount++;
+		window.NextFrameToSend++;
+
+		m_pendingFrames.push_back(frame);
+	}
+
+	sendPendingFrames();
+	return true;
 }
 
 // Fonction qui s'occupe de la reception des trames
 void LinkLayer::receiverCallback()
 {
-	const int NR_BUFS = (m_maximumSequence + 1) / 2;
-	NumberSequence frame_expected = 0;
-	NumberSequence too_far = NR_BUFS;
-	NumberSequence* in_buf = new NumberSequence[NR_BUFS];
-	bool* arrived = new bool[NR_BUFS];
-	bool no_nak = true;
-
-	for (int i = 0; i < NR_BUFS; i++) { arrived[i] = false; }
-
-    // Passtrough
     while (m_executeReceiving)
     {        
-		Logger log(std::cout);
-		// Check if there is an event
-		Event next_receiving_event = getNextSendingEvent();
-
-		// S'il n'y a pas d'event
-		if (next_receiving_event.Type == EventType::INVALID) {
-			if (m_receivingQueue.canRead<Frame>())
-			{
-				Frame frame = m_receivingQueue.pop<Frame>();
-
-				if (frame.Size == FrameType::NAK)
-				{
-					log << "RECEIVER: " << frame.Destination << " : received a NAK  from " << frame.Source << " : " << frame.Ack << std::endl;
-				}
-				else if (frame.Size == FrameType::ACK)
-				{
-					log << "RECEIVER: " << frame.Destination << " : received a ACK  from " << frame.Source << " : " << frame.Ack << std::endl;
-					notifyACK(frame, frame.NumberSequence);
-					startAckTimer(-1, frame.Ack);
-				}
-				else
-				{
-					log << "RECEIVER: " << frame.Destination << " : received DATA from " << frame.Source << " : " << frame.NumberSequence << std::endl;
-					if ((frame.NumberSequence != frame_expected) && no_nak) {
-
-						log << "unexpected frame receive: " << frame.NumberSequence << " sending NAK" << std::endl;
-						sendNak(frame.Source, frame.NumberSequence);
-					}
-
-					if (between(frame_expected, frame.NumberSequence, too_far) && (arrived[frame.NumberSequence % NR_BUFS] == false)) {
-
-						arrived[frame.NumberSequence % NR_BUFS] = true;
-						in_buf[frame.NumberSequence % NR_BUFS] = frame.NumberSequence;
-
-						while (arrived[frame_expected % NR_BUFS]) {
-							log << "Saving packet " << frame.NumberSequence << std::endl;
-							m_driver->getNetworkLayer().receiveData(Buffering::unpack<Packet>(frame.Data));
-							no_nak = true;
-							arrived[frame_expected % NR_BUFS] = false;
-							frame_expected++;
-							too_far++;
-							sendAck(frame.Source, frame.NumberSequence);
-							startTimeoutTimer(frame.NumberSequence);
-						}
-					}
-
-					//m_driver->getNetworkLayer().receiveData(Buffering::unpack<Packet>(frame.Data));
-					//frame_expected++;;
+		// Attend un evenement ou une trame a traiter
+        if (!receiverStep())
+        {
+            m_receiverNotifier.wait([this]() { return !m_executeReceiving || receiverReady(); });
+        }
+    }
+}
 
-				}
+// Traite au plus une trame recue, sans jamais bloquer. Retourne faux s'il n'y avait rien a faire.
+bool LinkLayer::receiverStep()
+{
+	// Les paquets deja acceptes attendent que la couche reseau ait de l'espace avant qu'on accepte d'autres trames
+	if (!m_pendingPackets.empty())
+	{
+		return deliverPendingPackets();
+	}
+
+	// Check if there is an event
+	Event next_receiving_event = getNextReceivingEvent();
+	if (next_receiving_event.Type != EventType::INVALID) {
+		return true;
+	}
+
+	// S'il n'y a pas d'event
+	if (!m_receivingQueue.canRead()) {
+		return false;
+	}
+
+	Frame frame = m_receivingQueue.pop();
+	Metrics::Add(Metric::LinkFramesReceived);
+	Metrics::Add(Metric::LinkBytesReceived, SizeOf<Frame>::data(frame));
+
+	if (frame.Size == FrameType::NAK)
+	{
+		LOG_TRACE(LogCategory::Link, "RECEIVER: {} : received a NAK  from {} : {}", frame.Destination, frame.Source, frame.Ack);
+		Metrics::Add(Metric::NaksReceived);
+	}
+	else if (frame.Size == FrameType::ACK)
+	{
+		LOG_TRACE(LogCategory::Link, "RECEIVER: {} : received a ACK  from {} : {}", frame.Destination, frame.Source, frame.Ack);
+		notifyACK(frame, frame.NumberSequence);
+		startAckTimer(-1, frame.Ack);
+	}
+	else if (frame.Data.size() < HeaderLayout<Packet>::DataOffset)
+	{
+		// Le bruit a modifie le type d'un ACK ou d'un NAK : la trame ne peut pas contenir de paquet
+		LOG_WARNING(LogCategory::Link, "RECEIVER: {} : corrupted frame dropped", frame.Destination);
+		Metrics::Add(Metric::LinkCorruptedFrames);
+	}
+	else
+	{
+		LOG_TRACE(LogCategory::Link, "RECEIVER: {} : received DATA from {} : {}", frame.Destination, frame.Source, frame.NumberSequence);
+		ReceivingWindow& window = receivingWindow(frame.Source);
+		if ((frame.NumberSequence != window.FrameExpected) && window.NoNak) {
+
+			LOG_DEBUG(LogCategory::Link, "unexpected frame receive: {} sending NAK", frame.NumberSequence);
+			sendNak(frame.Source, frame.NumberSequence);
+		}
+
+		if (between(window.FrameExpected, frame.NumberSequence, window.TooFar) && (window.Arrived[frame.NumberSequence % m_windowSize] == false)) {
 
-				/*m_driver->getNetworkLayer().receiveData(Buffering::unpack<Packet>(frame.Data));*/
+			window.Arrived[frame.NumberSequence % m_windowSize] = true;
+			window.InBuffer[frame.NumberSequence % m_windowSize] = frame.NumberSequence;
+
+			while (window.Arrived[window.FrameExpected % m_windowSize]) {
+				LOG_TRACE(LogCategory::Link, "Saving packet {}", frame.NumberSequence);
+				m_pendingPackets.push_back(Buffering::unpack<Packet>(frame.Data));
+				window.NoNak = true;
+				window.Arrived[window.FrameExpected % m_windowSize] = false;
+				window.FrameExpected++;
+				window.TooFar++;
+				sendAck(frame.Source, frame.NumberSequence);
+				startTimeoutTimer(frame.Source, frame.NumberSequence);
 			}
 		}
-        
-    }
-}
+	}
+
+	deliverPendingPackets();
+	return true;
+}
\ No newline at end of file
@@ -2,17 +2,24 @@
 #define _COMPUTER_DRIVER_LAYER_LINK_LAYER_H_
 
 #include "DataType.h"
-#include "../../../DataStructures/CircularQueue.h"
 #include "../../../DataStructures/DataBuffer.h"
+#include "../../../DataStructures/FlatHashMap.h"
 #include "../../../DataStructures/MACAddress.h"
-#include "../../../General/Timer.h"
+#include "../../../DataStructures/ObjectQueue.h"
+#include "../../../General/Executor.h"
+#include "../../../General/LatencyHistogram.h"
+#include "../../../General/Metrics.h"
+#include "../../../General/Notifier.h"
+#include "../../../General/TimerService.h"
 
 #include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <deque>
 #include <queue>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 class Configuration;
 class NetworkDriver;
@@ -47,7 +54,12 @@ private:
     };
 
     NetworkDriver* m_driver;
-    std::unique_ptr<Timer> m_timers;
+    std::unique_ptr<TimerHandle> m_timers; // Les timers sont geres par un fil partage du TimerService, ou en temps virtuel par l'EventSimulator
+
+    // Sur TaskScheduler::Active() : m_senderTask est reveillee par les evenements d'envoi (timers, paquets de la couche reseau)
+    // et la place liberee dans le buffer d'envoi, m_receiverTask par les trames recues et la couche reseau prete a recevoir
+    std::unique_ptr<Task> m_senderTask;
+    std::unique_ptr<Task> m_receiverTask;
 
     MACAddress m_address;
 
@@ -59,8 +71,45 @@ private:
     std::queue<Event> m_receivingEventQueue;
     std::queue<Event> m_sendingEventQueue;
 
-    CircularQueue m_sendingQueue;
-    CircularQueue m_receivingQueue;
+    ObjectQueue<Frame> m_sendingQueue;
+    ObjectQueue<Frame> m_receivingQueue;
+    QueueWatch m_sendingQueueWatch;
+    QueueWatch m_receivingQueueWatch;
+
+    // Fenetre d'envoi vers un destinataire : les numeros de sequence sont propres a chaque couple d'ordinateurs
+    struct SendingWindow
+    {
+        NumberSequence AckExpected = 0;
+        NumberSequence NextFrameToSend = 0;
+        std::vector<Frame> OutBuffer;
+        std::vector<std::chrono::nanoseconds> SentTimes; // Entree de chaque trame de OutBuffer dans la fenetre (voir Latencies)
+        NumberSequence BufferedCount = 0;
+    };
+
+    // Fenetre de reception des trames d'un emetteur
+    struct ReceivingWindow
+    {
+        NumberSequence FrameExpected = 0;
+        NumberSequence TooFar = 0;
+        std::vector<NumberSequence> InBuffer;
+        std::vector<bool> Arrived;
+        bool NoNak = true;
+    };
+
+    // Fenetres d'envoi, utilisees seulement par la boucle d'envoi
+    int m_windowSize;
+    FlatHashMap<MACAddress, SendingWindow> m_sendingWindows;
+    NumberSequence m_bufferedCount; // Trames en attente d'un ACK dans toutes les fenetres, au plus m_windowSize
+    std::deque<Frame> m_pendingFrames; // Trames en attente d'espace dans le buffer de sortie
+    size_t m_ackTimerID; // Timer du dernier ACK envoye, Timer::InvalidTimerID si aucun n'est en attente
+
+    // Compteurs ecrits seulement par la boucle d'envoi, lus par les autres fils (voir GoodputBenchmark)
+    std::atomic<uint64_t> m_sentFrameCount;
+    std::atomic<uint64_t> m_retransmissionCount;
+
+    // Fenetres de reception, utilisees seulement par la boucle de reception
+    FlatHashMap<MACAddress, ReceivingWindow> m_receivingWindows;
+    std::deque<Packet> m_pendingPackets; // Paquets en attente d'espace dans la couche reseau
 
     std::atomic<bool> m_executeReceiving;
     std::atomic<bool> m_executeSending;
@@ -69,36 +118,53 @@ private:
     std::mutex m_receiveEventMutex;
     std::mutex m_sendEventMutex;
 
+    Notifier m_senderNotifier;
+    Notifier m_receiverNotifier;
+
     std::thread m_senderThread;
     std::thread m_receiverThread;
 
     void receiverCallback();
     void senderCallback();
 
-    bool canSendData(const Frame& data) const;
+    // Font avancer l'envoi ou la reception sans jamais bloquer. Retournent faux s'il n'y avait rien a faire.
+    bool receiverStep();
+    bool senderStep();
+    bool receiverReady();
+    bool senderReady();
+
+    bool canSendData() const;
     bool between(NumberSequence value, NumberSequence first, NumberSequence last) const;
+    SendingWindow& sendingWindow(const MACAddress& to);
+    ReceivingWindow& receivingWindow(const MACAddress& from);
 
     void sendAck(const MACAddress& to, NumberSequence ackNumber);
     void sendNak(const MACAddress& to, NumberSequence nakNumber);
-    bool sendFrame(const Frame& frame);
+    void sendFrame(const Frame& frame);
+    bool sendPendingFrames();
+    bool deliverPendingPackets();
 
     void notifyNAK(const Frame& frame);
     void notifyACK(const Frame& frame, NumberSequence piggybackAck);
 
-    void transmissionTimeout(size_t timerID, NumberSequence numberData);
+    void transmissionTimeout(size_t timerID, NumberSequence numberData, const MACAddress& to);
     void ackTimeout(size_t timerID, NumberSequence numberData);
 
     size_t startAckTimer(size_t existingTimerID, NumberSequence ackNumber);
     void stopAckTimer(size_t timerID);
     void notifyStopAckTimers(const MACAddress& to);
 
-    size_t startTimeoutTimer(NumberSequence number);
+    size_t startTimeoutTimer(const MACAddress& to, NumberSequence number);
 
+    void pushSendingEvent(const Event& ev);
+    void pushReceivingEvent(const Event& ev);
+    bool hasSendingEvent();
+    bool hasReceivingEvent();
     Event getNextSendingEvent();
     Event getNextReceivingEvent();
 
     MACAddress arp(const Packet& p) const; // Retourne la MACAddress de destination du packet
-    bool canReceiveDataFromPhysicalLayer(const Frame& data) const;
+    bool canReceiveDataFromPhysicalLayer() const;
 
 public:
     LinkLayer(NetworkDriver* driver, const Configuration& config);
@@ -111,10 +177,18 @@ public:
 
     bool dataReady() const;
     Frame getNextData();
+    void setDataReadyNotifier(Notifier* notifier);
+    Notifier* getSenderNotifier();
+    Notifier* getReceiverNotifier();
 
     bool dataReceived() const;
     void receiveData(Frame data);
 
+    // Trames de donnees, ACK et NAK placees dans le buffer de sortie
+    uint64_t sentFrameCount() const;
+    // Trames de donnees reenvoyees apres l'expiration de leur timer
+    uint64_t retransmissionCount() const;
+
 };
 
 #endif //_COMPUTER_DRIVER_LAYER_LINK_LAYER_H_
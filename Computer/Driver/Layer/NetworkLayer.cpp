@@ -1,39 +1,63 @@
 #include "NetworkLayer.h"
 
 #include "../NetworkDriver.h"
+#include "../../../DataStructures/FlatHashMap.h"
+#include "../../../DataStructures/SyntheticStream.h"
 #include "../../../General/Configuration.h"
+#include "../../../General/Executor.h"
+#include "../../../General/LatencyHistogram.h"
 
 #include <fstream>
 #include <map>
 #include <sstream>
 
-
 NetworkLayer::NetworkLayer(NetworkDriver* driver, const Configuration& config)
     : m_driver(driver)
-    , m_receivingQueue(config.get(Configuration::NETWORK_LAYER_RECEIVING_BUFFER_SIZE))
-    , m_sendingQueue(config.get(Configuration::NETWORK_LAYER_SENDING_BUFFER_SIZE))
+    , m_address(config)
     , m_packetSize(config.get(Configuration::NETWORK_LAYER_DATA_SIZE))
-    , m_executeReceiving(false)
+    , m_packetTailroom(driver->getPhysicalLayer().trailerSize())
+    , m_saveReceivedFiles(config.get(Configuration::NETWORK_LAYER_SAVE_RECEIVED_FILES) != 0)
+    , m_observer(nullptr)
     , m_executeSending(false)
+    , m_executeReceiving(false)
     , m_currentlySendingFile(false)
-    , m_address(config)
+    , m_receivedFileCount(0)
+    , m_receivingQueue(ObjectQueue<Packet>::CapacityFor(config.get(Configuration::NETWORK_LAYER_RECEIVING_BUFFER_SIZE), NominalPacket(config.get(Configuration::NETWORK_LAYER_DATA_SIZE))))
+    , m_sendingQueue(ObjectQueue<Packet>::CapacityFor(config.get(Configuration::NETWORK_LAYER_SENDING_BUFFER_SIZE), NominalPacket(config.get(Configuration::NETWORK_LAYER_DATA_SIZE))))
+    , m_receivingQueueWatch("network_receiving", m_address, m_receivingQueue)
+    , m_sendingQueueWatch("network_sending", m_address, m_sendingQueue)
+    , m_nextPacketNumber(0)
+    , m_sendingFinishedNotifier(nullptr)
 {
+    TaskScheduler* scheduler = TaskScheduler::Active();
+    if (scheduler)
+    {
+        m_sendingTask = std::make_unique<Task>(*scheduler, [this]() { return sendingStep(); });
+        m_receivingTask = std::make_unique<Task>(*scheduler, [this]() { return receivingStep(); });
+        m_sendingQueue.spaceNotifier().setTask(m_sendingTask.get());
+        m_receivingQueue.dataNotifier().setTask(m_receivingTask.get());
+    }
 }
 
 NetworkLayer::~NetworkLayer()
 {
     stop();
+    for (auto& entry : m_fileDataInfo)
+    {
+        releaseFileData(entry.second);
+    }
 }
 
 void NetworkLayer::start()
 {
     stop();
     startListening();
+    startSendingLoop();
 }
 
 void NetworkLayer::stop()
 {
-    stopSending();
+    stopSendingLoop();
     stopListening();
 }
 
@@ -42,24 +66,17 @@ unsigned int NetworkLayer::receivedFileCount() const
     return m_receivedFileCount;
 }
 
-void NetworkLayer::sendToLinkLayer(const Packet& data)
+DynamicDataBuffer NetworkLayer::createPacketData() const
 {
-    // Attente active pour pouvoir continuer d'envoyer. Si le buffer d'envoi est plein, on attend.
-    while (!m_sendingQueue.canWrite<Packet>(data))
-    {
-        // On veut arreter le thread d'envoi, on sort.
-        if (!m_executeSending)
-        {
-            return;
-        }
-    }
-    m_sendingQueue.push(data);
+    // Les entetes du paquet et de la trame seront ajoutes devant les donnees, le code d'erreur de la couche physique a la fin
+    return DynamicDataBuffer(m_packetSize, PacketHeadroom, m_packetTailroom);
 }
 
-void NetworkLayer::splitFileNameToPackets(const std::string& fileName, uint64_t fileSize, std::vector<Packet>& packetList)
+void NetworkLayer::splitFileNameToPackets(const std::string& fileName, uint64_t fileSize, uint64_t sendingStart, std::vector<Packet>& packetList)
 {
     // Le format d'envoi d'un fichier est :
-    // FileNameSize (4 octets) + FileName (FileNameSize octets) + FileSize (8 octets) + Data (FileSize octets)
+    // FileNameSize (4 octets) + FileName (FileNameSize octets) + FileSize (8 octets) + SendingStart (8 octets) + Data (FileSize octets)
+    // SendingStart permet au destinataire de mesurer la duree du transfert : tous les ordinateurs partagent l'horloge de Latencies
     // Il faut donc creer les premiers paquet pour supporter les premieres donnees.
 
     uint32_t fileNameSize = (uint32_t)fileName.size();
@@ -67,13 +84,14 @@ void NetworkLayer::splitFileNameToPackets(const std::string& fileName, uint64_t
     // Calcule le nombre de paquet complet requis pour emmagasinner toutes les donnees. Le nombre sera 1 plus petit que ce qu'on a besoin
     // En effet, si les donnees entrent toutes dans un paquet, la division entiere retournera 0.
     // Si les donnees entrent juste, on va creer un paquet vide qui sera de toute facon le premier paquet remplit pour les donnees.
-    uint32_t numberOfPacketNeeded = (sizeof(uint32_t) + fileNameSize + sizeof(uint64_t)) / m_packetSize;
+    uint32_t numberOfPacketNeeded = (sizeof(uint32_t) + fileNameSize + 2 * sizeof(uint64_t)) / m_packetSize;
 
     // On copie l'ensemble des donnees dans un buffer contigue pour se faciliter la vie
-    DynamicDataBuffer buffer = DynamicDataBuffer(sizeof(uint32_t) + fileNameSize + sizeof(uint64_t));
+    DynamicDataBuffer buffer = DynamicDataBuffer(sizeof(uint32_t) + fileNameSize + 2 * sizeof(uint64_t));
     uint32_t nextIndex = buffer.write(fileNameSize);
     nextIndex = buffer.write(fileNameSize, reinterpret_cast<const uint8_t*>(fileName.c_str()), nextIndex);
-    buffer.write(fileSize, nextIndex);
+    nextIndex = buffer.write(fileSize, nextIndex);
+    buffer.write(sendingStart, nextIndex);
 
     // Cree tous les premiers paquets complet
     uint32_t start = sizeof(uint32_t);
@@ -81,89 +99,177 @@ void NetworkLayer::splitFileNameToPackets(const std::string& fileName, uint64_t
     for (uint32_t i = 0; i < numberOfPacketNeeded; ++i)
     {
         Packet packet;
-        packet.Data = DynamicDataBuffer(m_packetSize, &buffer.data()[i*m_packetSize]);
+        packet.Data = createPacketData();
+        packet.Data.write(m_packetSize, &buffer.data()[i*m_packetSize]);
         remainderDataSize -= m_packetSize;
         packet.DataCount = m_packetSize;
         packetList.push_back(packet);
     }
     // Le dernier packet a creer
     Packet packet;
-    packet.Data = DynamicDataBuffer(m_packetSize);
+    packet.Data = createPacketData();
     packet.Data.write(remainderDataSize, &buffer.data()[numberOfPacketNeeded*m_packetSize]);
     packet.DataCount = remainderDataSize;
     packetList.push_back(packet);
 }
 
-void NetworkLayer::sendingFile(const MACAddress& to, const std::string& fileName)
+bool NetworkLayer::startSending(const MACAddress& to, const std::string& fileName)
+{
+    std::unique_ptr<std::ifstream> file = std::make_unique<std::ifstream>(fileName, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!file->is_open())
+    {
+        return false;
+    }
+    std::streampos fileSize = file->tellg();
+    file->seekg(0, std::ios::beg);
+    return startSending(to, fileName, std::move(file), (uint64_t)fileSize);
+}
+
+bool NetworkLayer::startSending(const FileTransfer& transfer)
+{
+    if (transfer.SyntheticSize == 0)
+    {
+        return startSending(transfer.Destination, transfer.FileName);
+    }
+    return startSending(transfer.Destination, transfer.FileName, std::make_unique<SyntheticStream>(transfer.SyntheticSize, transfer.SyntheticSeed), transfer.SyntheticSize);
+}
+
+bool NetworkLayer::startSending(const MACAddress& to, const std::string& fileName, std::unique_ptr<std::istream> content, uint64_t fileSize)
 {
-    m_currentlySendingFile = true;
-    std::ifstream file;
-    file.open(fileName, std::ios::in | std::ios::binary | std::ios::ate);
-    if (file.is_open())
     {
-        std::streampos fileSize = file.tellg();
-        file.seekg(0, std::ios::beg);
-        NumberSequence packetNumber = 0;
+        std::lock_guard<std::mutex> lock(m_sendingMutex);
+        if (m_currentlySendingFile)
+        {
+            return false;
+        }
+
+        m_sendingFile = std::move(content);
+        m_sendingDestination = to;
 
         std::vector<Packet> firstPackets;
-        splitFileNameToPackets(fileName, (uint64_t)fileSize, firstPackets);
-        // Envoit des premiers paquets complets
-        for (size_t i = 0; i < firstPackets.size() - 1; ++i)
+        splitFileNameToPackets(fileName, fileSize, (uint64_t)Latencies::Now().count(), firstPackets);
+
+        // On ajoute les premieres donnees au dernier packet. Dans le pire des cas, le dernier est vide
+        Packet& last = firstPackets.back();
+        m_sendingFile->read(reinterpret_cast<char*>(&(last.Data.data()[last.DataCount])), m_packetSize - last.DataCount);
+        last.DataCount += (uint32_t)m_sendingFile->gcount();
+
+        m_nextPacketNumber = 0;
+        for (Packet& p : firstPackets)
         {
-            Packet& p = firstPackets[i];
             p.Destination = to;
             p.Source = m_address;
-            p.Number = packetNumber;
-            ++packetNumber;
-            sendToLinkLayer(p);
+            p.Number = m_nextPacketNumber;
+            ++m_nextPacketNumber;
+            m_pendingPackets.push_back(std::move(p));
+        }
+        if (m_observer)
+        {
+            m_observer->sendingStarted(m_address, to, fileName, fileSize);
+        }
+        m_currentlySendingFile = true;
+    }
+    // Reveille la boucle d'envoi, qui attend de l'espace dans le buffer d'envoi ou un fichier a envoyer
+    m_sendingQueue.spaceNotifier().notify();
+    return true;
+}
+
+// Envoit au plus un paquet du fichier en cours a la couche liaison, sans jamais bloquer.
+// Retourne faux s'il n'y a pas de fichier en cours ou si le buffer d'envoi est plein.
+bool NetworkLayer::sendingStep()
+{
+    bool fileFinished = false;
+    {
+        std::lock_guard<std::mutex> lock(m_sendingMutex);
+        if (!m_currentlySendingFile)
+        {
+            return false;
         }
 
-        if (m_executeSending)
+        if (m_pendingPackets.empty())
         {
-            // On ajoute les premieres donnees au dernier packet. Dans le pire des cas, le dernier est vide
-            Packet& last = firstPackets.back();
-            file.read(reinterpret_cast<char*>(&(last.Data.data()[last.DataCount])), m_packetSize - last.DataCount);
-            std::streamsize numberRead = file.gcount();
-            last.DataCount += (uint32_t)numberRead;
-            last.Number = packetNumber;
-            last.Destination = to;
-            last.Source = m_address;
-            ++packetNumber;
-            sendToLinkLayer(last);
-
-            while (!file.eof() && m_executeSending)
+            if (m_sendingFile->eof())
+            {
+                m_sendingFile.reset();
+                m_currentlySendingFile = false;
+                fileFinished = true;
+            }
+            else
             {
                 Packet packet;
-                packet.Data = DynamicDataBuffer(m_packetSize);
-                file.read(reinterpret_cast<char*>(packet.Data.data()), packet.Data.size());
-                std::streamsize numberRead = file.gcount();
-                packet.Number = packetNumber;
-                packet.Destination = to;
+                packet.Data = createPacketData();
+                m_sendingFile->read(reinterpret_cast<char*>(packet.Data.data()), packet.Data.size());
+                packet.Number = m_nextPacketNumber;
+                packet.Destination = m_sendingDestination;
                 packet.Source = m_address;
-                packet.DataCount = (uint32_t)numberRead;
-                ++packetNumber;
-                sendToLinkLayer(packet);
+                packet.DataCount = (uint32_t)m_sendingFile->gcount();
+                ++m_nextPacketNumber;
+                m_pendingPackets.push_back(std::move(packet));
+            }
+        }
+
+        if (!fileFinished)
+        {
+            // Si le buffer d'envoi est plein, le paquet reste en attente jusqu'a ce qu'il se libere
+            if (!m_sendingQueue.canWrite())
+            {
+                return false;
             }
+            Metrics::Add(Metric::NetworkPacketsSent);
+            Metrics::Add(Metric::NetworkBytesSent, SizeOf<Packet>::data(m_pendingPackets.front()));
+            // Le paquet est deplace dans la file, sans copie de ses donnees
+            m_sendingQueue.push(std::move(m_pendingPackets.front()));
+            m_pendingPackets.pop_front();
+            return true;
         }
-        file.close();
     }
-    m_currentlySendingFile = false;
+
+    if (m_sendingFinishedNotifier)
+    {
+        m_sendingFinishedNotifier->notify();
+    }
+    return true;
+}
+
+bool NetworkLayer::sendingReady()
+{
+    std::lock_guard<std::mutex> lock(m_sendingMutex);
+    return m_currentlySendingFile && (m_pendingPackets.empty() || m_sendingQueue.canWrite());
 }
 
-bool NetworkLayer::startSending(const MACAddress& to, const std::string& filename)
+void NetworkLayer::sending()
 {
-    if (!m_executeSending)
+    while (m_executeSending)
     {
-        m_executeSending = true;
-        m_sendingThread = std::thread(&NetworkLayer::sendingFile, this, to, filename);
-        return true;
+        // Attente passive d'un fichier a envoyer ou d'espace dans le buffer d'envoi
+        if (!sendingStep())
+        {
+            m_sendingQueue.spaceNotifier().wait([this]() { return !m_executeSending || sendingReady(); });
+        }
     }
-    return false;
 }
 
-void NetworkLayer::stopSending()
+void NetworkLayer::startSendingLoop()
+{
+    m_executeSending = true;
+    if (m_sendingTask)
+    {
+        m_sendingTask->start();
+    }
+    else
+    {
+        m_sendingThread = std::thread(&NetworkLayer::sending, this);
+    }
+}
+
+void NetworkLayer::stopSendingLoop()
 {
     m_executeSending = false;
+    if (m_sendingTask)
+    {
+        m_sendingTask->stop();
+    }
+    m_sendingQueue.spaceNotifier().notify();
     if (m_sendingThread.joinable())
     {
         m_sendingThread.join();
@@ -180,13 +286,26 @@ void NetworkLayer::startListening()
     if (!m_executeReceiving)
     {
         m_executeReceiving = true;
-        m_receivingThread = std::thread(&NetworkLayer::receiving, this);
+        if (m_receivingTask)
+        {
+            m_receivingTask->start();
+        }
+        else
+        {
+            m_receivingThread = std::thread(&NetworkLayer::receiving, this);
+        }
     }
 }
 
 void NetworkLayer::stopListening()
 {
     m_executeReceiving = false;
+    if (m_receivingTask)
+    {
+        m_receivingTask->stop();
+    }
+    m_receivingQueue.dataNotifier().notify();
+    m_receivingQueue.spaceNotifier().notify();
     if (m_receivingThread.joinable())
     {
         m_receivingThread.join();
@@ -202,9 +321,21 @@ std::string NetworkLayer::constructReceivedFileName(const uint8_t* fileNameData,
 }
 
 void NetworkLayer::receiving()
+{
+    while (m_executeReceiving)
+    {
+        // Attente passive jusqu'a ce qu'un paquet soit disponible ou qu'on doive s'arreter
+        if (!receivingStep())
+        {
+            m_receivingQueue.dataNotifier().wait([this]() { return !m_executeReceiving || m_receivingQueue.canRead(); });
+        }
+    }
+}
+
+bool NetworkLayer::receivingStep()
 {
     // Lorsqu'on recoit un fichier, les donnees du fichiers sont envoyes comme ceci :
-    // FileNameSize (4 octets) + FileName (FileNameSize octets) + Nombre d'octets dans le fichier (8 octets) + Donnees du fichier (x octets)
+    // FileNameSize (4 octets) + FileName (FileNameSize octets) + Nombre d'octets dans le fichier (8 octets) + Debut de l'envoi (8 octets) + Donnees du fichier (x octets)
     // Ce nombre d'octet est separe en sous packet Packet. Il faut donc relire les donnees dans cet ordre.
 
     /*
@@ -221,6 +352,12 @@ void NetworkLayer::receiving()
             std::uint8_t FileSizeData[sizeof(uint64_t)];
         };
         std::uint32_t FileSizeDataIndexToRead; // Le numero d'index du tableau d'octets contenant la taille des donnees lu
+
+        union {
+            std::uint64_t SendingStart; // Debut de l'envoi chez la source, en nanosecondes selon Latencies::Now()
+            std::uint8_t SendingStartData[sizeof(uint64_t)];
+        };
+        std::uint32_t SendingStartDataIndexToRead;
         std::uint64_t FileDataRead; // Le nombre de donnees recu
 
         std::uint32_t FileNameIndexToRead; // Le nombre de caracteres du nom de fichier deja lu
@@ -228,125 +365,166 @@ void NetworkLayer::receiving()
     };
     */
 
-    // On pourrait recevoir de plus qu'un ordinateur, on doit donc garder les infos recue pas adresse d'origine
-    std::map<MACAddress, FileDataInfo> fileDataInfo;
-    while (m_executeReceiving)
+    if (!m_receivingQueue.canRead())
+    {
+        return false;
+    }
+
+    // On retire d'un coup tous les paquets disponibles
+    m_receivedPackets.clear();
+    m_receivingQueue.popAll(m_receivedPackets);
+    Metrics::Add(Metric::NetworkPacketsReceived, m_receivedPackets.size());
+    for (Packet& p : m_receivedPackets)
     {
-        if (m_receivingQueue.canRead<Packet>())
+        Metrics::Add(Metric::NetworkBytesReceived, SizeOf<Packet>::data(p));
+        auto infoIt = m_fileDataInfo.find(p.Source);
+        if (infoIt == m_fileDataInfo.end())
         {
-            Packet p = m_receivingQueue.pop<Packet>();
-            auto infoIt = fileDataInfo.find(p.Destination);
-            if (infoIt == fileDataInfo.end())
+            // Sans le premier paquet, on ne connait ni le nom ni la taille du fichier : le paquet ne peut pas etre interprete
+            if (p.Number != 0)
             {
-                FileDataInfo info;
-                infoIt = fileDataInfo.insert(std::make_pair(p.Destination, info)).first;
+                continue;
             }
-            FileDataInfo& info = (*infoIt).second;
-            uint32_t dataToRead = 0;
-            uint32_t indexInReadBuffer = 0;
-            if (p.Number == 0)
+            FileDataInfo info;
+            info.File = nullptr;
+            info.FileNameData = nullptr;
+            infoIt = m_fileDataInfo.insert(std::make_pair(p.Source, info)).first;
+        }
+        FileDataInfo& info = (*infoIt).second;
+        uint32_t dataToRead = 0;
+        uint32_t indexInReadBuffer = 0;
+        if (p.Number == 0)
+        {
+            // Un nouveau fichier de la meme source remplace celui qui n'a pas ete recu au complet
+            releaseFileData(info);
+            info.FileNameSize = p.Data.read<uint32_t>();
+            info.FileNameData = new uint8_t[info.FileNameSize];
+            info.FileSize = 0;
+            info.FileNameIndexToRead = 0;
+            info.FileSizeDataIndexToRead = 0;
+            info.SendingStartDataIndexToRead = 0;
+            info.FileDataRead = 0;
+            indexInReadBuffer = sizeof(uint32_t);
+        }
+
+        // Le nom peut etre separe sur plusieurs paquets
+        if (info.FileNameIndexToRead < info.FileNameSize)
+        {
+            dataToRead = std::min(info.FileNameSize - info.FileNameIndexToRead, p.Data.size() - indexInReadBuffer); // Tout ce qu'on veut ou ce qui reste dans le buffer
+            p.Data.readTo(&info.FileNameData[info.FileNameIndexToRead], indexInReadBuffer, dataToRead);
+            info.FileNameIndexToRead += dataToRead;
+            indexInReadBuffer += dataToRead;
+
+            // Le fichier n'est ouvert qu'une fois le nom completement lu
+            if (info.FileNameIndexToRead >= info.FileNameSize && m_saveReceivedFiles)
             {
-                info.File = nullptr;
-                info.FileNameSize = p.Data.read<uint32_t>();
-                info.FileNameData = new uint8_t[info.FileNameSize];
-                info.FileSize = 0;
-                info.FileNameIndexToRead = 0;
-                info.FileSizeDataIndexToRead = 0;
-                info.FileDataRead = 0;
-                indexInReadBuffer = sizeof(uint32_t);
+                info.File = new std::ofstream(constructReceivedFileName(info.FileNameData, info.FileNameSize, p), std::ios::binary);
             }
+        }
 
-            // Le fichier sera ouvert que si le nom est completement lu, sinon, on doit continuer de lire le nom
-            if (info.File == nullptr)
-            {
-                dataToRead = std::min(info.FileNameSize, p.Data.size() - indexInReadBuffer); // Tout ce qu'on veut ou ce qui reste dans le buffer
-                p.Data.readTo(&info.FileNameData[info.FileNameIndexToRead], indexInReadBuffer, dataToRead);
-                info.FileNameIndexToRead = dataToRead;
-                indexInReadBuffer += dataToRead;
+        // Puis la taille
+        if (info.FileNameIndexToRead >= info.FileNameSize && info.FileSizeDataIndexToRead < sizeof(uint64_t))
+        {
+            dataToRead = std::min((uint32_t)sizeof(uint64_t) - info.FileSizeDataIndexToRead, p.Data.size() - indexInReadBuffer);
+            p.Data.readTo(&info.FileSizeData[info.FileSizeDataIndexToRead], indexInReadBuffer, dataToRead);
+            info.FileSizeDataIndexToRead += dataToRead;
+            indexInReadBuffer += dataToRead;
+        }
 
-                if (info.FileNameIndexToRead >= info.FileNameSize)
-                {
-                    info.File = new std::ofstream(constructReceivedFileName(info.FileNameData, info.FileNameSize, p), std::ios::binary);
-
-                    // On lit la taille
-                    dataToRead = std::min((uint32_t)sizeof(uint64_t), p.Data.size() - indexInReadBuffer); // Tout ce qu'on veut ou ce qui reste dans le buffer
-                    p.Data.readTo(&info.FileSizeData[info.FileSizeDataIndexToRead], indexInReadBuffer, dataToRead);
-                    info.FileSizeDataIndexToRead = dataToRead;
-                    indexInReadBuffer += dataToRead;
-
-                    if (info.FileSizeDataIndexToRead >= sizeof(uint64_t))
-                    {
-                        // On peut maintenant lire les donnees
-                        dataToRead = (uint32_t)std::min(info.FileSize - info.FileDataRead, (uint64_t)p.Data.size() - (uint64_t)indexInReadBuffer); // Tout ce qu'on veut ou ce qui reste dans le buffer
-                        uint8_t* bufferData = new uint8_t[dataToRead];
-                        p.Data.readTo(bufferData, indexInReadBuffer, dataToRead);
-                        info.File->write(reinterpret_cast<char*>(bufferData), dataToRead);
-                        info.FileDataRead += dataToRead;
-                        delete[] bufferData;
-                        if (info.FileDataRead == info.FileSize)
-                        {
-                            info.File->close();
-                            delete[] info.FileNameData;
-                            delete info.File;
-                            info.File = nullptr;
-                            fileDataInfo.erase(infoIt);
-                            ++m_receivedFileCount;
-                        }
-                    }
-                }
+        // Puis le debut de l'envoi
+        if (info.FileSizeDataIndexToRead >= sizeof(uint64_t) && info.SendingStartDataIndexToRead < sizeof(uint64_t))
+        {
+            dataToRead = std::min((uint32_t)sizeof(uint64_t) - info.SendingStartDataIndexToRead, p.Data.size() - indexInReadBuffer);
+            p.Data.readTo(&info.SendingStartData[info.SendingStartDataIndexToRead], indexInReadBuffer, dataToRead);
+            info.SendingStartDataIndexToRead += dataToRead;
+            indexInReadBuffer += dataToRead;
+        }
+
+        // On peut maintenant lire les donnees
+        if (info.SendingStartDataIndexToRead >= sizeof(uint64_t))
+        {
+            dataToRead = (uint32_t)std::min(info.FileSize - info.FileDataRead, (uint64_t)p.Data.size() - (uint64_t)indexInReadBuffer); // Tout ce qu'on veut ou ce qui reste dans le buffer
+            if (info.File)
+            {
+                info.File->write(reinterpret_cast<const char*>(&p.Data.data()[indexInReadBuffer]), dataToRead);
             }
-            else
+            info.FileDataRead += dataToRead;
+            if (info.FileDataRead == info.FileSize)
             {
-                // On lit encore la taille pour commencer
-                if (info.FileSizeDataIndexToRead < sizeof(uint64_t))
+                std::string fileName(reinterpret_cast<const char*>(info.FileNameData), info.FileNameSize);
+                std::chrono::nanoseconds transferTime = Latencies::Now() - std::chrono::nanoseconds(info.SendingStart);
+                Latencies::Record(Latency::FileCompletion, transferTime);
+                if (m_observer)
                 {
-                    dataToRead = std::min((uint32_t)sizeof(uint64_t) - info.FileSizeDataIndexToRead, p.Data.size() - indexInReadBuffer);
-                    p.Data.readTo(&info.FileSizeData[info.FileSizeDataIndexToRead], indexInReadBuffer, dataToRead);
-                    info.FileSizeDataIndexToRead += dataToRead;
-                    indexInReadBuffer += dataToRead;
-                }
-
-                // On peut maintenant lire les donnees
-                dataToRead = (uint32_t)std::min(info.FileSize - info.FileDataRead, (uint64_t)p.Data.size() - (uint64_t)indexInReadBuffer); // Tout ce qu'on veut ou ce qui reste dans le buffer
-                uint8_t* bufferData = new uint8_t[dataToRead];
-                p.Data.readTo(bufferData, indexInReadBuffer, dataToRead);
-                info.File->write(reinterpret_cast<char*>(bufferData), dataToRead);
-                info.FileDataRead += dataToRead;
-                delete[] bufferData;
-                if (info.FileDataRead == info.FileSize)
-                {
-                    info.File->close();
-                    delete[] info.FileNameData;
-                    delete info.File;
-                    info.File = nullptr;
-                    fileDataInfo.erase(infoIt);
-                    ++m_receivedFileCount;
+                    m_observer->fileReceived(p.Source, p.Destination, fileName, info.FileSize, transferTime);
                 }
+                releaseFileData(info);
+                m_fileDataInfo.erase(infoIt);
+                ++m_receivedFileCount;
             }
         }
     }
+    return true;
+}
+
+void NetworkLayer::releaseFileData(FileDataInfo& info)
+{
+    if (info.File)
+    {
+        info.File->close();
+        delete info.File;
+        info.File = nullptr;
+    }
+    delete[] info.FileNameData;
+    info.FileNameData = nullptr;
 }
 
 bool NetworkLayer::dataReady() const
 {
-    return m_sendingQueue.canRead<Packet>();
+    return m_sendingQueue.canRead();
 }
 
 Packet NetworkLayer::getNextData()
 {
-    return m_sendingQueue.pop<Packet>();
+    return m_sendingQueue.pop();
+}
+
+void NetworkLayer::setDataReadyNotifier(Notifier* notifier)
+{
+    m_sendingQueue.setDataNotifier(notifier);
+}
+
+void NetworkLayer::setReceivingSpaceNotifier(Notifier* notifier)
+{
+    m_receivingQueue.setSpaceNotifier(notifier);
+}
+
+void NetworkLayer::setSendingFinishedNotifier(Notifier* notifier)
+{
+    m_sendingFinishedNotifier = notifier;
+}
+
+void NetworkLayer::setFileTransferObserver(FileTransferObserver* observer)
+{
+    m_observer = observer;
+}
+
+bool NetworkLayer::canReceiveData() const
+{
+    return m_receivingQueue.canWrite();
 }
 
-void NetworkLayer::receiveData(const Packet& packet)
+void NetworkLayer::receiveData(Packet packet)
 {
-    // Attente active pour pouvoir continuer de recevoir. Si le buffer de rception est plein, on attend.
-    while (!m_receivingQueue.canWrite<Packet>(packet))
+    // Attente passive pour pouvoir continuer de recevoir. Si le buffer de rception est plein, on attend qu'il se libere.
+    while (!m_receivingQueue.canWrite())
     {
         // On veut arreter le thread de rception, on sort.
         if (!m_executeReceiving)
         {
             return;
         }
+        m_receivingQueue.spaceNotifier().wait([this]() { return !m_executeReceiving || m_receivingQueue.canWrite(); });
     }
-    m_receivingQueue.push(packet);
+    m_receivingQueue.push(std::move(packet));
 }
\ No newline at end of file
@@ -2,13 +2,21 @@
 #define _COMPUTER_DRIVER_LAYER_NETWORK_LAYER_H_
 
 #include "DataType.h"
-#include "../../../DataStructures/CircularQueue.h"
 #include "../../../DataStructures/DataBuffer.h"
+#include "../../../DataStructures/FlatHashMap.h"
 #include "../../../DataStructures/MACAddress.h"
+#include "../../../DataStructures/ObjectQueue.h"
+#include "../../../General/Executor.h"
+#include "../../../General/Metrics.h"
 
 #include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <deque>
 #include <fstream>
+#include <istream>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <vector>
@@ -16,12 +24,33 @@
 class Configuration;
 class NetworkDriver;
 
+// Fichier a envoyer par un ordinateur
+struct FileTransfer
+{
+    std::string FileName;
+    MACAddress Destination;
+    uint64_t SyntheticSize = 0; // Si non nul, le contenu est genere en memoire a partir de SyntheticSeed plutot que lu dans FileName
+    uint32_t SyntheticSeed = 0;
+};
+
+// Recoit les debuts d'envoi et les receptions completes de fichiers, par exemple pour mesurer les temps de transfert.
+// Les methodes sont appelees par les boucles des couches de tous les ordinateurs, possiblement en meme temps.
+// transferTime va du debut de l'envoi, transmis dans l'en-tete du fichier, a la reception du dernier octet, selon Latencies::Now().
+class FileTransferObserver
+{
+public:
+    virtual ~FileTransferObserver() = default;
+
+    virtual void sendingStarted(const MACAddress& source, const MACAddress& destination, const std::string& fileName, uint64_t fileSize) = 0;
+    virtual void fileReceived(const MACAddress& source, const MACAddress& destination, const std::string& fileName, uint64_t fileSize, std::chrono::nanoseconds transferTime) = 0;
+};
+
 
 class NetworkLayer
 {
     struct FileDataInfo
     {
-        std::ofstream* File; // Le pointeur sur le fichier a ecrire
+        std::ofstream* File; // Le pointeur sur le fichier a ecrire, nullptr si les fichiers recus ne sont pas sauvegardes
         union {
             std::uint32_t FileNameSize; // La taille du nom du fichier
             std::uint8_t FileNameSizeData[sizeof(uint32_t)];
@@ -32,6 +61,12 @@ class NetworkLayer
             std::uint8_t FileSizeData[sizeof(uint64_t)];
         };
         std::uint32_t FileSizeDataIndexToRead; // Le numero d'index du tableau d'octets contenant la taille des donnees lu
+
+        union {
+            std::uint64_t SendingStart; // Debut de l'envoi chez la source, en nanosecondes selon Latencies::Now()
+            std::uint8_t SendingStartData[sizeof(uint64_t)];
+        };
+        std::uint32_t SendingStartDataIndexToRead;
         std::uint64_t FileDataRead; // Le nombre de donnees recu
 
         std::uint32_t FileNameIndexToRead; // Le nombre de caracteres du nom de fichier deja lu
@@ -42,6 +77,14 @@ class NetworkLayer
     MACAddress m_address; // Dans ce simulateur, on utilise l'adresse MAC, mais ce devrait plutot etre une adresse IP dans la couche reseau
 
     uint32_t m_packetSize;
+    uint32_t m_packetTailroom; // Espace reserve a la fin des donnees pour l'encodage de la couche physique
+    bool m_saveReceivedFiles;
+    FileTransferObserver* m_observer;
+
+    // Sur TaskScheduler::Active() : l'envoi est reveille par un nouveau fichier ou la place liberee dans m_sendingQueue,
+    // la reception par les paquets ajoutes a m_receivingQueue
+    std::unique_ptr<Task> m_sendingTask;
+    std::unique_ptr<Task> m_receivingTask;
 
     std::thread m_sendingThread;
     std::thread m_receivingThread;
@@ -51,20 +94,44 @@ class NetworkLayer
     std::atomic<bool> m_currentlySendingFile;
     std::atomic<unsigned int> m_receivedFileCount;
 
-    CircularQueue m_receivingQueue;
-    CircularQueue m_sendingQueue;
+    ObjectQueue<Packet> m_receivingQueue;
+    ObjectQueue<Packet> m_sendingQueue;
+    QueueWatch m_receivingQueueWatch;
+    QueueWatch m_sendingQueueWatch;
+
+    // Fichier en cours d'envoi, sur le disque ou synthetique. Il est lu un paquet a la fois par la boucle d'envoi.
+    std::mutex m_sendingMutex;
+    std::unique_ptr<std::istream> m_sendingFile;
+    MACAddress m_sendingDestination;
+    NumberSequence m_nextPacketNumber;
+    std::deque<Packet> m_pendingPackets; // Paquets prets, en attente d'espace dans le buffer d'envoi
+    Notifier* m_sendingFinishedNotifier;
 
-    void sendingFile(const MACAddress& to, const std::string& fileName);
+    // On pourrait recevoir de plus qu'un ordinateur, on doit donc garder les infos recue par adresse d'origine
+    FlatHashMap<MACAddress, FileDataInfo> m_fileDataInfo;
+    std::vector<Packet> m_receivedPackets;
+
+    void sending();
     void receiving();
 
-    void sendToLinkLayer(const Packet& data);
+    // Font avancer l'envoi ou la reception sans jamais bloquer. Retournent faux s'il n'y avait rien a faire.
+    bool sendingStep();
+    bool receivingStep();
+    bool sendingReady();
+
+    // Cree le buffer de donnees d'un paquet avec l'espace requis pour que les couches inferieures ajoutent leurs entetes sans copie
+    DynamicDataBuffer createPacketData() const;
 
-    void splitFileNameToPackets(const std::string& fileName, uint64_t fileSize, std::vector<Packet>& packetList);
+    void splitFileNameToPackets(const std::string& fileName, uint64_t fileSize, uint64_t sendingStart, std::vector<Packet>& packetList);
     std::string constructReceivedFileName(const uint8_t* fileNameData, size_t fileNameSize, const Packet& packet) const;
+    bool startSending(const MACAddress& to, const std::string& fileName, std::unique_ptr<std::istream> content, uint64_t fileSize);
+    // Ferme le fichier en cours de reception et libere son nom
+    static void releaseFileData(FileDataInfo& info);
     
     void startListening();
     void stopListening();
-    void stopSending();
+    void startSendingLoop();
+    void stopSendingLoop();
 
 public:
     NetworkLayer(NetworkDriver* driver, const Configuration& config);
@@ -73,14 +140,29 @@ public:
     bool dataReady() const;
     Packet getNextData();
 
+    // Notificateur a utiliser lorsqu'un paquet est pret a etre recupere par getNextData
+    // Doit etre appele avant le demarrage des fils d'execution
+    void setDataReadyNotifier(Notifier* notifier);
+
     unsigned int receivedFileCount() const;
 
-    void receiveData(const Packet& packet);
+    // Notificateur a utiliser lorsque de l'espace se libere dans le buffer de reception
+    void setReceivingSpaceNotifier(Notifier* notifier);
+    // Notificateur a utiliser lorsque l'envoi du fichier en cours est termine
+    void setSendingFinishedNotifier(Notifier* notifier);
+    // Doit etre appele avant le demarrage des fils d'execution. nullptr retire l'observateur.
+    void setFileTransferObserver(FileTransferObserver* observer);
+
+    bool canReceiveData() const;
+    // Attend passivement de l'espace dans le buffer de reception. Appeler canReceiveData() avant pour ne pas bloquer.
+    void receiveData(Packet packet);
 
     void start();
     void stop();
 
+    // Retourne faux si un fichier est deja en cours d'envoi ou si le fichier ne peut pas etre ouvert
     bool startSending(const MACAddress& to, const std::string& filename);
+    bool startSending(const FileTransfer& transfer);
     
     bool currentSendingFinished() const;
 };
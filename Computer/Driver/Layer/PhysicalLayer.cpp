@@ -3,8 +3,10 @@
 #include "LinkLayer.h"
 #include "../NetworkDriver.h"
 #include "../../../DataStructures/DataBuffer.h"
+#include "../../../DataStructures/MACAddress.h"
 #include "../../../General/Configuration.h"
-#include "../../../General/Logger.h"
+#include "../../../General/Log.h"
+#include "../../../General/Metrics.h"
 
 #include <iostream>
 
@@ -25,17 +27,41 @@ std::unique_ptr<DataEncoderDecoder> DataEncoderDecoder::CreateEncoderDecoder(con
     }
 }
 
+std::pair<bool, DynamicDataBuffer> DataEncoderDecoder::decodeBytes(const uint8_t* data, uint32_t dataSize) const
+{
+    return decode(DynamicDataBuffer(dataSize, data));
+}
+
+void DataEncoderDecoder::encodeInPlace(DynamicDataBuffer& data) const
+{
+    data = encode(data);
+}
+
+uint32_t DataEncoderDecoder::trailerSize() const
+{
+    return 0;
+}
+
 
 DynamicDataBuffer PassthroughDataEncoderDecoder::encode(const DynamicDataBuffer& data) const
 {
     return data;
 }
 
+void PassthroughDataEncoderDecoder::encodeInPlace(DynamicDataBuffer& /*data*/) const
+{
+}
+
 std::pair<bool, DynamicDataBuffer> PassthroughDataEncoderDecoder::decode(const DynamicDataBuffer& data) const
 {
     return std::pair<bool, DynamicDataBuffer>(true, data);
 }
 
+std::pair<bool, DynamicDataBuffer> PassthroughDataEncoderDecoder::decodeBytes(const uint8_t* data, uint32_t dataSize) const
+{
+    return std::pair<bool, DynamicDataBuffer>(true, DynamicDataBuffer(dataSize, data));
+}
+
 
 //===================================================================
 // Hamming Encoder decoder implementation
@@ -92,11 +118,21 @@ std::pair<bool, DynamicDataBuffer> CRCDataEncoderDecoder::decode(const DynamicDa
 PhysicalLayer::PhysicalLayer(NetworkDriver* driver, const Configuration& config)
     : m_driver(driver)
     , m_sendingBuffer(config.get(Configuration::PHYSICAL_LAYER_SENDING_BUFFER_SIZE))
-    , m_receivingBuffer(config.get(Configuration::PHYSICAL_LAYER_RECEIVING_BUFFER_SIZE))
+    , m_receivingBuffer(ObjectQueue<SharedDataBuffer>::CapacityFor(config.get(Configuration::PHYSICAL_LAYER_RECEIVING_BUFFER_SIZE), SharedDataBuffer((uint32_t)SizeOf<Frame>::data(NominalFrame(config.get(Configuration::NETWORK_LAYER_DATA_SIZE))))))
+    , m_receivingBufferWatch("physical_receiving", MACAddress(config), m_receivingBuffer)
     , m_stopReceiving(true)
     , m_stopSending(true)
 {
     m_encoderDecoder = DataEncoderDecoder::CreateEncoderDecoder(config);
+
+    TaskScheduler* scheduler = TaskScheduler::Active();
+    if (scheduler)
+    {
+        m_sendingTask = std::make_unique<Task>(*scheduler, [this]() { return sendingStep(); });
+        m_receivingTask = std::make_unique<Task>(*scheduler, [this]() { return receivingStep(); });
+        m_sendingNotifier.setTask(m_sendingTask.get());
+        m_receivingBuffer.dataNotifier().setTask(m_receivingTask.get());
+    }
 }
 
 PhysicalLayer::~PhysicalLayer()
@@ -119,9 +155,15 @@ void PhysicalLayer::stop()
     stop_sending();
 }
 
+// Notificateur sur lequel attend le fil d'envoi. La couche liaison l'utilise pour signaler qu'une trame est prete.
+Notifier* PhysicalLayer::getSendingNotifier()
+{
+    return &m_sendingNotifier;
+}
+
 bool PhysicalLayer::dataReceived() const
 {
-    return m_receivingBuffer.canRead<DynamicDataBuffer>();
+    return m_receivingBuffer.canRead();
 }
 
 DynamicDataBuffer PhysicalLayer::encode(const DynamicDataBuffer& data) const
@@ -129,20 +171,48 @@ DynamicDataBuffer PhysicalLayer::encode(const DynamicDataBuffer& data) const
     return m_encoderDecoder->encode(data);
 }
 
+void PhysicalLayer::encodeInPlace(DynamicDataBuffer& data) const
+{
+    m_encoderDecoder->encodeInPlace(data);
+}
+
+uint32_t PhysicalLayer::trailerSize() const
+{
+    return m_encoderDecoder->trailerSize();
+}
+
 std::pair<bool, DynamicDataBuffer> PhysicalLayer::decode(const DynamicDataBuffer& data) const
 {
     return m_encoderDecoder->decode(data);
 }
 
+std::pair<bool, DynamicDataBuffer> PhysicalLayer::decode(const SharedDataBuffer& data) const
+{
+    // Les octets partages sont decodes sur place, sans en faire une copie
+    return m_encoderDecoder->decodeBytes(data.data(), data.size());
+}
+
 void PhysicalLayer::start_receiving()
 {
     m_stopReceiving = false;
-    m_receivingThread = std::thread(&PhysicalLayer::receiving, this);
+    if (m_receivingTask)
+    {
+        m_receivingTask->start();
+    }
+    else
+    {
+        m_receivingThread = std::thread(&PhysicalLayer::receiving, this);
+    }
 }
 
 void PhysicalLayer::stop_receiving()
 {
     m_stopReceiving = true;
+    if (m_receivingTask)
+    {
+        m_receivingTask->stop();
+    }
+    m_receivingBuffer.dataNotifier().notify();
     if (m_receivingThread.joinable())
     {
         m_receivingThread.join();
@@ -152,12 +222,24 @@ void PhysicalLayer::stop_receiving()
 void PhysicalLayer::start_sending()
 {
     m_stopSending = false;
-    m_sendingThread = std::thread(&PhysicalLayer::sending, this);
+    if (m_sendingTask)
+    {
+        m_sendingTask->start();
+    }
+    else
+    {
+        m_sendingThread = std::thread(&PhysicalLayer::sending, this);
+    }
 }
 
 void PhysicalLayer::stop_sending()
 {
     m_stopSending = true;
+    if (m_sendingTask)
+    {
+        m_sendingTask->stop();
+    }
+    m_sendingNotifier.notify();
     if (m_sendingThread.joinable())
     {
         m_sendingThread.join();
@@ -169,50 +251,79 @@ void PhysicalLayer::receiving()
 {
     while (!m_stopReceiving)
     {
-        if (dataReceived())
+        if (!receivingStep())
         {
-            DynamicDataBuffer data = m_receivingBuffer.pop<DynamicDataBuffer>();
-            std::pair<bool, DynamicDataBuffer> dataBuffer = decode(data);
-            if (dataBuffer.first) // Les donnees recues sont correctes et peuvent etre utilisees
-            {
-                Frame frame = Buffering::unpack<Frame>(dataBuffer.second);
-                m_driver->getLinkLayer().receiveData(frame);
-            }
-            else
-            {
-                // Les donnees recues sont corrompues et doivent etre delaissees
-                Logger log(std::cout);
-                log << m_driver->getMACAddress() << " : Corrupted data received" << std::endl;
-            }
+            m_receivingBuffer.dataNotifier().wait([this]() { return m_stopReceiving || dataReceived(); });
         }
     }
 }
 
+bool PhysicalLayer::receivingStep()
+{
+    if (!dataReceived())
+    {
+        return false;
+    }
+
+    SharedDataBuffer received = m_receivingBuffer.pop();
+    Metrics::Add(Metric::PhysicalFramesReceived);
+    Metrics::Add(Metric::PhysicalBytesReceived, received.size());
+    std::pair<bool, DynamicDataBuffer> dataBuffer = decode(received);
+    // Une trame trop courte pour son entete est aussi corrompue
+    if (dataBuffer.first && dataBuffer.second.size() >= HeaderLayout<Frame>::DataOffset) // Les donnees recues sont correctes et peuvent etre utilisees
+    {
+        // L'entete est retire du buffer decode, qui devient directement le buffer de donnees de la trame
+        Frame frame = Buffering::unpack<Frame>(std::move(dataBuffer.second));
+        m_driver->getLinkLayer().receiveData(std::move(frame));
+    }
+    else
+    {
+        // Les donnees recues sont corrompues et doivent etre delaissees
+        LOG_WARNING(LogCategory::Phy, "{} : Corrupted data received", m_driver->getMACAddress());
+        Metrics::Add(Metric::PhysicalCorruptedFrames);
+    }
+    return true;
+}
+
 void PhysicalLayer::sending()
 {
     while (!m_stopSending)
     {
-        if (m_driver->getLinkLayer().dataReady())
+        if (!sendingStep())
         {
-            Frame dataFrame = m_driver->getLinkLayer().getNextData();
-            DynamicDataBuffer buffer = encode(Buffering::pack<Frame>(dataFrame));
-            sendData(buffer);
+            m_sendingNotifier.wait([this]() { return m_stopSending || m_driver->getLinkLayer().dataReady(); });
         }
     }
 }
 
-void PhysicalLayer::receiveData(const DynamicDataBuffer& data)
+bool PhysicalLayer::sendingStep()
+{
+    if (!m_driver->getLinkLayer().dataReady())
+    {
+        return false;
+    }
+
+    // L'entete est ajoute dans l'espace libre du buffer de la trame, puis les donnees sont encodees sur place
+    DynamicDataBuffer buffer = Buffering::pack(m_driver->getLinkLayer().getNextData());
+    encodeInPlace(buffer);
+    Metrics::Add(Metric::PhysicalFramesSent);
+    Metrics::Add(Metric::PhysicalBytesSent, buffer.size());
+    sendData(std::move(buffer));
+    return true;
+}
+
+void PhysicalLayer::receiveData(const SharedDataBuffer& data)
 {
     // Si le buffer est plein, on fait juste oublier les octets recus du cable
-    // Sinon, on ajoute les octets au buffer
-    if (m_receivingBuffer.canWrite<DynamicDataBuffer>(data))
+    // Sinon, on ajoute une reference sur les octets au buffer
+    if (m_receivingBuffer.canWrite())
     {
         m_receivingBuffer.push(data);
     }
     else
     {
-        Logger log(std::cout);
-        log << m_driver->getMACAddress() << " : Physical reception buffer full... data discarded" << std::endl;
+        LOG_WARNING(LogCategory::Phy, "{} : Physical reception buffer full... data discarded", m_driver->getMACAddress());
+        Metrics::Add(Metric::PhysicalDrops);
     }
 }
 
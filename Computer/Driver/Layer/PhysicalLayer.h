@@ -4,6 +4,11 @@
 #include "DataType.h"
 #include "../../../DataStructures/CircularQueue.h"
 #include "../../../DataStructures/DataBuffer.h"
+#include "../../../DataStructures/ObjectQueue.h"
+#include "../../../DataStructures/SharedDataBuffer.h"
+#include "../../../General/Executor.h"
+#include "../../../General/Metrics.h"
+#include "../../../General/Notifier.h"
 
 #include <atomic>
 #include <thread>
@@ -25,6 +30,18 @@ public:
     // Cette fonction retourne une paire dont le premier element est un booleen indiquant si le deuxieme parametre contient des valeurs valides ou s'il y avait des erreurs
     // non corrigees dans le flux d'entree.
     virtual std::pair<bool, DynamicDataBuffer> decode(const DynamicDataBuffer& data) const = 0;
+
+    // Variante de decode qui lit directement une suite d'octets contigus, par exemple dans un buffer circulaire.
+    // L'implementation de base copie les octets dans un DynamicDataBuffer puis appelle decode.
+    virtual std::pair<bool, DynamicDataBuffer> decodeBytes(const uint8_t* data, uint32_t dataSize) const;
+
+    // Variante de encode qui modifie directement le buffer, en utilisant son espace libre (tailroom) pour ce qui est ajoute a la fin.
+    // L'implementation de base remplace le buffer par le resultat de encode.
+    virtual void encodeInPlace(DynamicDataBuffer& data) const;
+
+    // Nombre d'octets que encodeInPlace ajoute a la fin des donnees. Les paquets sont crees avec cet espace libre.
+    // Doit rester 0 tant que encodeInPlace n'est pas redefini : l'implementation de base recopie le buffer et n'utilise pas cet espace.
+    virtual uint32_t trailerSize() const;
 };
 
 class PassthroughDataEncoderDecoder : public DataEncoderDecoder
@@ -32,6 +49,8 @@ class PassthroughDataEncoderDecoder : public DataEncoderDecoder
 public:
     DynamicDataBuffer encode(const DynamicDataBuffer& data) const override;
     std::pair<bool, DynamicDataBuffer> decode(const DynamicDataBuffer& data) const override;
+    std::pair<bool, DynamicDataBuffer> decodeBytes(const uint8_t* data, uint32_t dataSize) const override;
+    void encodeInPlace(DynamicDataBuffer& data) const override;
 };
 
 class HammingDataEncoderDecoder : public DataEncoderDecoder
@@ -60,8 +79,14 @@ private:
     NetworkDriver* m_driver;
     std::unique_ptr<DataEncoderDecoder> m_encoderDecoder;
 
+    // Sur TaskScheduler::Active() : l'envoi est reveille par m_sendingNotifier lorsque la couche liaison a une trame,
+    // la reception par les octets recus du cable dans m_receivingBuffer
+    std::unique_ptr<Task> m_sendingTask;
+    std::unique_ptr<Task> m_receivingTask;
+
     CircularQueue m_sendingBuffer;
-    CircularQueue m_receivingBuffer;
+    ObjectQueue<SharedDataBuffer> m_receivingBuffer; // Les octets recus du cable sont partages avec les autres ports du concentrateur, sans copie
+    QueueWatch m_receivingBufferWatch;
 
     std::thread m_sendingThread;
     std::thread m_receivingThread;
@@ -69,11 +94,19 @@ private:
     std::atomic<bool> m_stopReceiving;
     std::atomic<bool> m_stopSending;
 
+    Notifier m_sendingNotifier;
+
     void sending();
     void receiving();
 
+    // Traitent au plus une donnee sans jamais bloquer. Retournent faux s'il n'y avait rien a faire.
+    bool sendingStep();
+    bool receivingStep();
+
     DynamicDataBuffer encode(const DynamicDataBuffer& data) const;
+    void encodeInPlace(DynamicDataBuffer& data) const;
     std::pair<bool, DynamicDataBuffer> decode(const DynamicDataBuffer& data) const;
+    std::pair<bool, DynamicDataBuffer> decode(const SharedDataBuffer& data) const;
 
     void sendData(DynamicDataBuffer data);
 
@@ -90,8 +123,13 @@ public:
     void start();
     void stop();
 
+    Notifier* getSendingNotifier();
+
+    // Espace libre a reserver a la fin des donnees pour que l'encodage se fasse sans copie
+    uint32_t trailerSize() const;
+
     bool dataReceived() const;
-    void receiveData(const DynamicDataBuffer& data);
+    void receiveData(const SharedDataBuffer& data);
     
 };
 
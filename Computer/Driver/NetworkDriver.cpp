@@ -9,6 +9,15 @@ NetworkDriver::NetworkDriver(NetworkInterfaceCard* hardware, const Configuration
     , m_linkLayer(std::make_unique<LinkLayer>(this, config))
     , m_networkLayer(std::make_unique<NetworkLayer>(this, config))
     , m_hardware(hardware)
+{
+    // Chaque couche reveille la couche inferieure lorsqu'elle a des donnees a lui transmettre
+    m_networkLayer->setDataReadyNotifier(m_linkLayer->getSenderNotifier());
+    m_linkLayer->setDataReadyNotifier(m_physicalLayer->getSendingNotifier());
+    // Et la couche superieure lorsqu'elle libere de l'espace pour ce qu'elle recoit
+    m_networkLayer->setReceivingSpaceNotifier(m_linkLayer->getReceiverNotifier());
+}
+
+void NetworkDriver::start()
 {
     m_networkLayer->start();
     m_physicalLayer->start();
@@ -51,7 +60,7 @@ void NetworkDriver::sendToCard(DynamicDataBuffer& data)
     }
 }
 
-void NetworkDriver::receiveFromCard(const DynamicDataBuffer& data)
+void NetworkDriver::receiveFromCard(const SharedDataBuffer& data)
 {
     m_physicalLayer->receiveData(data);
 }
@@ -61,6 +70,11 @@ void NetworkDriver::start_sending_process(const MACAddress& to, const std::strin
     m_networkLayer->startSending(to, fileName);
 }
 
+void NetworkDriver::start_sending_process(const FileTransfer& transfer)
+{
+    m_networkLayer->startSending(transfer);
+}
+
 bool NetworkDriver::sendingFinished() const
 {
     return m_networkLayer->currentSendingFinished();
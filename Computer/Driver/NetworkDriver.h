@@ -22,6 +22,9 @@ public:
     NetworkDriver(NetworkInterfaceCard* hardware, const Configuration& config);
     ~NetworkDriver();
 
+    // Les fils d'execution des couches ne sont crees qu'ici, pas a la construction
+    void start();
+
     PhysicalLayer& getPhysicalLayer();
     LinkLayer& getLinkLayer();
     NetworkLayer& getNetworkLayer();
@@ -29,10 +32,11 @@ public:
     const MACAddress& getMACAddress() const;
 
     void start_sending_process(const MACAddress& to, const std::string& filename);
+    void start_sending_process(const FileTransfer& transfer);
     bool sendingFinished() const;
     
     void sendToCard(DynamicDataBuffer& data);
-    void receiveFromCard(const DynamicDataBuffer& data);
+    void receiveFromCard(const SharedDataBuffer& data);
 };
 
 #endif //_COMPUTER_DRIVER_NETWORK_DRIVER_H_
\ No newline at end of file
@@ -2,10 +2,12 @@
 
 #include "../../DataStructures/DataBuffer.h"
 #include "../../DataStructures/MACAddress.h"
+#include "../../DataStructures/SharedDataBuffer.h"
 #include "../../Transmission/Cable.h"
 
 NetworkInterfaceCard::NetworkInterfaceCard(const Configuration& config)
     : m_driver(std::make_unique<NetworkDriver>(this, config))
+    , m_cableConnected(nullptr)
 {
 }
 
@@ -28,6 +30,11 @@ void NetworkInterfaceCard::connect(Cable* cable)
     m_cableConnected = cable;
 }
 
+void NetworkInterfaceCard::start()
+{
+    m_driver->start();
+}
+
 
 void NetworkInterfaceCard::send(DynamicDataBuffer& data)
 {
@@ -38,7 +45,7 @@ void NetworkInterfaceCard::send(DynamicDataBuffer& data)
     }
 }
 
-void NetworkInterfaceCard::receive(const DynamicDataBuffer& data)
+void NetworkInterfaceCard::receive(const SharedDataBuffer& data)
 {
     m_driver->receiveFromCard(data);
 }
@@ -48,6 +55,11 @@ void NetworkInterfaceCard::start_sending_process(const MACAddress& to, const std
     m_driver->start_sending_process(to, fileName);
 }
 
+void NetworkInterfaceCard::start_sending_process(const FileTransfer& transfer)
+{
+    m_driver->start_sending_process(transfer);
+}
+
 bool NetworkInterfaceCard::sendingFinished() const
 {
     return m_driver->sendingFinished();
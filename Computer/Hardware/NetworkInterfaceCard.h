@@ -9,6 +9,7 @@ class Cable;
 class Configuration;
 class DynamicDataBuffer;
 class MACAddress;
+class SharedDataBuffer;
 
 // Represente une carte reseau
 class NetworkInterfaceCard
@@ -25,10 +26,14 @@ public:
 
     void connect(Cable* cable);
 
+    // Demarre les fils d'execution du pilote. La carte peut etre connectee avant.
+    void start();
+
     void send(DynamicDataBuffer& data);
-    void receive(const DynamicDataBuffer& data);
+    void receive(const SharedDataBuffer& data);
 
     void start_sending_process(const MACAddress& to, const std::string& fileName);
+    void start_sending_process(const FileTransfer& transfer);
 
     bool sendingFinished() const;
 };
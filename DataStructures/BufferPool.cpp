@@ -0,0 +1,262 @@
+#include "BufferPool.h"
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+
+constexpr size_t BufferPool::MinimumClassSize;
+constexpr size_t BufferPool::MaximumClassSize;
+constexpr size_t BufferPool::ClassCount;
+constexpr size_t BufferPool::MaximumCachedBlocks;
+constexpr size_t BufferPool::TransferBatch;
+constexpr size_t BufferPool::ChunkSize;
+
+namespace
+{
+    // Un bloc libre sert lui-meme de maillon dans la liste des blocs libres
+    struct FreeBlock
+    {
+        FreeBlock* Next;
+    };
+
+    struct FreeList
+    {
+        FreeBlock* Head = nullptr;
+        size_t Count = 0;
+
+        void push(FreeBlock* block)
+        {
+            block->Next = Head;
+            Head = block;
+            ++Count;
+        }
+
+        FreeBlock* pop()
+        {
+            FreeBlock* block = Head;
+            Head = block->Next;
+            --Count;
+            return block;
+        }
+    };
+
+    // Compteur modifie par un seul fil d'execution, mais lu par statistics() depuis un autre
+    struct Counter
+    {
+        std::atomic<uint64_t> Value{ 0 };
+
+        void add(uint64_t count = 1)
+        {
+            Value.store(Value.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+        }
+
+        uint64_t get() const
+        {
+            return Value.load(std::memory_order_relaxed);
+        }
+    };
+
+    struct ThreadCache;
+
+    struct CentralPool
+    {
+        std::mutex Mutex;
+        FreeList Lists[BufferPool::ClassCount];
+        std::vector<ThreadCache*> Caches; // Caches des fils d'execution vivants
+        BufferPool::Statistics Retired; // Statistiques des fils d'execution termines
+    };
+
+    // Jamais detruite : des buffers peuvent etre liberes pendant la destruction des objets statiques
+    CentralPool& central()
+    {
+        static CentralPool* pool = new CentralPool();
+        return *pool;
+    }
+
+    size_t classIndex(size_t size)
+    {
+        size_t index = 0;
+        size_t classSize = BufferPool::MinimumClassSize;
+        while (classSize < size)
+        {
+            classSize <<= 1;
+            ++index;
+        }
+        return index;
+    }
+
+    size_t classSize(size_t index)
+    {
+        return BufferPool::MinimumClassSize << index;
+    }
+
+    struct ThreadCache
+    {
+        FreeList Lists[BufferPool::ClassCount];
+
+        Counter Allocations;
+        Counter Deallocations;
+        Counter CacheHits;
+        Counter CentralTransfers;
+        Counter SystemAllocations;
+        Counter LargeAllocations;
+        Counter BytesReserved;
+
+        ThreadCache()
+        {
+            CentralPool& pool = central();
+            std::lock_guard<std::mutex> lock(pool.Mutex);
+            pool.Caches.push_back(this);
+        }
+
+        ~ThreadCache()
+        {
+            // Les blocs libres et les statistiques du fil d'execution sont rendus a la liste centrale
+            CentralPool& pool = central();
+            std::lock_guard<std::mutex> lock(pool.Mutex);
+            for (size_t i = 0; i < BufferPool::ClassCount; ++i)
+            {
+                while (Lists[i].Count > 0)
+                {
+                    pool.Lists[i].push(Lists[i].pop());
+                }
+            }
+            addTo(pool.Retired);
+            for (auto it = pool.Caches.begin(); it != pool.Caches.end(); ++it)
+            {
+                if (*it == this)
+                {
+                    pool.Caches.erase(it);
+                    break;
+                }
+            }
+        }
+
+        void addTo(BufferPool::Statistics& statistics) const
+        {
+            statistics.Allocations += Allocations.get();
+            statistics.Deallocations += Deallocations.get();
+            statistics.CacheHits += CacheHits.get();
+            statistics.CentralTransfers += CentralTransfers.get();
+            statistics.SystemAllocations += SystemAllocations.get();
+            statistics.LargeAllocations += LargeAllocations.get();
+            statistics.BytesReserved += BytesReserved.get();
+        }
+
+        // Remplit le cache vide d'une classe a partir de la liste centrale ou, a defaut, d'un nouveau bloc du systeme
+        void refill(size_t index)
+        {
+            CentralPool& pool = central();
+            {
+                std::lock_guard<std::mutex> lock(pool.Mutex);
+                while (pool.Lists[index].Count > 0 && Lists[index].Count < BufferPool::TransferBatch)
+                {
+                    Lists[index].push(pool.Lists[index].pop());
+                }
+            }
+            if (Lists[index].Count > 0)
+            {
+                CentralTransfers.add();
+                return;
+            }
+
+            size_t blockSize = classSize(index);
+            size_t chunkSize = blockSize > BufferPool::ChunkSize ? blockSize : BufferPool::ChunkSize;
+            uint8_t* chunk = static_cast<uint8_t*>(::operator new(chunkSize));
+            for (size_t offset = 0; offset + blockSize <= chunkSize; offset += blockSize)
+            {
+                Lists[index].push(reinterpret_cast<FreeBlock*>(chunk + offset));
+            }
+            SystemAllocations.add();
+            BytesReserved.add(chunkSize);
+        }
+
+        // Rend un lot de blocs a la liste centrale lorsque le cache d'une classe deborde
+        void drain(size_t index)
+        {
+            CentralPool& pool = central();
+            std::lock_guard<std::mutex> lock(pool.Mutex);
+            for (size_t i = 0; i < BufferPool::TransferBatch; ++i)
+            {
+                pool.Lists[index].push(Lists[index].pop());
+            }
+            CentralTransfers.add();
+        }
+    };
+
+    ThreadCache& threadCache()
+    {
+        thread_local ThreadCache cache;
+        return cache;
+    }
+}
+
+void* BufferPool::allocate(size_t size)
+{
+    ThreadCache& cache = threadCache();
+    cache.Allocations.add();
+    if (size > MaximumClassSize)
+    {
+        cache.LargeAllocations.add();
+        cache.SystemAllocations.add();
+        return ::operator new(size);
+    }
+
+    size_t index = classIndex(size);
+    if (cache.Lists[index].Count > 0)
+    {
+        cache.CacheHits.add();
+    }
+    else
+    {
+        cache.refill(index);
+    }
+    return cache.Lists[index].pop();
+}
+
+void BufferPool::deallocate(void* data, size_t size)
+{
+    if (data == nullptr)
+    {
+        return;
+    }
+    ThreadCache& cache = threadCache();
+    cache.Deallocations.add();
+    if (size > MaximumClassSize)
+    {
+        ::operator delete(data);
+        return;
+    }
+
+    size_t index = classIndex(size);
+    cache.Lists[index].push(reinterpret_cast<FreeBlock*>(data));
+    if (cache.Lists[index].Count > MaximumCachedBlocks)
+    {
+        cache.drain(index);
+    }
+}
+
+BufferPool::Statistics BufferPool::statistics()
+{
+    CentralPool& pool = central();
+    std::lock_guard<std::mutex> lock(pool.Mutex);
+    Statistics statistics = pool.Retired;
+    for (const ThreadCache* cache : pool.Caches)
+    {
+        cache->addTo(statistics);
+    }
+    return statistics;
+}
+
+std::ostream& operator<<(std::ostream& out, const BufferPool::Statistics& statistics)
+{
+    out << "Allocations : " << statistics.Allocations
+        << ", Liberations : " << statistics.Deallocations
+        << ", Cache : " << statistics.CacheHits
+        << ", Transferts centraux : " << statistics.CentralTransfers
+        << ", Allocations systeme : " << statistics.SystemAllocations
+        << " (dont " << statistics.LargeAllocations << " grosses)"
+        << ", Octets reserves : " << statistics.BytesReserved;
+    return out;
+}
\ No newline at end of file
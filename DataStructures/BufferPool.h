@@ -0,0 +1,75 @@
+#ifndef _GENERAL_BUFFER_POOL_H_
+#define _GENERAL_BUFFER_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Allocateur par classes de taille pour les octets des buffers (DynamicDataBuffer, SharedDataBuffer, temporaires de CircularQueue)
+// Les tailles sont arrondies a une puissance de 2 entre MinimumClassSize et MaximumClassSize. Les plus grosses vont directement au systeme.
+// Chaque fil d'execution garde ses propres listes de blocs libres : une allocation ou une liberation ne prend aucun verrou.
+// Les blocs en trop sont rendus par lots a une liste centrale, qui sert aussi a remplir les caches vides.
+// La memoire obtenue du systeme n'y est jamais rendue : une fois le regime permanent atteint, SystemAllocations cesse d'augmenter.
+class BufferPool
+{
+public:
+    static constexpr size_t MinimumClassSize = 64;
+    static constexpr size_t MaximumClassSize = 64 * 1024;
+    static constexpr size_t ClassCount = 11;
+
+    // Nombre maximal de blocs libres gardes par classe dans le cache d'un fil d'execution
+    static constexpr size_t MaximumCachedBlocks = 64;
+    // Nombre de blocs echanges d'un coup avec la liste centrale
+    static constexpr size_t TransferBatch = 32;
+    // Taille minimale des blocs de memoire demandes au systeme pour une classe
+    static constexpr size_t ChunkSize = 64 * 1024;
+
+    struct Statistics
+    {
+        uint64_t Allocations = 0; // Nombre d'appels a allocate
+        uint64_t Deallocations = 0; // Nombre d'appels a deallocate
+        uint64_t CacheHits = 0; // Allocations servies directement par le cache du fil d'execution
+        uint64_t CentralTransfers = 0; // Lots echanges avec la liste centrale
+        uint64_t SystemAllocations = 0; // Appels a l'allocateur du systeme
+        uint64_t LargeAllocations = 0; // Allocations plus grosses que MaximumClassSize
+        uint64_t BytesReserved = 0; // Octets obtenus du systeme pour les classes de taille
+    };
+
+    static void* allocate(size_t size);
+    static void deallocate(void* data, size_t size);
+
+    // Somme des statistiques de tous les fils d'execution, vivants ou termines
+    static Statistics statistics();
+};
+
+std::ostream& operator<<(std::ostream& out, const BufferPool::Statistics& statistics);
+
+
+// Bloc d'octets temporaire pris dans le pool et rendu a la destruction
+class PooledBytes
+{
+    uint8_t* m_data;
+    size_t m_size;
+
+    PooledBytes& operator=(const PooledBytes&) = delete;
+    PooledBytes(const PooledBytes&) = delete;
+
+public:
+    PooledBytes(size_t size)
+        : m_data(static_cast<uint8_t*>(BufferPool::allocate(size)))
+        , m_size(size)
+    {
+    }
+
+    ~PooledBytes()
+    {
+        BufferPool::deallocate(m_data, m_size);
+    }
+
+    uint8_t* get() const
+    {
+        return m_data;
+    }
+};
+
+#endif //_GENERAL_BUFFER_POOL_H_
@@ -1,11 +1,14 @@
 #include "CircularQueue.h"
 
+#include <algorithm>
+#include <cstring>
+
 CircularQueue::CircularQueue(size_t capacity)
-    : m_size(0)
-    , m_capacity(capacity)
-    , m_head(0)
-    , m_tail(0)
+    : m_capacity(RoundUpToPowerOfTwo(capacity))
+    , m_spaceNotifier(&m_defaultSpaceNotifier)
+    , m_dataNotifier(&m_defaultDataNotifier)
 {
+    m_mask = m_capacity - 1;
     m_buffer = new uint8_t[m_capacity];
 }
 
@@ -16,7 +19,7 @@ CircularQueue::~CircularQueue()
 
 size_t CircularQueue::size() const
 {
-    return m_size;
+    return m_indices.size();
 }
 
 size_t CircularQueue::capacity() const
@@ -24,23 +27,119 @@ size_t CircularQueue::capacity() const
     return m_capacity;
 }
 
+size_t CircularQueue::highWaterMark() const
+{
+    return m_indices.highWaterMark();
+}
+
+void CircularQueue::setDataNotifier(Notifier* notifier)
+{
+    m_dataNotifier = notifier;
+}
+
+void CircularQueue::setSpaceNotifier(Notifier* notifier)
+{
+    m_spaceNotifier = notifier;
+}
+
+Notifier& CircularQueue::dataNotifier()
+{
+    return *m_dataNotifier;
+}
+
+Notifier& CircularQueue::spaceNotifier()
+{
+    return *m_spaceNotifier;
+}
+
 void CircularQueue::push(const uint8_t& value)
 {
-    m_buffer[m_tail] = value;
-    m_tail = (m_tail + 1) % m_capacity;
-    ++m_size;
+    m_buffer[m_indices.tail() & m_mask] = value;
+    m_indices.publish(1);
+    m_dataNotifier->notify();
 }
 
 uint8_t CircularQueue::pop()
 {
-    size_t pos = m_head;
-    m_head = (m_head + 1) % m_capacity;
-    uint8_t data = m_buffer[pos];
-    --m_size;
+    uint8_t data = m_buffer[m_indices.head() & m_mask];
+    m_indices.release(1);
+    m_spaceNotifier->notify();
     return data;
 }
 
+void CircularQueue::write(const uint8_t* data, size_t count)
+{
+    if (!enoughSpaceFor(count))
+    {
+        throw std::out_of_range("Il n'y a pas assez d'espace dans le buffer pour ecrire les donnees demandees.");
+    }
+    copyIn(m_indices.tail(), data, count);
+    m_indices.publish(count);
+    m_dataNotifier->notify();
+}
+
+void CircularQueue::read(uint8_t* data, size_t count)
+{
+    if (m_indices.readable(count) < count)
+    {
+        throw std::out_of_range("Il n'y a pas assez d'element dans le buffer pour lire les donnees demandees.");
+    }
+    copyOut(m_indices.head(), data, count);
+    consume(count);
+}
+
+CircularQueue::WriteRegion CircularQueue::reserve(size_t count)
+{
+    if (!enoughSpaceFor(count))
+    {
+        throw std::out_of_range("Il n'y a pas assez d'espace dans le buffer pour ecrire les donnees demandees.");
+    }
+    size_t position = m_indices.tail() & m_mask;
+    size_t firstSegmentSize = std::min(count, m_capacity - position);
+    return WriteRegion{ &m_buffer[position], firstSegmentSize, m_buffer, count - firstSegmentSize };
+}
+
+void CircularQueue::commit(size_t count)
+{
+    m_indices.publish(count);
+    m_dataNotifier->notify();
+}
+
+CircularQueue::ReadRegion CircularQueue::peek(size_t count) const
+{
+    if (m_indices.readable(count) < count)
+    {
+        throw std::out_of_range("Il n'y a pas assez d'element dans le buffer pour lire les donnees demandees.");
+    }
+    size_t position = m_indices.head() & m_mask;
+    size_t firstSegmentSize = std::min(count, m_capacity - position);
+    return ReadRegion{ &m_buffer[position], firstSegmentSize, m_buffer, count - firstSegmentSize };
+}
+
+void CircularQueue::copyIn(size_t index, const uint8_t* data, size_t count)
+{
+    // Premier segment : de la position jusqu'a la fin du buffer. Deuxieme segment : le reste, au debut du buffer
+    size_t position = index & m_mask;
+    size_t firstSegmentSize = std::min(count, m_capacity - position);
+    std::memcpy(&m_buffer[position], data, firstSegmentSize);
+    std::memcpy(m_buffer, &data[firstSegmentSize], count - firstSegmentSize);
+}
+
+void CircularQueue::copyOut(size_t index, uint8_t* data, size_t count) const
+{
+    size_t position = index & m_mask;
+    size_t firstSegmentSize = std::min(count, m_capacity - position);
+    std::memcpy(data, &m_buffer[position], firstSegmentSize);
+    std::memcpy(&data[firstSegmentSize], m_buffer, count - firstSegmentSize);
+}
+
+void CircularQueue::consume(size_t count)
+{
+    m_indices.release(count);
+    m_spaceNotifier->notify();
+}
+
 bool CircularQueue::enoughSpaceFor(size_t numberOfByte) const
 {
-    return size() + numberOfByte <= capacity();
+    return m_indices.hasSpaceFor(numberOfByte, m_capacity);
 }
\ No newline at end of file
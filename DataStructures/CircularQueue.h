@@ -1,40 +1,131 @@
 #ifndef _GENERAL_CIRCULAR_QUEUE_H_
 #define _GENERAL_CIRCULAR_QUEUE_H_
 
-#include <atomic>
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <memory>
 #include <stdexcept>
 
+#include "BufferPool.h"
+#include "SpscIndices.h"
 #include "Utils.h"
+#include "../General/Notifier.h"
 
 // Buffer circulaire d'octet de style FIFO
 // Thread-safe pour 1 consommateur et 1 producteur seulement
+// La capacite est arrondie a la puissance de 2 superieure pour remplacer les modulos par un masque.
+// Les index de lecture et d'ecriture sont ceux de SpscIndices, en octets.
+// Le consommateur peut attendre des donnees sur dataNotifier() et le producteur peut attendre de l'espace sur spaceNotifier().
 class CircularQueue
 {
+    // Donnees en lecture seule apres la construction
     size_t m_capacity;
-    size_t m_head;
-    size_t m_tail;
-    std::atomic<size_t> m_size;
+    size_t m_mask;
     uint8_t* m_buffer;
+    Notifier* m_spaceNotifier; // Notifie par le consommateur lorsqu'il libere de l'espace
+    Notifier* m_dataNotifier; // Notifie par le producteur lorsqu'il publie des donnees
+
+    SpscIndices m_indices;
+
+    // Notificateurs utilises par defaut. Ils peuvent etre remplaces pour qu'un meme fil d'execution attende plusieurs sources.
+    alignas(CacheLineSize) Notifier m_defaultSpaceNotifier;
+    alignas(CacheLineSize) Notifier m_defaultDataNotifier;
 
     CircularQueue& operator=(const CircularQueue&) = delete;
     CircularQueue(const CircularQueue&) = delete;
 
-    bool enoughSpaceFor(size_t numberOfByte) const;
+    // Copie des octets dans le buffer (ou hors du buffer) a partir de l'index specifie, en au plus deux segments
+    void copyIn(size_t index, const uint8_t* data, size_t count);
+    void copyOut(size_t index, uint8_t* data, size_t count) const;
 
+    // La taille d'un objet n'est connue qu'en lisant son debut : on essaie d'abord avec la derniere fin connue, puis on la relit
     template<typename T>
     bool enoughDataFor() const
     {
-        return EnoughDataFor<T>::in(m_buffer, m_head, size(), capacity());
+        size_t position = m_indices.head() & m_mask;
+        if (EnoughDataFor<T>::in(m_buffer, position, m_indices.readable(0), capacity()))
+        {
+            return true;
+        }
+        return EnoughDataFor<T>::in(m_buffer, position, m_indices.readable(SIZE_MAX), capacity());
     }
 
 public:
+    // Zone du buffer, possiblement separee en deux segments par la fin du buffer circulaire
+    template<typename Byte>
+    struct Region
+    {
+        Byte* First;
+        size_t FirstSize;
+        Byte* Second;
+        size_t SecondSize;
+
+        size_t size() const { return FirstSize + SecondSize; }
+        bool contiguous() const { return SecondSize == 0; }
+
+        // Sous-zone de count octets commencant a la position offset
+        Region slice(size_t offset, size_t count) const
+        {
+            if (offset >= FirstSize)
+            {
+                return Region{ &Second[offset - FirstSize], count, Second, 0 };
+            }
+            size_t firstSize = std::min(count, FirstSize - offset);
+            return Region{ &First[offset], firstSize, Second, count - firstSize };
+        }
+
+        // Ecrit count octets dans la zone a partir de la position offset
+        void copyFrom(size_t offset, const uint8_t* data, size_t count) const
+        {
+            size_t copied = 0;
+            if (offset < FirstSize)
+            {
+                copied = std::min(count, FirstSize - offset);
+                std::memcpy(&First[offset], data, copied);
+            }
+            if (copied < count)
+            {
+                std::memcpy(&Second[offset + copied - FirstSize], &data[copied], count - copied);
+            }
+        }
+
+        // Lit count octets de la zone a partir de la position offset
+        void copyTo(size_t offset, uint8_t* data, size_t count) const
+        {
+            size_t copied = 0;
+            if (offset < FirstSize)
+            {
+                copied = std::min(count, FirstSize - offset);
+                std::memcpy(data, &First[offset], copied);
+            }
+            if (copied < count)
+            {
+                std::memcpy(&data[copied], &Second[offset + copied - FirstSize], count - copied);
+            }
+        }
+    };
+    using WriteRegion = Region<uint8_t>;
+    using ReadRegion = Region<const uint8_t>;
+
     CircularQueue(size_t capacity);
 
     ~CircularQueue();
 
     size_t size() const;
     size_t capacity() const;
+    // Plus grand nombre d'octets presents en meme temps dans le buffer, lisible par n'importe quel fil
+    size_t highWaterMark() const;
+
+    // Appele seulement par le producteur
+    bool enoughSpaceFor(size_t numberOfByte) const;
+
+    // Doivent etre appeles avant que le producteur et le consommateur commencent a utiliser le buffer
+    void setDataNotifier(Notifier* notifier);
+    void setSpaceNotifier(Notifier* notifier);
+
+    Notifier& dataNotifier();
+    Notifier& spaceNotifier();
 
     template<typename T>
     bool canWrite(const T& data) const
@@ -45,18 +136,31 @@ public:
 
     void push(const uint8_t& value);
 
+    // Ecrit une suite contigue d'octets dans le buffer
+    void write(const uint8_t* data, size_t count);
+
+    // Reserve count octets a la fin du buffer pour que le producteur puisse y ecrire directement.
+    // Les octets ne sont visibles pour le consommateur qu'apres l'appel a commit.
+    WriteRegion reserve(size_t count);
+    void commit(size_t count);
+
     template<typename T>
     void push(const T& value)
     {
-        // ToDataPtr est une structure utilitaire qui permet d'acceder a des octets particuliers d'un objet quelconque a l'aide d'un index
+        // ToDataPtr est une structure utilitaire qui donne acces aux segments d'octets contigus d'un objet quelconque
         ToDataPtr<T> toDataPtr(value);
         size_t dataSize = toDataPtr.size();
         if (enoughSpaceFor(dataSize))
-        {            
-            for (size_t i = 0; i < dataSize; ++i)
+        {
+            size_t index = m_indices.tail();
+            toDataPtr.forEachSegment([this, &index](const uint8_t* segment, size_t segmentSize)
             {
-                push(toDataPtr[i]);
-            }
+                copyIn(index, segment, segmentSize);
+                index += segmentSize;
+            });
+            // Les donnees ne deviennent visibles pour le consommateur qu'une fois l'objet complet ecrit
+            m_indices.publish(dataSize);
+            m_dataNotifier->notify();
         }
         else
         {
@@ -72,20 +176,38 @@ public:
 
     uint8_t pop();
 
+    // Lit une suite contigue d'octets hors du buffer
+    void read(uint8_t* data, size_t count);
+
+    // Donne acces aux count premiers octets du buffer sans les retirer. Le consommateur doit ensuite appeler consume.
+    ReadRegion peek(size_t count) const;
+    void consume(size_t count);
+
+    // Taille en octets du prochain objet de type T dans le buffer. Il faut d'abord s'assurer que canRead<T>() est vrai.
+    template<typename T>
+    size_t peekSize() const
+    {
+        return FromDataPtr<T>::size(m_buffer, m_indices.head() & m_mask, capacity());
+    }
+
     template<typename T>
     T pop()
     {
         if (canRead<T>())
         {
-            size_t dataSize = FromDataPtr<T>::size(m_buffer, m_head, capacity());
-            uint8_t* dataPtr = new uint8_t[dataSize];
-            for (size_t i = 0; i < dataSize; ++i)
+            size_t dataSize = peekSize<T>();
+            size_t position = m_indices.head() & m_mask;
+            if (position + dataSize <= m_capacity)
             {
-                dataPtr[i] = pop();
+                // Les octets sont contigus dans le buffer, on reconstruit l'objet directement a partir de ceux-ci
+                T data = FromDataPtr<T>::get(&m_buffer[position], dataSize);
+                consume(dataSize);
+                return data;
             }
-            T data = FromDataPtr<T>::get(dataPtr, dataSize);
-            delete[] dataPtr;
-            return data;
+            // Les octets sont separes par la fin du buffer, il faut les recopier dans un espace contigu
+            PooledBytes dataPtr(dataSize);
+            read(dataPtr.get(), dataSize);
+            return FromDataPtr<T>::get(dataPtr.get(), dataSize);
         }
         throw std::out_of_range("Il n'y a pas assez d'element dans le buffer pour construire un objet de ce type.");
     }  
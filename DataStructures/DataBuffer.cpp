@@ -1,45 +1,119 @@
 #include "DataBuffer.h"
+#include "BufferPool.h"
 
 #include <algorithm>
+#include <cstring>
 
 
+constexpr uint32_t DynamicDataBuffer::InlineCapacity;
+
 DynamicDataBuffer::DynamicDataBuffer()
     : m_size(0)
+    , m_headroom(0)
+    , m_tailroom(0)
 {
-    m_data = nullptr;
+    m_data = m_inlineData;
 }
 
 DynamicDataBuffer::DynamicDataBuffer(uint32_t size)
-    : m_size(size)
 {
-    m_data = new uint8_t[m_size];
+    allocate(size, 0, 0);
 }
 
 DynamicDataBuffer::DynamicDataBuffer(uint32_t size, const uint8_t* data)
     : DynamicDataBuffer(size)
 {
-    for (uint32_t i = 0; i < m_size; ++i)
-    {
-        m_data[i] = data[i];
-    }
+    std::memcpy(m_data, data, m_size);
+}
+
+DynamicDataBuffer::DynamicDataBuffer(uint32_t size, uint32_t headroom, uint32_t tailroom)
+{
+    allocate(size, headroom, tailroom);
 }
 
+// La copie garde le meme espace libre que l'original, pour que les entetes puissent aussi y etre ajoutes sans copie
 DynamicDataBuffer::DynamicDataBuffer(const DynamicDataBuffer& other)
-    : DynamicDataBuffer(other.m_size, other.m_data)
 {
+    allocate(other.m_size, other.m_headroom, other.m_tailroom);
+    std::memcpy(m_data, other.m_data, m_size);
 }
 
 DynamicDataBuffer::DynamicDataBuffer(DynamicDataBuffer&& other)
-    : m_size(other.m_size)
-    , m_data(other.m_data)
 {
-    other.m_data = nullptr;
-    other.m_size = 0;
+    steal(other);
 }
 
 DynamicDataBuffer::~DynamicDataBuffer()
 {
-    delete[] m_data;
+    release();
+}
+
+uint8_t* DynamicDataBuffer::allocateBytes(uint32_t size)
+{
+#if DATA_BUFFER_USE_POOL
+    return static_cast<uint8_t*>(BufferPool::allocate(size));
+#else
+    return new uint8_t[size];
+#endif
+}
+
+void DynamicDataBuffer::freeBytes(uint8_t* data, uint32_t size)
+{
+#if DATA_BUFFER_USE_POOL
+    BufferPool::deallocate(data, size);
+#else
+    delete[] data;
+#endif
+}
+
+void DynamicDataBuffer::allocate(uint32_t size, uint32_t headroom, uint32_t tailroom)
+{
+    m_size = size;
+    m_headroom = headroom;
+    m_tailroom = tailroom;
+    // Les petits buffers sont gardes dans l'objet lui-meme, ce qui evite une allocation pour la plupart des paquets et trames
+    uint8_t* storage = (capacity() <= InlineCapacity) ? m_inlineData : allocateBytes(capacity());
+    m_data = storage + headroom;
+}
+
+void DynamicDataBuffer::reallocate(uint32_t headroom, uint32_t tailroom)
+{
+    DynamicDataBuffer buffer(m_size, headroom, tailroom);
+    std::memcpy(buffer.m_data, m_data, m_size);
+    *this = std::move(buffer);
+}
+
+void DynamicDataBuffer::release()
+{
+    if (!isInline())
+    {
+        freeBytes(storage(), capacity());
+    }
+    m_data = m_inlineData;
+    m_size = 0;
+    m_headroom = 0;
+    m_tailroom = 0;
+}
+
+void DynamicDataBuffer::steal(DynamicDataBuffer& other)
+{
+    m_size = other.m_size;
+    m_headroom = other.m_headroom;
+    m_tailroom = other.m_tailroom;
+    if (other.isInline())
+    {
+        // Les donnees sont dans l'autre objet : il faut les copier, mais il y en a au plus InlineCapacity octets
+        m_data = m_inlineData + m_headroom;
+        std::memcpy(m_data, other.m_data, m_size);
+    }
+    else
+    {
+        m_data = other.m_data;
+    }
+    other.m_data = other.m_inlineData;
+    other.m_size = 0;
+    other.m_headroom = 0;
+    other.m_tailroom = 0;
 }
 
 DynamicDataBuffer& DynamicDataBuffer::operator=(DynamicDataBuffer&& other)
@@ -47,11 +121,8 @@ DynamicDataBuffer& DynamicDataBuffer::operator=(DynamicDataBuffer&& other)
     // On vite l'autoassignement
     if (&other != this)
     {
-        delete[] m_data;
-        m_data = other.m_data;
-        m_size = other.m_size;
-        other.m_data = nullptr;
-        other.m_size = 0;
+        release();
+        steal(other);
     }
     return *this;
 }
@@ -61,13 +132,13 @@ DynamicDataBuffer& DynamicDataBuffer::operator=(const DynamicDataBuffer& other)
     // On vite l'autoassignement
     if (&other != this)
     {
-        delete[] m_data;
-        m_data = new uint8_t[other.m_size];
-        m_size = other.m_size;
-        for (uint32_t i = 0; i < m_size; ++i)
+        // L'espace actuel est reutilise s'il a deja la bonne taille et au moins autant d'espace libre
+        if (m_size != other.m_size || m_headroom < other.m_headroom || m_tailroom < other.m_tailroom)
         {
-            m_data[i] = other.m_data[i];
+            release();
+            allocate(other.m_size, other.m_headroom, other.m_tailroom);
         }
+        std::memcpy(m_data, other.m_data, m_size);
     }
     return *this;
 }
@@ -109,4 +180,53 @@ void DynamicDataBuffer::replaceData(const uint8_t* data, uint32_t newDataSize, u
 void DynamicDataBuffer::replaceData(const DynamicDataBuffer& buffer, uint32_t start)
 {
     replaceData(buffer.data(), buffer.size(), start);
+}
+
+uint32_t DynamicDataBuffer::headroom() const
+{
+    return m_headroom;
+}
+
+uint32_t DynamicDataBuffer::tailroom() const
+{
+    return m_tailroom;
+}
+
+uint8_t* DynamicDataBuffer::prepend(uint32_t count)
+{
+    if (count > m_headroom)
+    {
+        reallocate(count, m_tailroom);
+    }
+    m_data -= count;
+    m_headroom -= count;
+    m_size += count;
+    return m_data;
+}
+
+uint8_t* DynamicDataBuffer::append(uint32_t count)
+{
+    if (count > m_tailroom)
+    {
+        reallocate(m_headroom, count);
+    }
+    uint8_t* end = m_data + m_size;
+    m_tailroom -= count;
+    m_size += count;
+    return end;
+}
+
+void DynamicDataBuffer::trimFront(uint32_t count)
+{
+    count = std::min(count, m_size);
+    m_data += count;
+    m_headroom += count;
+    m_size -= count;
+}
+
+void DynamicDataBuffer::trimBack(uint32_t count)
+{
+    count = std::min(count, m_size);
+    m_tailroom += count;
+    m_size -= count;
 }
\ No newline at end of file
@@ -6,14 +6,56 @@
 
 #include "Utils.h"
 
+// Taille maximale (en octets) des donnees conservees directement dans un DynamicDataBuffer, sans allocation dynamique.
+// Peut etre redefinie a la compilation, par exemple avec -DDYNAMIC_DATA_BUFFER_INLINE_CAPACITY=256.
+#ifndef DYNAMIC_DATA_BUFFER_INLINE_CAPACITY
+#define DYNAMIC_DATA_BUFFER_INLINE_CAPACITY 128
+#endif
+
+// Indique si les octets alloues par DynamicDataBuffer et SharedDataBuffer viennent de BufferPool (1) ou directement du systeme (0)
+#ifndef DATA_BUFFER_USE_POOL
+#define DATA_BUFFER_USE_POOL 1
+#endif
+
+// Buffer d'octets de taille fixe
+// Comme un skb du noyau, le buffer peut garder de l'espace libre avant (headroom) et apres (tailroom) ses donnees.
+// Les couches inferieures y ajoutent leurs entetes et leurs sommes de controle sans reallouer ni recopier les donnees.
 class DynamicDataBuffer
 {
-    uint32_t m_size;
-    uint8_t* m_data;
+public:
+    static constexpr uint32_t InlineCapacity = DYNAMIC_DATA_BUFFER_INLINE_CAPACITY;
+
+private:
+    uint32_t m_size; // Taille des donnees, sans l'espace libre
+    uint8_t* m_data; // Debut des donnees, dans m_inlineData pour les petits buffers, dans un bloc alloue sinon
+    uint32_t m_headroom; // Octets libres avant m_data
+    uint32_t m_tailroom; // Octets libres apres la fin des donnees
+    uint8_t m_inlineData[InlineCapacity > 0 ? InlineCapacity : 1];
+
+    uint8_t* storage() const { return m_data - m_headroom; }
+    uint32_t capacity() const { return m_headroom + m_size + m_tailroom; }
+    bool isInline() const { return storage() == m_inlineData; }
+
+    // Point d'entree unique vers l'allocateur pour les octets qui n'entrent pas dans m_inlineData
+    static uint8_t* allocateBytes(uint32_t size);
+    static void freeBytes(uint8_t* data, uint32_t size);
+
+    // Prepare l'espace pour size octets, precedes de headroom et suivis de tailroom octets libres.
+    // L'espace precedent doit avoir ete libere.
+    void allocate(uint32_t size, uint32_t headroom, uint32_t tailroom);
+
+    // Deplace les donnees dans un nouvel espace ayant au moins l'espace libre demande
+    void reallocate(uint32_t headroom, uint32_t tailroom);
+    void release();
+
+    // Prend les donnees de other et le laisse vide
+    void steal(DynamicDataBuffer& other);
+
 public:
     DynamicDataBuffer();
     DynamicDataBuffer(uint32_t dataSize);
     DynamicDataBuffer(uint32_t dataSize, const uint8_t* data);
+    DynamicDataBuffer(uint32_t dataSize, uint32_t headroom, uint32_t tailroom);
     DynamicDataBuffer(const DynamicDataBuffer& other);
     DynamicDataBuffer(DynamicDataBuffer&& other);
     ~DynamicDataBuffer();
@@ -72,6 +114,18 @@ public:
     const uint8_t* data() const;
 
     uint32_t size() const;
+
+    uint32_t headroom() const;
+    uint32_t tailroom() const;
+
+    // Agrandit le buffer de count octets au debut (prepend) ou a la fin (append) et retourne l'adresse des nouveaux octets.
+    // L'espace libre est utilise s'il suffit. Sinon, les donnees sont deplacees dans un nouvel espace.
+    uint8_t* prepend(uint32_t count);
+    uint8_t* append(uint32_t count);
+
+    // Retire count octets au debut ou a la fin du buffer. Ils redeviennent de l'espace libre.
+    void trimFront(uint32_t count);
+    void trimBack(uint32_t count);
 };
 
 
@@ -127,20 +181,31 @@ struct ToDataPtr<DynamicDataBuffer>
 
     ToDataPtr(const DynamicDataBuffer& data) : Data(data) {}
 
-    uint8_t operator[](size_t byteIndex)
+    size_t size() const { return Data.size() + sizeof(uint32_t); }
+
+    // La taille des donnees puis les donnees, chacune en une seule copie
+    size_t serializeInto(ByteSpan buffer) const
     {
-        if (byteIndex < sizeof(uint32_t))
+        uint32_t dataSize = Data.size();
+        if (buffer.Size < sizeof(uint32_t) + dataSize)
         {
-            const uint8_t* dataPtr = reinterpret_cast<const uint8_t*>(&Data);
-            return dataPtr[byteIndex];
+            throw std::out_of_range("Le buffer est trop petit pour contenir la representation de l'objet.");
         }
-        else
+        std::memcpy(buffer.Data, &dataSize, sizeof(uint32_t));
+        if (dataSize > 0)
         {
-            return Data[byteIndex - sizeof(uint32_t)];
+            std::memcpy(buffer.Data + sizeof(uint32_t), Data.data(), dataSize);
         }
+        return sizeof(uint32_t) + dataSize;
     }
 
-    size_t size() const { return Data.size() + sizeof(uint32_t); }
+    template<typename Function>
+    void forEachSegment(Function function) const
+    {
+        uint32_t dataSize = Data.size();
+        function(reinterpret_cast<const uint8_t*>(&dataSize), sizeof(uint32_t));
+        function(Data.data(), Data.size());
+    }
 };
 
 // Utilitaire pour lire un objet dans une suite d'octet pour reconstruire correctement un objet de type DynamicDataBuffer
@@ -168,6 +233,11 @@ struct FromDataPtr<DynamicDataBuffer>
         DynamicDataBuffer dataValue((uint32_t)(dataSize - sizeof(uint32_t)), &data[sizeof(uint32_t)]);
         return dataValue;
     }
+
+    static DynamicDataBuffer deserializeFrom(ConstByteSpan buffer)
+    {
+        return get(buffer.Data, buffer.Size);
+    }
 };
 
 #endif //_GENERAL_DATA_BUFFER_H_
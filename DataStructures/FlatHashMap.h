@@ -0,0 +1,253 @@
+#ifndef _GENERAL_FLAT_HASH_MAP_H_
+#define _GENERAL_FLAT_HASH_MAP_H_
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "Utils.h"
+
+// Table de hachage a adressage ouvert (sondage lineaire), dont les elements sont ranges dans un seul tableau contigu.
+// Concue pour les petites tables consultees a chaque paquet (une entree par adresse), ou std::map fait une allocation par
+// element et O(log n) comparaisons par recherche.
+// Key et Value doivent pouvoir etre construits par defaut. Hash doit bien repartir les bits de poids faible (voir std::hash<MACAddress>).
+// Les suppressions deplacent les elements suivants pour combler le trou : toute insertion ou suppression invalide les iterateurs.
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class FlatHashMap
+{
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = std::pair<Key, Value>;
+
+private:
+    struct Slot
+    {
+        bool Occupied = false;
+        value_type Entry;
+    };
+
+    static constexpr size_t MinimumCapacity = 16;
+
+    std::vector<Slot> m_slots; // La taille est toujours une puissance de 2
+    size_t m_mask;
+    size_t m_size;
+    Hash m_hash;
+
+    template<typename SlotType, typename EntryType>
+    class Iterator
+    {
+        SlotType* m_slot;
+        SlotType* m_end;
+
+        void skipEmpty()
+        {
+            while (m_slot != m_end && !m_slot->Occupied)
+            {
+                ++m_slot;
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = EntryType;
+        using difference_type = std::ptrdiff_t;
+        using pointer = EntryType*;
+        using reference = EntryType&;
+
+        Iterator(SlotType* slot, SlotType* end) : m_slot(slot), m_end(end) { skipEmpty(); }
+
+        reference operator*() const { return m_slot->Entry; }
+        pointer operator->() const { return &m_slot->Entry; }
+
+        Iterator& operator++()
+        {
+            ++m_slot;
+            skipEmpty();
+            return *this;
+        }
+
+        Iterator operator++(int)
+        {
+            Iterator previous = *this;
+            ++(*this);
+            return previous;
+        }
+
+        bool operator==(const Iterator& other) const { return m_slot == other.m_slot; }
+        bool operator!=(const Iterator& other) const { return m_slot != other.m_slot; }
+
+        friend class FlatHashMap;
+    };
+
+public:
+    using iterator = Iterator<Slot, value_type>;
+    using const_iterator = Iterator<const Slot, const value_type>;
+
+    FlatHashMap(size_t capacity = MinimumCapacity)
+        : m_slots(RoundUpToPowerOfTwo(std::max<size_t>(capacity, MinimumCapacity)))
+        , m_mask(m_slots.size() - 1)
+        , m_size(0)
+    {
+    }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    iterator begin() { return iterator(m_slots.data(), m_slots.data() + m_slots.size()); }
+    iterator end() { return iterator(m_slots.data() + m_slots.size(), m_slots.data() + m_slots.size()); }
+    const_iterator begin() const { return const_iterator(m_slots.data(), m_slots.data() + m_slots.size()); }
+    const_iterator end() const { return const_iterator(m_slots.data() + m_slots.size(), m_slots.data() + m_slots.size()); }
+
+    iterator find(const Key& key)
+    {
+        return iteratorAt(findIndex(key));
+    }
+
+    const_iterator find(const Key& key) const
+    {
+        size_t index = findIndex(key);
+        return const_iterator(m_slots.data() + index, m_slots.data() + m_slots.size());
+    }
+
+    size_t count(const Key& key) const
+    {
+        return findIndex(key) != m_slots.size() ? 1 : 0;
+    }
+
+    // Insere l'element si la cle n'est pas deja presente. Retourne l'element de la table et si l'insertion a eu lieu.
+    std::pair<iterator, bool> insert(value_type value)
+    {
+        size_t index = findIndex(value.first);
+        if (index != m_slots.size())
+        {
+            return std::make_pair(iteratorAt(index), false);
+        }
+        reserve(m_size + 1);
+        index = insertNew(std::move(value));
+        return std::make_pair(iteratorAt(index), true);
+    }
+
+    Value& operator[](const Key& key)
+    {
+        size_t index = findIndex(key);
+        if (index == m_slots.size())
+        {
+            reserve(m_size + 1);
+            index = insertNew(value_type(key, Value()));
+        }
+        return m_slots[index].Entry.second;
+    }
+
+    void erase(iterator position)
+    {
+        eraseAt((size_t)(position.m_slot - m_slots.data()));
+    }
+
+    size_t erase(const Key& key)
+    {
+        size_t index = findIndex(key);
+        if (index == m_slots.size())
+        {
+            return 0;
+        }
+        eraseAt(index);
+        return 1;
+    }
+
+    void clear()
+    {
+        for (Slot& slot : m_slots)
+        {
+            slot = Slot();
+        }
+        m_size = 0;
+    }
+
+    // S'assure que count elements peuvent etre contenus sans depasser un taux de remplissage de 3/4
+    void reserve(size_t count)
+    {
+        if (count * 4 <= m_slots.size() * 3)
+        {
+            return;
+        }
+        std::vector<Slot> previous(RoundUpToPowerOfTwo((count * 4 + 2) / 3));
+        previous.swap(m_slots);
+        m_mask = m_slots.size() - 1;
+        m_size = 0;
+        for (Slot& slot : previous)
+        {
+            if (slot.Occupied)
+            {
+                insertNew(std::move(slot.Entry));
+            }
+        }
+    }
+
+private:
+    iterator iteratorAt(size_t index)
+    {
+        return iterator(m_slots.data() + index, m_slots.data() + m_slots.size());
+    }
+
+    size_t idealIndex(const Key& key) const
+    {
+        return m_hash(key) & m_mask;
+    }
+
+    // Retourne la case contenant la cle, ou m_slots.size() si elle est absente
+    size_t findIndex(const Key& key) const
+    {
+        size_t index = idealIndex(key);
+        while (m_slots[index].Occupied)
+        {
+            if (m_slots[index].Entry.first == key)
+            {
+                return index;
+            }
+            index = (index + 1) & m_mask;
+        }
+        return m_slots.size();
+    }
+
+    // La cle ne doit pas etre presente et il doit rester de la place
+    size_t insertNew(value_type&& value)
+    {
+        size_t index = idealIndex(value.first);
+        while (m_slots[index].Occupied)
+        {
+            index = (index + 1) & m_mask;
+        }
+        m_slots[index].Entry = std::move(value);
+        m_slots[index].Occupied = true;
+        ++m_size;
+        return index;
+    }
+
+    // Retire l'element puis recule les elements suivants de la meme sequence de sondage pour qu'aucun ne devienne introuvable
+    void eraseAt(size_t index)
+    {
+        size_t hole = index;
+        size_t next = (hole + 1) & m_mask;
+        while (m_slots[next].Occupied)
+        {
+            // L'element peut prendre la place du trou si le trou est entre sa case ideale et sa case actuelle
+            size_t ideal = idealIndex(m_slots[next].Entry.first);
+            if (((next - ideal) & m_mask) >= ((next - hole) & m_mask))
+            {
+                m_slots[hole].Entry = std::move(m_slots[next].Entry);
+                hole = next;
+            }
+            next = (next + 1) & m_mask;
+        }
+        m_slots[hole] = Slot();
+        --m_size;
+    }
+};
+
+template<typename Key, typename Value, typename Hash>
+constexpr size_t FlatHashMap<Key, Value, Hash>::MinimumCapacity;
+
+#endif //_GENERAL_FLAT_HASH_MAP_H_
@@ -1,28 +1,20 @@
 #include "MACAddress.h"
 #include "../General/Configuration.h"
 
-#include <iomanip>
-#include <sstream>
+#include <stdexcept>
 
-// Utilitaire pour l'affichage en hexadecimal
-struct HexStruct
+// Utilitaire pour l'affichage en hexadecimal, sans zero devant les valeurs plus petites que 0x10
+// Ecrit l'octet a la position out et retourne la position suivante
+static char* writeHex(char* out, uint8_t value)
 {
-    uint8_t c;
-    HexStruct(uint8_t _c) : c(_c) { }
-};
-
-inline std::ostream& operator<<(std::ostream& out, const HexStruct& hs)
-{
-    auto flags = out.flags();
-    out << std::setprecision(2) << std::hex << (uint32_t)hs.c;
-    out.flags(flags);
+    static const char digits[] = "0123456789abcdef";
+    if (value >= 0x10)
+    {
+        *out++ = digits[value >> 4];
+    }
+    *out++ = digits[value & 0xF];
     return out;
 }
-
-inline HexStruct hex(uint8_t _c)
-{
-    return HexStruct(_c);
-}
 //===========================================
 
 MACAddress::MACAddress()
@@ -51,45 +43,49 @@ MACAddress::MACAddress(const Configuration& config)
     m_address[5] = (uint8_t)config.get(Configuration::MAC_ADDRESS_BYTE_6);
 }
 
-bool MACAddress::operator==(const MACAddress& other) const
+MACAddress MACAddress::FromValue(uint64_t value)
 {
+    uint8_t address[6];
     for (size_t i = 0; i < 6; ++i)
     {
-        if (m_address[i] != other.m_address[i])
-        {
-            return false;
-        }
+        address[i] = (uint8_t)(value >> (8 * (5 - i)));
     }
-    return true;
-}
-
-bool MACAddress::operator!=(const MACAddress& other) const
-{
-    return !(*this == other);
+    return MACAddress(address);
 }
 
-bool MACAddress::operator<(const MACAddress& other) const
+MACAddress MACAddress::FromString(const std::string& text)
 {
-    if (m_address[0] >= other.m_address[0])
+    uint8_t address[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    size_t start = 0;
+    for (size_t index = 0; start <= text.size(); ++index)
     {
-        if (m_address[1] >= other.m_address[1])
+        size_t end = text.find(':', start);
+        if (end == std::string::npos)
         {
-            if (m_address[2] >= other.m_address[2])
-            {
-                if (m_address[3] >= other.m_address[3])
-                {
-                    if (m_address[4] >= other.m_address[4])
-                    {
-                        if (m_address[5] >= other.m_address[5])
-                        {
-                            return false;
-                        }
-                    }
-                }
-            }
+            end = text.size();
         }
+        if (index >= 6)
+        {
+            throw std::invalid_argument("L'adresse MAC " + text + " a plus de 6 octets.");
+        }
+        size_t parsed = 0;
+        int value = -1;
+        try
+        {
+            value = std::stoi(text.substr(start, end - start), &parsed, 16);
+        }
+        catch (const std::logic_error&)
+        {
+            // Octet vide, non hexadecimal ou trop grand : meme erreur que les autres adresses invalides
+        }
+        if (parsed != end - start || value < 0 || value > 0xFF)
+        {
+            throw std::invalid_argument("L'adresse MAC " + text + " est invalide.");
+        }
+        address[index] = (uint8_t)value;
+        start = end + 1;
     }
-    return true;
+    return MACAddress(address);
 }
 
 bool MACAddress::isUnicast() const
@@ -114,24 +110,30 @@ bool MACAddress::isLocallyAdministered() const
 
 std::string MACAddress::toString() const
 {
-    std::stringstream ss;
-    ss << hex(m_address[0]) << '-';
-    ss << hex(m_address[1]) << '-';
-    ss << hex(m_address[2]) << '-';
-    ss << hex(m_address[3]) << '-';
-    ss << hex(m_address[4]) << '-';
-    ss << hex(m_address[5]) << '-';
-    return ss.str();
+    // Au plus 2 caracteres et un separateur par octet
+    char text[18];
+    char* end = text;
+    for (size_t i = 0; i < 6; ++i)
+    {
+        end = writeHex(end, m_address[i]);
+        *end++ = '-';
+    }
+    return std::string(text, end);
 }
 
 
 std::ostream& operator<<(std::ostream& out, const MACAddress& address)
-{    
-    out << hex(address.m_address[0]) << ':';
-    out << hex(address.m_address[1]) << ':';
-    out << hex(address.m_address[2]) << ':';
-    out << hex(address.m_address[3]) << ':';
-    out << hex(address.m_address[4]) << ':';
-    out << hex(address.m_address[5]);    
+{
+    char text[18];
+    char* end = text;
+    for (size_t i = 0; i < 6; ++i)
+    {
+        if (i > 0)
+        {
+            *end++ = ':';
+        }
+        end = writeHex(end, address.m_address[i]);
+    }
+    out.write(text, end - text);
     return out;
 }
\ No newline at end of file
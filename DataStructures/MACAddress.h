@@ -1,12 +1,16 @@
 #ifndef _GENERAL_MAC_ADDRESS_H_
 #define _GENERAL_MAC_ADDRESS_H_
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <iostream>
 #include <string>
 
 class Configuration;
 
+// Les 6 octets sont gardes tels quels dans l'objet, car il est copie directement dans l'entete des paquets et des trames.
+// Les comparaisons se font sur la valeur entiere equivalente (voir value()), sans boucle ni branchement.
 class MACAddress
 {
     uint8_t m_address[6];
@@ -17,6 +21,16 @@ public:
     MACAddress(const MACAddress& other) = default;
     ~MACAddress() = default;
 
+    // Adresse correspondant aux 48 bits de poids faible de value
+    static MACAddress FromValue(uint64_t value);
+    // Adresse ecrite en hexadecimal avec des ':' entre les octets (ex. : DE:AD:BE:EF:00:01).
+    // Les octets absents valent 0xFF. Lance std::invalid_argument si le texte n'est pas une adresse.
+    static MACAddress FromString(const std::string& text);
+
+    // Les 6 octets sous forme d'un entier de 48 bits, le premier octet etant le plus significatif.
+    // L'ordre des valeurs est donc l'ordre lexicographique des adresses.
+    uint64_t value() const;
+
     bool operator==(const MACAddress& other) const;
     bool operator!=(const MACAddress& other) const;
 
@@ -33,4 +47,46 @@ public:
     friend std::ostream& operator<<(std::ostream& out, const MACAddress& address);
 };
 
+// Ces methodes sont appelees pour chaque paquet recu : elles sont definies ici pour pouvoir etre integrees a l'appelant
+inline uint64_t MACAddress::value() const
+{
+    return ((uint64_t)m_address[0] << 40) | ((uint64_t)m_address[1] << 32) | ((uint64_t)m_address[2] << 24)
+         | ((uint64_t)m_address[3] << 16) | ((uint64_t)m_address[4] << 8) | (uint64_t)m_address[5];
+}
+
+inline bool MACAddress::operator==(const MACAddress& other) const
+{
+    return value() == other.value();
+}
+
+inline bool MACAddress::operator!=(const MACAddress& other) const
+{
+    return value() != other.value();
+}
+
+inline bool MACAddress::operator<(const MACAddress& other) const
+{
+    return value() < other.value();
+}
+
+namespace std
+{
+    // Permet d'utiliser la MACAddress comme cle dans une table de hachage.
+    // Les bits de la valeur sont melanges pour que les bits de poids faible dependent de tous les octets de l'adresse.
+    template<>
+    struct hash<MACAddress>
+    {
+        size_t operator()(const MACAddress& address) const
+        {
+            uint64_t value = address.value();
+            value ^= value >> 33;
+            value *= 0xff51afd7ed558ccdULL;
+            value ^= value >> 33;
+            value *= 0xc4ceb9fe1a85ec53ULL;
+            value ^= value >> 33;
+            return (size_t)value;
+        }
+    };
+}
+
 #endif //_GENERAL_MAC_ADDRESS_H_
@@ -0,0 +1,158 @@
+#ifndef _GENERAL_OBJECT_QUEUE_H_
+#define _GENERAL_OBJECT_QUEUE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "SpscIndices.h"
+#include "Utils.h"
+#include "../General/Notifier.h"
+
+// File bornee d'objets de type T de style FIFO
+// Thread-safe pour 1 consommateur et 1 producteur seulement
+// Contrairement a CircularQueue, les objets ne sont pas serialises : ils sont deplaces dans une case de la file, puis hors de celle-ci.
+// Les index de lecture et d'ecriture sont ceux de SpscIndices, en objets : la case d'un index est index & m_mask.
+template<typename T>
+class ObjectQueue
+{
+    // Donnees en lecture seule apres la construction
+    size_t m_capacity;
+    size_t m_mask;
+    std::unique_ptr<T[]> m_slots;
+    Notifier* m_spaceNotifier; // Notifie par le consommateur lorsqu'il libere des cases
+    Notifier* m_dataNotifier; // Notifie par le producteur lorsqu'il publie un objet
+
+    SpscIndices m_indices;
+
+    // Notificateurs utilises par defaut. Ils peuvent etre remplaces pour qu'un meme fil d'execution attende plusieurs sources.
+    alignas(CacheLineSize) Notifier m_defaultSpaceNotifier;
+    alignas(CacheLineSize) Notifier m_defaultDataNotifier;
+
+    ObjectQueue& operator=(const ObjectQueue&) = delete;
+    ObjectQueue(const ObjectQueue&) = delete;
+
+    // Place la valeur dans la prochaine case libre et la rend visible pour le consommateur
+    template<typename U>
+    void emplace(U&& value)
+    {
+        if (!canWrite())
+        {
+            throw std::out_of_range("Il n'y a plus de place dans la file pour ajouter un objet.");
+        }
+        m_slots[m_indices.tail() & m_mask] = std::forward<U>(value);
+        m_indices.publish(1);
+        m_dataNotifier->notify();
+    }
+
+public:
+    ObjectQueue(size_t capacity)
+        : m_capacity(RoundUpToPowerOfTwo(std::max<size_t>(capacity, 1)))
+        , m_mask(m_capacity - 1)
+        , m_slots(new T[m_capacity])
+        , m_spaceNotifier(&m_defaultSpaceNotifier)
+        , m_dataNotifier(&m_defaultDataNotifier)
+    {
+    }
+
+    // Nombre d'objets de la taille de l'exemple qui entrent dans un buffer de bufferSize octets une fois serialises.
+    // Permet de garder la meme limite de memoire que les buffers d'octets configures.
+    static size_t CapacityFor(size_t bufferSize, const T& sample)
+    {
+        return std::max<size_t>(1, bufferSize / SizeOf<T>::data(sample));
+    }
+
+    size_t size() const
+    {
+        return m_indices.size();
+    }
+
+    size_t capacity() const
+    {
+        return m_capacity;
+    }
+
+    // Plus grand nombre d'objets presents en meme temps dans la file, lisible par n'importe quel fil
+    size_t highWaterMark() const
+    {
+        return m_indices.highWaterMark();
+    }
+
+    // Doivent etre appeles avant que le producteur et le consommateur commencent a utiliser la file
+    void setDataNotifier(Notifier* notifier)
+    {
+        m_dataNotifier = notifier;
+    }
+
+    void setSpaceNotifier(Notifier* notifier)
+    {
+        m_spaceNotifier = notifier;
+    }
+
+    Notifier& dataNotifier()
+    {
+        return *m_dataNotifier;
+    }
+
+    Notifier& spaceNotifier()
+    {
+        return *m_spaceNotifier;
+    }
+
+    // Appele seulement par le producteur
+    bool canWrite() const
+    {
+        return m_indices.hasSpaceFor(1, m_capacity);
+    }
+
+    void push(const T& value)
+    {
+        emplace(value);
+    }
+
+    void push(T&& value)
+    {
+        emplace(std::move(value));
+    }
+
+    // Appele seulement par le consommateur
+    bool canRead() const
+    {
+        return m_indices.readable(1) > 0;
+    }
+
+    T pop()
+    {
+        if (!canRead())
+        {
+            throw std::out_of_range("Il n'y a aucun objet dans la file.");
+        }
+        T value = std::move(m_slots[m_indices.head() & m_mask]);
+        m_indices.release(1);
+        m_spaceNotifier->notify();
+        return value;
+    }
+
+    // Deplace a la fin de values tous les objets disponibles, jusqu'a un maximum de maximumCount.
+    // Les cases ne sont liberees qu'une fois pour tout le lot. Retourne le nombre d'objets retires.
+    size_t popAll(std::vector<T>& values, size_t maximumCount = SIZE_MAX)
+    {
+        size_t count = std::min(m_indices.readable(1), maximumCount);
+        if (count > 0)
+        {
+            size_t head = m_indices.head();
+            values.reserve(values.size() + count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                values.push_back(std::move(m_slots[(head + i) & m_mask]));
+            }
+            m_indices.release(count);
+            m_spaceNotifier->notify();
+        }
+        return count;
+    }
+};
+
+#endif //_GENERAL_OBJECT_QUEUE_H_
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include "SharedDataBuffer.h"
+#include "BufferPool.h"
+
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+
+SharedDataBuffer::Block* SharedDataBuffer::allocate(uint32_t size)
+{
+#if DATA_BUFFER_USE_POOL
+    void* memory = BufferPool::allocate(sizeof(Block) + size);
+#else
+    void* memory = ::operator new(sizeof(Block) + size);
+#endif
+    Block* block = reinterpret_cast<Block*>(memory);
+    new (&block->RefCount) std::atomic<uint32_t>(1);
+    block->Size = size;
+    return block;
+}
+
+void SharedDataBuffer::acquire()
+{
+    if (m_block)
+    {
+        m_block->RefCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void SharedDataBuffer::release()
+{
+    // Le dernier proprietaire doit voir toutes les ecritures des autres avant de liberer le bloc
+    if (m_block && m_block->RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        m_block->RefCount.~atomic();
+#if DATA_BUFFER_USE_POOL
+        BufferPool::deallocate(m_block, sizeof(Block) + m_block->Size);
+#else
+        ::operator delete(m_block);
+#endif
+    }
+    m_block = nullptr;
+    m_offset = 0;
+    m_size = 0;
+}
+
+SharedDataBuffer::SharedDataBuffer()
+    : m_block(nullptr)
+    , m_offset(0)
+    , m_size(0)
+{
+}
+
+SharedDataBuffer::SharedDataBuffer(uint32_t dataSize)
+    : m_block(allocate(dataSize))
+    , m_offset(0)
+    , m_size(dataSize)
+{
+}
+
+SharedDataBuffer::SharedDataBuffer(uint32_t dataSize, const uint8_t* data)
+    : SharedDataBuffer(dataSize)
+{
+    std::memcpy(m_block->bytes(), data, dataSize);
+}
+
+SharedDataBuffer::SharedDataBuffer(const DynamicDataBuffer& buffer)
+    : SharedDataBuffer(buffer.size(), buffer.data())
+{
+}
+
+SharedDataBuffer::SharedDataBuffer(const SharedDataBuffer& other)
+    : m_block(other.m_block)
+    , m_offset(other.m_offset)
+    , m_size(other.m_size)
+{
+    acquire();
+}
+
+SharedDataBuffer::SharedDataBuffer(SharedDataBuffer&& other)
+    : m_block(other.m_block)
+    , m_offset(other.m_offset)
+    , m_size(other.m_size)
+{
+    other.m_block = nullptr;
+    other.m_offset = 0;
+    other.m_size = 0;
+}
+
+SharedDataBuffer::~SharedDataBuffer()
+{
+    release();
+}
+
+SharedDataBuffer& SharedDataBuffer::operator=(const SharedDataBuffer& other)
+{
+    // On vite l'autoassignement
+    if (&other != this)
+    {
+        release();
+        m_block = other.m_block;
+        m_offset = other.m_offset;
+        m_size = other.m_size;
+        acquire();
+    }
+    return *this;
+}
+
+SharedDataBuffer& SharedDataBuffer::operator=(SharedDataBuffer&& other)
+{
+    // On vite l'autoassignement
+    if (&other != this)
+    {
+        release();
+        m_block = other.m_block;
+        m_offset = other.m_offset;
+        m_size = other.m_size;
+        other.m_block = nullptr;
+        other.m_offset = 0;
+        other.m_size = 0;
+    }
+    return *this;
+}
+
+SharedDataBuffer SharedDataBuffer::slice(uint32_t offset, uint32_t count) const
+{
+    if (offset > m_size || count > m_size - offset)
+    {
+        throw std::out_of_range("La vue demandee depasse la fin du buffer.");
+    }
+    SharedDataBuffer view(*this);
+    view.m_offset += offset;
+    view.m_size = count;
+    return view;
+}
+
+bool SharedDataBuffer::unique() const
+{
+    return m_block == nullptr || m_block->RefCount.load(std::memory_order_acquire) == 1;
+}
+
+uint8_t* SharedDataBuffer::mutableData()
+{
+    if (m_block == nullptr)
+    {
+        return nullptr;
+    }
+    if (!unique())
+    {
+        // Copy-on-write : on garde une copie privee des octets de la vue seulement
+        SharedDataBuffer copy(m_size, data());
+        *this = std::move(copy);
+    }
+    return m_block->bytes() + m_offset;
+}
+
+uint8_t SharedDataBuffer::operator[](size_t index) const
+{
+    return data()[index];
+}
+
+const uint8_t* SharedDataBuffer::data() const
+{
+    return m_block ? m_block->bytes() + m_offset : nullptr;
+}
+
+uint32_t SharedDataBuffer::size() const
+{
+    return m_size;
+}
+
+DynamicDataBuffer SharedDataBuffer::toDynamicDataBuffer() const
+{
+    return DynamicDataBuffer(m_size, data());
+}
\ No newline at end of file
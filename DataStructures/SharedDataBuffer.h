@@ -0,0 +1,75 @@
+#ifndef _GENERAL_SHARED_DATA_BUFFER_H_
+#define _GENERAL_SHARED_DATA_BUFFER_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "DataBuffer.h"
+
+// Suite d'octets partagee entre plusieurs proprietaires par comptage de references
+// Copier un SharedDataBuffer ne copie pas les octets : seul le compteur de references du bloc est incremente.
+// Les octets sont consideres immuables des qu'ils sont partages. mutableData() fait une copie privee au besoin (copy-on-write).
+// Un SharedDataBuffer peut aussi etre une vue (slice) sur une partie des octets d'un autre, sans copie.
+class SharedDataBuffer
+{
+    // Bloc alloue en une seule fois : l'entete est suivi directement des octets
+    struct Block
+    {
+        std::atomic<uint32_t> RefCount;
+        uint32_t Size;
+
+        uint8_t* bytes() { return reinterpret_cast<uint8_t*>(this + 1); }
+    };
+
+    Block* m_block;
+    uint32_t m_offset;
+    uint32_t m_size;
+
+    static Block* allocate(uint32_t size);
+    void acquire();
+    void release();
+
+public:
+    SharedDataBuffer();
+    explicit SharedDataBuffer(uint32_t dataSize);
+    SharedDataBuffer(uint32_t dataSize, const uint8_t* data);
+    explicit SharedDataBuffer(const DynamicDataBuffer& buffer);
+    SharedDataBuffer(const SharedDataBuffer& other);
+    SharedDataBuffer(SharedDataBuffer&& other);
+    ~SharedDataBuffer();
+
+    SharedDataBuffer& operator=(const SharedDataBuffer& other);
+    SharedDataBuffer& operator=(SharedDataBuffer&& other);
+
+    // Vue sur count octets a partir de la position offset. Les octets ne sont pas copies.
+    SharedDataBuffer slice(uint32_t offset, uint32_t count) const;
+
+    // Indique si ce buffer est le seul a referencer ses octets
+    bool unique() const;
+
+    // Acces en ecriture. Si les octets sont partages, ils sont d'abord copies pour ne pas modifier ceux des autres proprietaires.
+    uint8_t* mutableData();
+
+    uint8_t operator[](size_t index) const;
+
+    const uint8_t* data() const;
+    uint32_t size() const;
+
+    DynamicDataBuffer toDynamicDataBuffer() const;
+};
+
+
+// Utilitaire pour verifier la taille reelle d'un objet de type SharedDataBuffer une fois serialise
+// Cette specialisation remplace l'implementation de base de la structure dans Utils.h lorsque le type T est SharedDataBuffer
+template<>
+struct SizeOf<SharedDataBuffer>
+{
+    static constexpr size_t value = sizeof(SharedDataBuffer);
+
+    static size_t data(const SharedDataBuffer& data)
+    {
+        return sizeof(uint32_t) + data.size();
+    }
+};
+
+#endif //_GENERAL_SHARED_DATA_BUFFER_H_
@@ -0,0 +1,111 @@
+#ifndef _GENERAL_SPSC_INDICES_H_
+#define _GENERAL_SPSC_INDICES_H_
+
+#include <atomic>
+#include <cstddef>
+
+#include "Utils.h"
+
+// Index de lecture et d'ecriture d'une file circulaire pour 1 consommateur et 1 producteur, partages par CircularQueue et ObjectQueue.
+// Les index ne font qu'augmenter : la position dans le stockage est index & mask et la taille est tail - head.
+// L'unite (octet ou objet) est celle de la file. Chaque cote garde la derniere valeur connue de l'index de l'autre
+// et ne la relit que si elle ne suffit pas, pour eviter de faire passer la ligne de cache de l'autre cote a chaque operation.
+class SpscIndices
+{
+    // Donnees du consommateur, sur leur propre ligne de cache
+    alignas(CacheLineSize) std::atomic<size_t> m_head;
+    mutable size_t m_cachedTail; // Derniere valeur de m_tail vue par le consommateur
+
+    // Donnees du producteur, sur leur propre ligne de cache
+    alignas(CacheLineSize) std::atomic<size_t> m_tail;
+    mutable size_t m_cachedHead; // Derniere valeur de m_head vue par le producteur
+    std::atomic<size_t> m_highWaterMark; // Ecrit seulement par le producteur, lu par les metriques
+
+    SpscIndices& operator=(const SpscIndices&) = delete;
+    SpscIndices(const SpscIndices&) = delete;
+
+public:
+    SpscIndices()
+        : m_head(0)
+        , m_cachedTail(0)
+        , m_tail(0)
+        , m_cachedHead(0)
+        , m_highWaterMark(0)
+    {
+    }
+
+    // Lisible par n'importe quel fil
+    size_t size() const
+    {
+        // On lit le debut avant la fin : la fin ne fait qu'augmenter, la taille ne peut donc pas etre negative
+        size_t head = m_head.load(std::memory_order_acquire);
+        size_t tail = m_tail.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    // Plus grande taille atteinte, lisible par n'importe quel fil
+    size_t highWaterMark() const
+    {
+        return m_highWaterMark.load(std::memory_order_relaxed);
+    }
+
+    // Appeles seulement par le producteur
+    size_t tail() const
+    {
+        return m_tail.load(std::memory_order_relaxed);
+    }
+
+    bool hasSpaceFor(size_t count, size_t capacity) const
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead + count <= capacity)
+        {
+            return true;
+        }
+        m_cachedHead = m_head.load(std::memory_order_acquire);
+        return tail - m_cachedHead + count <= capacity;
+    }
+
+    // Rend visibles pour le consommateur les count elements ecrits a partir de tail().
+    // m_cachedHead peut etre en retard et surestimer la taille : m_head n'est relu que si l'estimation depasse le maximum connu.
+    void publish(size_t count)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed) + count;
+        m_tail.store(tail, std::memory_order_release);
+        size_t highWaterMark = m_highWaterMark.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead > highWaterMark)
+        {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead > highWaterMark)
+            {
+                m_highWaterMark.store(tail - m_cachedHead, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Appeles seulement par le consommateur
+    size_t head() const
+    {
+        return m_head.load(std::memory_order_relaxed);
+    }
+
+    // Nombre d'elements qu'on peut lire. m_tail n'est relu que si sa derniere valeur connue en donne moins que neededCount :
+    // avec 0, rien n'est relu, avec SIZE_MAX, m_tail est toujours relu.
+    size_t readable(size_t neededCount) const
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (m_cachedTail - head < neededCount)
+        {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+        }
+        return m_cachedTail - head;
+    }
+
+    // Libere pour le producteur les count elements lus a partir de head()
+    void release(size_t count)
+    {
+        m_head.store(m_head.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+};
+
+#endif //_GENERAL_SPSC_INDICES_H_
@@ -0,0 +1,43 @@
+#include "SyntheticStream.h"
+
+#include <algorithm>
+#include <cstring>
+
+constexpr size_t SyntheticStream::Buffer::BlockSize;
+
+SyntheticStream::Buffer::Buffer(uint64_t size, uint32_t seed)
+    : m_random(seed)
+    , m_remaining(size)
+{
+    setg(m_block, m_block, m_block);
+}
+
+SyntheticStream::Buffer::int_type SyntheticStream::Buffer::underflow()
+{
+    if (gptr() < egptr())
+    {
+        return traits_type::to_int_type(*gptr());
+    }
+    if (m_remaining == 0)
+    {
+        return traits_type::eof();
+    }
+
+    // Le generateur donne 4 octets a la fois
+    size_t count = (size_t)std::min<uint64_t>(BlockSize, m_remaining);
+    for (size_t i = 0; i < count; i += sizeof(uint32_t))
+    {
+        uint32_t value = m_random();
+        std::memcpy(&m_block[i], &value, std::min(sizeof(uint32_t), count - i));
+    }
+    m_remaining -= count;
+    setg(m_block, m_block, m_block + count);
+    return traits_type::to_int_type(*gptr());
+}
+
+SyntheticStream::SyntheticStream(uint64_t size, uint32_t seed)
+    : std::istream(nullptr)
+    , m_buffer(size, seed)
+{
+    rdbuf(&m_buffer);
+}
\ No newline at end of file
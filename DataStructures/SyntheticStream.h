@@ -0,0 +1,35 @@
+#ifndef _GENERAL_SYNTHETIC_STREAM_H_
+#define _GENERAL_SYNTHETIC_STREAM_H_
+
+#include <cstdint>
+#include <istream>
+#include <random>
+#include <streambuf>
+
+// Flux en lecture seule de size octets pseudo-aleatoires, generes au fur et a mesure de la lecture.
+// Remplace un fichier sur le disque pour les charges synthetiques (voir l'instruction workload de Scenario) :
+// seul un petit bloc est en memoire, quelle que soit la taille du fichier. Le contenu ne depend que de la graine.
+class SyntheticStream : public std::istream
+{
+    class Buffer : public std::streambuf
+    {
+        static constexpr size_t BlockSize = 4096;
+
+        std::mt19937 m_random;
+        uint64_t m_remaining; // Octets qui restent a generer
+        char m_block[BlockSize];
+
+    protected:
+        int_type underflow() override;
+
+    public:
+        Buffer(uint64_t size, uint32_t seed);
+    };
+
+    Buffer m_buffer;
+
+public:
+    SyntheticStream(uint64_t size, uint32_t seed);
+};
+
+#endif //_GENERAL_SYNTHETIC_STREAM_H_
@@ -2,7 +2,38 @@
 #define _GENERAL_UTILS_H_
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+// Taille d'une ligne de cache, pour separer les donnees modifiees par des fils d'execution differents
+static constexpr size_t CacheLineSize = 64;
+
+// Arrondit la valeur a la puissance de 2 superieure
+static inline size_t RoundUpToPowerOfTwo(size_t value)
+{
+    size_t result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+// Suite contigue d'octets, utilisee pour ecrire ou lire la representation d'un objet en une seule operation
+struct ByteSpan
+{
+    uint8_t* Data;
+    size_t Size;
+};
+
+struct ConstByteSpan
+{
+    const uint8_t* Data;
+    size_t Size;
+};
+
 
 template<typename T>
 struct SizeOf
@@ -37,13 +68,14 @@ struct FromDataPtr
     static T get(const uint8_t* data, size_t dataSize)
     {
         T dataValue;
-        uint8_t* dataPtr = reinterpret_cast<uint8_t*>(&dataValue);
-        for (size_t i = 0; i < dataSize; ++i)
-        {
-            dataPtr[i] = data[i];
-        }
+        std::memcpy(reinterpret_cast<uint8_t*>(&dataValue), data, std::min(dataSize, sizeof(T)));
         return dataValue;
     }
+
+    static T deserializeFrom(ConstByteSpan buffer)
+    {
+        return get(buffer.Data, buffer.Size);
+    }
 };
 
 template<typename T>
@@ -53,13 +85,27 @@ struct ToDataPtr
     
     ToDataPtr(const T& data) : Data(data) {}
 
-    uint8_t operator[](size_t byteIndex)
+    size_t size() const { return SizeOf<T>::data(Data); }
+
+    // Ecrit la representation complete de l'objet au debut du buffer et retourne le nombre d'octets ecrits
+    size_t serializeInto(ByteSpan buffer) const
     {
-        const uint8_t* dataPtr = reinterpret_cast<const uint8_t*>(&Data);
-        return dataPtr[byteIndex];
+        size_t dataSize = size();
+        if (buffer.Size < dataSize)
+        {
+            throw std::out_of_range("Le buffer est trop petit pour contenir la representation de l'objet.");
+        }
+        std::memcpy(buffer.Data, reinterpret_cast<const uint8_t*>(&Data), dataSize);
+        return dataSize;
     }
 
-    size_t size() const { return SizeOf<T>::data(Data); }
+    // Appelle la fonction pour chaque segment d'octets contigus de l'objet, dans l'ordre de la representation
+    // La fonction recoit un pointeur sur le debut du segment et la taille du segment
+    template<typename Function>
+    void forEachSegment(Function function) const
+    {
+        function(reinterpret_cast<const uint8_t*>(&Data), size());
+    }
 
     /*static uint8_t* get(const T& data)
     {
@@ -7,11 +7,25 @@
 const std::string Configuration::NETWORK_LAYER_RECEIVING_BUFFER_SIZE = "NetworkLayerReceivingBufferSize";
 const std::string Configuration::NETWORK_LAYER_SENDING_BUFFER_SIZE = "NetworkLayerSendingBufferSize";
 const std::string Configuration::NETWORK_LAYER_DATA_SIZE = "NetworkLayerDataSize";
+const std::string Configuration::NETWORK_LAYER_SAVE_RECEIVED_FILES = "NetworkLayerSaveReceivedFiles";
 
 const std::string Configuration::LINK_LAYER_RECEIVING_BUFFER_SIZE = "LinkLayerReceivingBufferSize";
 const std::string Configuration::LINK_LAYER_SENDING_BUFFER_SIZE = "LinkLayerSendingBufferSize";
 const std::string Configuration::LINK_LAYER_MAXIMUM_BUFFERED_FRAME = "LinkLayerMaximumBufferedFrame";
 const std::string Configuration::LINK_LAYER_TIMEOUT = "LinkLayerTimeout";
+const std::string Configuration::LINK_LAYER_TIMER_QUEUE = "LinkLayerTimerQueue";
+
+const std::string Configuration::TIMER_SERVICE_THREAD_COUNT = "TimerServiceThreadCount";
+
+const std::string Configuration::EXECUTOR_ENABLED = "ExecutorEnabled";
+const std::string Configuration::EXECUTOR_THREAD_COUNT = "ExecutorThreadCount";
+
+const std::string Configuration::DISCRETE_EVENT_SIMULATION_ENABLED = "DiscreteEventSimulationEnabled";
+const std::string Configuration::DISCRETE_EVENT_SIMULATION_THREAD_COUNT = "DiscreteEventSimulationThreadCount";
+
+const std::string Configuration::METRICS_EXPORT_INTERVAL = "MetricsExportInterval";
+
+const std::string Configuration::LOG_THREAD_BUFFER_SIZE = "LogThreadBufferSize";
 
 const std::string Configuration::PHYSICAL_LAYER_RECEIVING_BUFFER_SIZE = "PhysicalLayerReceivingBufferSize";
 const std::string Configuration::PHYSICAL_LAYER_SENDING_BUFFER_SIZE = "PhysicalLayerSendingBufferSize";
@@ -21,6 +35,8 @@ const std::string Configuration::TRANSMISSION_HUB_BUFFER_SIZE = "TransmissionHub
 const std::string Configuration::TRANSMISSION_HUB_NOISE = "TransmissionHubNoise";
 const std::string Configuration::TRANSMISSION_HUB_NOISE_FREQUENCY = "TransmissionHubNoiseFrequency";
 const std::string Configuration::TRANSMISSION_HUB_NOISE_BYTE_ERROR_FREQUENCY = "TransmissionHubNoiseByteErrorFrequency";
+const std::string Configuration::TRANSMISSION_HUB_NOISE_SEED = "TransmissionHubNoiseSeed";
+const std::string Configuration::TRANSMISSION_HUB_LATENCY = "TransmissionHubLatency";
 
 const std::string Configuration::MAC_ADDRESS_BYTE_1 = "MacAddressByte1";
 const std::string Configuration::MAC_ADDRESS_BYTE_2 = "MacAddressByte2";
@@ -30,6 +46,11 @@ const std::string Configuration::MAC_ADDRESS_BYTE_5 = "MacAddressByte5";
 const std::string Configuration::MAC_ADDRESS_BYTE_6 = "MacAddressByte6";
 
 
+Configuration::Configuration()
+{
+    init();
+}
+
 Configuration::Configuration(const std::string& configFilename)
 {
     init();
@@ -58,11 +79,25 @@ void Configuration::init()
     m_configs[Configuration::NETWORK_LAYER_RECEIVING_BUFFER_SIZE] = Configuration::NETWORK_LAYER_RECEIVING_BUFFER_SIZE_DEFAULT_VALUE;
     m_configs[Configuration::NETWORK_LAYER_SENDING_BUFFER_SIZE] = Configuration::NETWORK_LAYER_SENDING_BUFFER_SIZE_DEFAULT_VALUE;
     m_configs[Configuration::NETWORK_LAYER_DATA_SIZE] = Configuration::NETWORK_LAYER_DATA_SIZE_DEFAULT_VALUE;
+    m_configs[Configuration::NETWORK_LAYER_SAVE_RECEIVED_FILES] = Configuration::NETWORK_LAYER_SAVE_RECEIVED_FILES_DEFAULT_VALUE;
 
     m_configs[Configuration::LINK_LAYER_RECEIVING_BUFFER_SIZE] = Configuration::LINK_LAYER_RECEIVING_BUFFER_SIZE_DEFAULT_VALUE;
     m_configs[Configuration::LINK_LAYER_SENDING_BUFFER_SIZE] = Configuration::LINK_LAYER_SENDING_BUFFER_SIZE_DEFAULT_VALUE;
     m_configs[Configuration::LINK_LAYER_MAXIMUM_BUFFERED_FRAME] = Configuration::LINK_LAYER_MAXIMUM_BUFFERED_FRAME_DEFAULT_VALUE;
     m_configs[Configuration::LINK_LAYER_TIMEOUT] = Configuration::LINK_LAYER_TIMEOUT_DEFAULT_VALUE;
+    m_configs[Configuration::LINK_LAYER_TIMER_QUEUE] = Configuration::LINK_LAYER_TIMER_QUEUE_DEFAULT_VALUE;
+
+    m_configs[Configuration::TIMER_SERVICE_THREAD_COUNT] = Configuration::TIMER_SERVICE_THREAD_COUNT_DEFAULT_VALUE;
+
+    m_configs[Configuration::EXECUTOR_ENABLED] = Configuration::EXECUTOR_ENABLED_DEFAULT_VALUE;
+    m_configs[Configuration::EXECUTOR_THREAD_COUNT] = Configuration::EXECUTOR_THREAD_COUNT_DEFAULT_VALUE;
+
+    m_configs[Configuration::DISCRETE_EVENT_SIMULATION_ENABLED] = Configuration::DISCRETE_EVENT_SIMULATION_ENABLED_DEFAULT_VALUE;
+    m_configs[Configuration::DISCRETE_EVENT_SIMULATION_THREAD_COUNT] = Configuration::DISCRETE_EVENT_SIMULATION_THREAD_COUNT_DEFAULT_VALUE;
+
+    m_configs[Configuration::METRICS_EXPORT_INTERVAL] = Configuration::METRICS_EXPORT_INTERVAL_DEFAULT_VALUE;
+
+    m_configs[Configuration::LOG_THREAD_BUFFER_SIZE] = Configuration::LOG_THREAD_BUFFER_SIZE_DEFAULT_VALUE;
 
     m_configs[Configuration::PHYSICAL_LAYER_RECEIVING_BUFFER_SIZE] = Configuration::PHYSICAL_LAYER_RECEIVING_BUFFER_SIZE_DEFAULT_VALUE;
     m_configs[Configuration::PHYSICAL_LAYER_SENDING_BUFFER_SIZE] = Configuration::PHYSICAL_LAYER_SENDING_BUFFER_SIZE_DEFAULT_VALUE;
@@ -72,6 +107,8 @@ void Configuration::init()
     m_configs[Configuration::TRANSMISSION_HUB_NOISE] = Configuration::TRANSMISSION_HUB_NOISE_DEFAULT_VALUE;
     m_configs[Configuration::TRANSMISSION_HUB_NOISE_FREQUENCY] = Configuration::TRANSMISSION_HUB_NOISE_FREQUENCY_DEFAULT_VALUE;
     m_configs[Configuration::TRANSMISSION_HUB_NOISE_BYTE_ERROR_FREQUENCY] = Configuration::TRANSMISSION_HUB_NOISE_BYTE_ERROR_FREQUENCY_DEFAULT_VALUE;
+    m_configs[Configuration::TRANSMISSION_HUB_NOISE_SEED] = Configuration::TRANSMISSION_HUB_NOISE_SEED_DEFAULT_VALUE;
+    m_configs[Configuration::TRANSMISSION_HUB_LATENCY] = Configuration::TRANSMISSION_HUB_LATENCY_DEFAULT_VALUE;
 
     m_configs[Configuration::MAC_ADDRESS_BYTE_1] = Configuration::MAC_ADDRESS_BYTE_1_DEFAULT_VALUE;
     m_configs[Configuration::MAC_ADDRESS_BYTE_2] = Configuration::MAC_ADDRESS_BYTE_2_DEFAULT_VALUE;
@@ -89,4 +126,14 @@ int Configuration::get(const std::string& paramName) const
         return (*it).second;
     }
     throw std::invalid_argument("Le parametre demande n'existe pas dans la configuration.");
+}
+
+void Configuration::set(const std::string& paramName, int value)
+{
+    auto it = m_configs.find(paramName);
+    if (it == m_configs.end())
+    {
+        throw std::invalid_argument("Le parametre " + paramName + " n'existe pas dans la configuration.");
+    }
+    (*it).second = value;
 }
\ No newline at end of file
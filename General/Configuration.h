@@ -14,18 +14,46 @@ public:
     static const std::string NETWORK_LAYER_RECEIVING_BUFFER_SIZE;
     static const std::string NETWORK_LAYER_SENDING_BUFFER_SIZE;
     static const std::string NETWORK_LAYER_DATA_SIZE;
+    static const std::string NETWORK_LAYER_SAVE_RECEIVED_FILES;
     static const int NETWORK_LAYER_RECEIVING_BUFFER_SIZE_DEFAULT_VALUE = 500000;    
     static const int NETWORK_LAYER_SENDING_BUFFER_SIZE_DEFAULT_VALUE = 500000;
     static const int NETWORK_LAYER_DATA_SIZE_DEFAULT_VALUE = 50;
+    static const int NETWORK_LAYER_SAVE_RECEIVED_FILES_DEFAULT_VALUE = 1; // 0 : les fichiers recus sont seulement comptes, pas ecrits sur le disque
 
     static const std::string LINK_LAYER_RECEIVING_BUFFER_SIZE;
     static const std::string LINK_LAYER_SENDING_BUFFER_SIZE;
     static const std::string LINK_LAYER_MAXIMUM_BUFFERED_FRAME;
     static const std::string LINK_LAYER_TIMEOUT;
+    static const std::string LINK_LAYER_TIMER_QUEUE;
     static const int LINK_LAYER_RECEIVING_BUFFER_SIZE_DEFAULT_VALUE = 500000;
     static const int LINK_LAYER_SENDING_BUFFER_SIZE_DEFAULT_VALUE = 500000;
     static const int LINK_LAYER_MAXIMUM_BUFFERED_FRAME_DEFAULT_VALUE = 4;
     static const int LINK_LAYER_TIMEOUT_DEFAULT_VALUE = 1000; // En millisecondes
+    static const int LINK_LAYER_TIMER_QUEUE_DEFAULT_VALUE = 0; // 0 : roue de temporisation, 1 : monceau binaire. Lu dans la configuration globale.
+
+    // Lus dans la configuration globale : les timers sont partages par tous les ordinateurs (voir TimerService)
+    static const std::string TIMER_SERVICE_THREAD_COUNT;
+    static const int TIMER_SERVICE_THREAD_COUNT_DEFAULT_VALUE = 0; // 0 : un fil par coeur
+
+    // Lus dans la configuration globale : les boucles des couches de tous les ordinateurs partagent l'Executor
+    static const std::string EXECUTOR_ENABLED;
+    static const std::string EXECUTOR_THREAD_COUNT;
+    static const int EXECUTOR_ENABLED_DEFAULT_VALUE = 0; // 0 : un fil par boucle de couche, 1 : les boucles sont des taches de l'Executor
+    static const int EXECUTOR_THREAD_COUNT_DEFAULT_VALUE = 0; // 0 : un fil par coeur
+
+    // Lus dans la configuration globale : remplace les fils, l'Executor et les timers par une horloge virtuelle (voir EventSimulator)
+    static const std::string DISCRETE_EVENT_SIMULATION_ENABLED;
+    static const std::string DISCRETE_EVENT_SIMULATION_THREAD_COUNT;
+    static const int DISCRETE_EVENT_SIMULATION_ENABLED_DEFAULT_VALUE = 0;
+    static const int DISCRETE_EVENT_SIMULATION_THREAD_COUNT_DEFAULT_VALUE = 0; // Nombre de partitions. 0 : une par coeur. Le resultat ne depend pas de ce nombre.
+
+    // Lu dans la configuration globale : intervalle entre deux exports des metriques (voir l'option -m du simulateur)
+    static const std::string METRICS_EXPORT_INTERVAL;
+    static const int METRICS_EXPORT_INTERVAL_DEFAULT_VALUE = 1000; // En millisecondes, en temps reel meme en simulation a evenements discrets
+
+    // Lu dans la configuration globale : taille du buffer de journalisation de chaque fil d'execution (voir LogWriter)
+    static const std::string LOG_THREAD_BUFFER_SIZE;
+    static const int LOG_THREAD_BUFFER_SIZE_DEFAULT_VALUE = 32 * 1024; // En octets. Le fil d'ecriture vide les buffers toutes les 10 ms.
 
     static const std::string PHYSICAL_LAYER_RECEIVING_BUFFER_SIZE;
     static const std::string PHYSICAL_LAYER_SENDING_BUFFER_SIZE;
@@ -38,10 +66,14 @@ public:
     static const std::string TRANSMISSION_HUB_NOISE;
     static const std::string TRANSMISSION_HUB_NOISE_FREQUENCY;
     static const std::string TRANSMISSION_HUB_NOISE_BYTE_ERROR_FREQUENCY;
+    static const std::string TRANSMISSION_HUB_NOISE_SEED;
+    static const std::string TRANSMISSION_HUB_LATENCY;
     static const int TRANSMISSION_HUB_BUFFER_SIZE_DEFAULT_VALUE = 500000;
     static const int TRANSMISSION_HUB_NOISE_DEFAULT_VALUE = 1;
     static const int TRANSMISSION_HUB_NOISE_FREQUENCY_DEFAULT_VALUE = 10;
     static const int TRANSMISSION_HUB_NOISE_BYTE_ERROR_FREQUENCY_DEFAULT_VALUE = 1;
+    static const int TRANSMISSION_HUB_NOISE_SEED_DEFAULT_VALUE = 5489; // Graine par defaut de std::mt19937
+    static const int TRANSMISSION_HUB_LATENCY_DEFAULT_VALUE = 100; // En microsecondes, utilise seulement par la simulation a evenements discrets. Doit etre positive.
 
     static const std::string MAC_ADDRESS_BYTE_1;
     static const std::string MAC_ADDRESS_BYTE_2;
@@ -56,9 +88,12 @@ public:
     static const int MAC_ADDRESS_BYTE_5_DEFAULT_VALUE = 0x00;
     static const int MAC_ADDRESS_BYTE_6_DEFAULT_VALUE = 0x01;
 
+    Configuration(); // Valeurs par defaut seulement
     Configuration(const std::string& configFilename);
     ~Configuration() = default;
     int get(const std::string& paramName) const;
+    // Remplace la valeur d'un parametre existant. Lance std::invalid_argument si le parametre n'existe pas.
+    void set(const std::string& paramName, int value);
 };
 
 #endif //_GENERAL_CONFIGURATION_H_
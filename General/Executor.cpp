@@ -0,0 +1,298 @@
+#include "Executor.h"
+#include "Configuration.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+std::atomic<TaskScheduler*> TaskScheduler::s_active(nullptr);
+
+TaskScheduler* TaskScheduler::Active()
+{
+    return s_active;
+}
+
+void TaskScheduler::SetActive(TaskScheduler* scheduler)
+{
+    s_active = scheduler;
+}
+
+//===========================================
+
+constexpr unsigned int Task::StepBudget;
+
+Task::Task(TaskScheduler& scheduler, std::function<bool()> step)
+    : m_scheduler(scheduler)
+    , m_step(std::move(step))
+    , m_state(Stopped)
+    , m_stopRequested(false)
+{
+    m_scheduler.registerTask(this);
+}
+
+Task::~Task()
+{
+    stop();
+    m_scheduler.unregisterTask(this);
+}
+
+void Task::start()
+{
+    m_stopRequested = false;
+    int expected = Stopped;
+    if (m_state.compare_exchange_strong(expected, Idle))
+    {
+        schedule();
+    }
+}
+
+void Task::stop()
+{
+    // Une execution en cours ou deja programmee se termine d'elle-meme en voyant la demande d'arret
+    m_stopRequested = true;
+    int expected = Idle;
+    while (!m_state.compare_exchange_weak(expected, Stopped))
+    {
+        if (expected == Stopped)
+        {
+            return;
+        }
+        expected = Idle;
+        std::this_thread::yield();
+    }
+}
+
+void Task::schedule()
+{
+    int state = m_state.load();
+    while (true)
+    {
+        if (state == Idle)
+        {
+            if (m_state.compare_exchange_weak(state, Scheduled))
+            {
+                m_scheduler.submit(this);
+                return;
+            }
+        }
+        else if (state == Running)
+        {
+            // Le fil qui execute la tache la reprogrammera a la fin de son execution
+            if (m_state.compare_exchange_weak(state, Rescheduled))
+            {
+                return;
+            }
+        }
+        else
+        {
+            return;
+        }
+    }
+}
+
+void Task::run()
+{
+    m_state = Running;
+    bool budgetExhausted = false;
+    if (!m_stopRequested)
+    {
+        budgetExhausted = true;
+        for (unsigned int i = 0; i < StepBudget && !m_stopRequested; ++i)
+        {
+            if (!m_step())
+            {
+                budgetExhausted = false;
+                break;
+            }
+        }
+    }
+
+    int expected = Running;
+    if (m_stopRequested || (!budgetExhausted && m_state.compare_exchange_strong(expected, Idle)))
+    {
+        m_state = Idle;
+        return;
+    }
+    // Encore du travail ou une notification recue pendant l'execution : la tache retourne a la fin d'une file
+    m_state = Scheduled;
+    m_scheduler.submit(this);
+}
+
+void Task::discard()
+{
+    m_state = Idle;
+}
+
+//===========================================
+
+thread_local Executor* Executor::s_currentExecutor = nullptr;
+thread_local size_t Executor::s_currentWorker = 0;
+
+std::mutex Executor::s_sharedMutex;
+std::unique_ptr<Executor> Executor::s_shared;
+
+Executor::Executor(size_t threadCount)
+    : m_queuedCount(0)
+    , m_nextWorker(0)
+    , m_running(true)
+    , m_lastSweep(0)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        m_workers[i]->Thread = std::thread(&Executor::work, this, i);
+    }
+}
+
+Executor::~Executor()
+{
+    m_running = false;
+    m_workNotifier.notify();
+    for (std::unique_ptr<Worker>& worker : m_workers)
+    {
+        if (worker->Thread.joinable())
+        {
+            worker->Thread.join();
+        }
+    }
+    // Les taches encore programmees ne seront jamais executees : on les libere pour que leur arret ne les attende pas
+    for (std::unique_ptr<Worker>& worker : m_workers)
+    {
+        for (Task* task : worker->Tasks)
+        {
+            task->discard();
+        }
+        worker->Tasks.clear();
+    }
+}
+
+size_t Executor::threadCount() const
+{
+    return m_workers.size();
+}
+
+void Executor::registerTask(Task* task)
+{
+    std::lock_guard<std::mutex> lock(m_tasksMutex);
+    m_tasks.insert(task);
+}
+
+void Executor::unregisterTask(Task* task)
+{
+    std::lock_guard<std::mutex> lock(m_tasksMutex);
+    m_tasks.erase(task);
+}
+
+void Executor::submit(Task* task)
+{
+    // Un fil de l'Executor garde les taches qu'il programme, les autres fils les repartissent a tour de role
+    size_t index = (s_currentExecutor == this) ? s_currentWorker : m_nextWorker.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+    {
+        std::lock_guard<std::mutex> lock(m_workers[index]->Mutex);
+        m_workers[index]->Tasks.push_back(task);
+    }
+    m_queuedCount.fetch_add(1);
+    m_workNotifier.notify();
+}
+
+Task* Executor::nextTask(size_t workerIndex)
+{
+    if (m_queuedCount.load() == 0)
+    {
+        return nullptr;
+    }
+
+    {
+        Worker& own = *m_workers[workerIndex];
+        std::lock_guard<std::mutex> lock(own.Mutex);
+        if (!own.Tasks.empty())
+        {
+            Task* task = own.Tasks.front();
+            own.Tasks.pop_front();
+            m_queuedCount.fetch_sub(1);
+            return task;
+        }
+    }
+
+    for (size_t i = 1; i < m_workers.size(); ++i)
+    {
+        Worker& victim = *m_workers[(workerIndex + i) % m_workers.size()];
+        std::lock_guard<std::mutex> lock(victim.Mutex);
+        if (!victim.Tasks.empty())
+        {
+            Task* task = victim.Tasks.back();
+            victim.Tasks.pop_back();
+            m_queuedCount.fetch_sub(1);
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void Executor::sweep()
+{
+    // Un seul fil reprogramme les taches par periode
+    int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t last = m_lastSweep.load();
+    if (now - last < Notifier::MaximumWaitTime.count() || !m_lastSweep.compare_exchange_strong(last, now))
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_tasksMutex);
+    for (Task* task : m_tasks)
+    {
+        task->schedule();
+    }
+}
+
+void Executor::work(size_t workerIndex)
+{
+    s_currentExecutor = this;
+    s_currentWorker = workerIndex;
+    while (m_running)
+    {
+        sweep();
+        Task* task = nextTask(workerIndex);
+        if (task)
+        {
+            task->run();
+        }
+        else
+        {
+            m_workNotifier.wait([this]() { return !m_running || m_queuedCount.load() > 0; });
+        }
+    }
+    s_currentExecutor = nullptr;
+}
+
+Executor& Executor::Shared()
+{
+    std::lock_guard<std::mutex> lock(s_sharedMutex);
+    if (!s_shared)
+    {
+        Configuration defaultConfig;
+        s_shared = std::make_unique<Executor>(defaultConfig.get(Configuration::EXECUTOR_THREAD_COUNT));
+    }
+    return *s_shared;
+}
+
+void Executor::ConfigureShared(const Configuration& config)
+{
+    std::lock_guard<std::mutex> lock(s_sharedMutex);
+    if (s_shared)
+    {
+        throw std::logic_error("L'executeur partage est deja utilise, il ne peut plus etre configure.");
+    }
+    if (config.get(Configuration::EXECUTOR_ENABLED) != 0)
+    {
+        s_shared = std::make_unique<Executor>(config.get(Configuration::EXECUTOR_THREAD_COUNT));
+        SetActive(s_shared.get());
+    }
+}
\ No newline at end of file
@@ -0,0 +1,136 @@
+#ifndef _GENERAL_EXECUTOR_H_
+#define _GENERAL_EXECUTOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "Notifier.h"
+
+class Configuration;
+class Task;
+
+// Ce qui execute les taches des couches : l'Executor et son bassin de fils, ou la simulation a evenements discrets (voir EventSimulator)
+class TaskScheduler
+{
+    static std::atomic<TaskScheduler*> s_active;
+
+protected:
+    friend class Task;
+    virtual void registerTask(Task* task) = 0;
+    virtual void unregisterTask(Task* task) = 0;
+    // Appele une seule fois par execution : la tache est dans l'etat Scheduled
+    virtual void submit(Task* task) = 0;
+
+    static void SetActive(TaskScheduler* scheduler);
+
+public:
+    virtual ~TaskScheduler() = default;
+
+    // Ordonnanceur sur lequel les couches creent leurs taches, nullptr si chaque boucle a son propre fil
+    static TaskScheduler* Active();
+};
+
+// Boucle d'une couche executee par petits pas sur un TaskScheduler plutot que dans son propre fil d'execution.
+// La fonction step ne doit jamais bloquer : elle fait avancer le travail disponible et retourne faux lorsqu'il n'y a plus rien a faire.
+// Une tache n'est jamais executee par deux fils a la fois. schedule() peut etre appele de n'importe quel fil, par exemple par
+// un Notifier lorsqu'une file recoit des donnees (voir Notifier::setTask).
+// Lorsqu'un TaskScheduler est actif, les boucles d'envoi et de reception des couches physique, liaison et reseau sont des taches
+// plutot que des fils d'execution : chaque tache est reveillee par le Notifier sur lequel son fil aurait attendu.
+class Task
+{
+    enum State : int
+    {
+        Stopped, // Ne sera pas executee, schedule() est ignore
+        Idle, // En attente d'un schedule()
+        Scheduled, // En attente d'execution dans l'ordonnanceur
+        Running, // En cours d'execution
+        Rescheduled, // En cours d'execution et doit etre executee a nouveau
+    };
+
+    TaskScheduler& m_scheduler;
+    std::function<bool()> m_step;
+    std::atomic<int> m_state;
+    std::atomic<bool> m_stopRequested;
+
+    Task& operator=(const Task&) = delete;
+    Task(const Task&) = delete;
+
+    friend class Executor;
+    friend class EventSimulator;
+    void run();
+    void discard();
+
+public:
+    // Nombre maximal d'appels a step avant de laisser la place aux autres taches
+    static constexpr unsigned int StepBudget = 64;
+
+    Task(TaskScheduler& scheduler, std::function<bool()> step);
+    ~Task();
+
+    // start() programme une premiere execution. Apres stop(), step n'est plus en cours et ne sera plus appele.
+    void start();
+    void stop();
+
+    void schedule();
+};
+
+// Bassin de fils d'execution de taille fixe ou chaque fil a sa propre file de taches.
+// Un fil execute d'abord les taches de sa file dans leur ordre d'arrivee, pour qu'une tache reprogrammee passe apres les autres,
+// puis vole les dernieres arrivees dans la file des autres fils.
+class Executor : public TaskScheduler
+{
+    struct Worker
+    {
+        std::mutex Mutex;
+        std::deque<Task*> Tasks;
+        std::thread Thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<size_t> m_queuedCount; // Nombre de taches dans l'ensemble des files
+    std::atomic<size_t> m_nextWorker; // Pour repartir les taches programmees hors des fils de l'Executor
+    std::atomic<bool> m_running;
+    Notifier m_workNotifier;
+
+    // Toutes les taches sont reprogrammees periodiquement, par securite si une notification n'est jamais envoyee
+    std::mutex m_tasksMutex;
+    std::unordered_set<Task*> m_tasks;
+    std::atomic<int64_t> m_lastSweep;
+
+    static thread_local Executor* s_currentExecutor;
+    static thread_local size_t s_currentWorker;
+
+    static std::mutex s_sharedMutex;
+    static std::unique_ptr<Executor> s_shared;
+
+    Executor& operator=(const Executor&) = delete;
+    Executor(const Executor&) = delete;
+
+    void registerTask(Task* task) override;
+    void unregisterTask(Task* task) override;
+    void submit(Task* task) override;
+    Task* nextTask(size_t workerIndex);
+    void sweep();
+    void work(size_t workerIndex);
+
+public:
+    // threadCount a 0 utilise un fil par coeur
+    Executor(size_t threadCount);
+    ~Executor() override;
+
+    size_t threadCount() const;
+
+    // Executor utilise par les couches. Il est cree avec la configuration par defaut s'il n'a pas ete configure.
+    static Executor& Shared();
+    // Doit etre appele avant la creation des ordinateurs. Si l'Executor est active, il devient le TaskScheduler::Active().
+    static void ConfigureShared(const Configuration& config);
+};
+
+#endif //_GENERAL_EXECUTOR_H_
@@ -0,0 +1,292 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "../Simulation/EventSimulator.h"
+
+namespace
+{
+    constexpr size_t LatencyCount = (size_t)Latency::Count;
+    constexpr size_t HalfSubBucketCount = LatencyHistogram::SubBucketCount / 2;
+
+    const Latencies::Description Descriptions[LatencyCount] = {
+        { "frame_round_trip", "Temps entre l'entree d'une trame de donnees dans la fenetre d'envoi et son ACK, reenvois compris" },
+        { "file_completion", "Temps entre le debut de l'envoi d'un fichier et la reception de son dernier octet" },
+    };
+
+    // Position du bit le plus significatif, value > 0
+    size_t HighestBit(uint64_t value)
+    {
+        size_t bit = 0;
+        for (size_t shift = 32; shift > 0; shift /= 2)
+        {
+            if (value >> shift)
+            {
+                value >>= shift;
+                bit += shift;
+            }
+        }
+        return bit;
+    }
+
+    double ToMilliseconds(std::chrono::nanoseconds time)
+    {
+        return std::chrono::duration<double, std::milli>(time).count();
+    }
+
+    // Histogrammes d'un fil d'execution : ecrits seulement par ce fil, lus par TakeSnapshot depuis un autre.
+    // Alloue a part : assez grand pour ne pas partager ses lignes de cache avec un autre fil.
+    struct Recorder
+    {
+        std::atomic<uint64_t> Counts[LatencyCount][LatencyHistogram::BucketCount];
+        std::atomic<uint64_t> Max[LatencyCount];
+        std::atomic<uint64_t> Sum[LatencyCount];
+
+        Recorder();
+        ~Recorder();
+
+        void copyTo(Latency latency, LatencyHistogram& histogram) const;
+    };
+
+    struct Registry
+    {
+        std::mutex Mutex;
+        std::vector<Recorder*> Recorders; // Histogrammes des fils d'execution vivants
+        LatencyHistogram Retired[LatencyCount]; // Histogrammes des fils d'execution termines
+    };
+
+    // Jamais detruit : des fils d'execution peuvent se terminer pendant la destruction des objets statiques
+    Registry& registry()
+    {
+        static Registry* instance = new Registry();
+        return *instance;
+    }
+
+    Recorder::Recorder()
+    {
+        for (auto& counts : Counts)
+        {
+            for (std::atomic<uint64_t>& count : counts)
+            {
+                count.store(0, std::memory_order_relaxed);
+            }
+        }
+        for (size_t i = 0; i < LatencyCount; ++i)
+        {
+            Max[i].store(0, std::memory_order_relaxed);
+            Sum[i].store(0, std::memory_order_relaxed);
+        }
+        Registry& latencies = registry();
+        std::lock_guard<std::mutex> lock(latencies.Mutex);
+        latencies.Recorders.push_back(this);
+    }
+
+    Recorder::~Recorder()
+    {
+        Registry& latencies = registry();
+        std::lock_guard<std::mutex> lock(latencies.Mutex);
+        for (size_t i = 0; i < LatencyCount; ++i)
+        {
+            copyTo((Latency)i, latencies.Retired[i]);
+        }
+        latencies.Recorders.erase(std::find(latencies.Recorders.begin(), latencies.Recorders.end(), this));
+    }
+
+    void Recorder::copyTo(Latency latency, LatencyHistogram& histogram) const
+    {
+        const std::atomic<uint64_t>* counts = Counts[(size_t)latency];
+        for (size_t index = 0; index < LatencyHistogram::BucketCount; ++index)
+        {
+            uint64_t count = counts[index].load(std::memory_order_relaxed);
+            if (count > 0)
+            {
+                histogram.add(index, count);
+            }
+        }
+        histogram.raiseMax(std::chrono::nanoseconds(Max[(size_t)latency].load(std::memory_order_relaxed)));
+        histogram.addToSum(std::chrono::nanoseconds(Sum[(size_t)latency].load(std::memory_order_relaxed)));
+    }
+
+    // Cree a la premiere mesure : seuls les fils qui mesurent paient la place des histogrammes
+    Recorder& localRecorder()
+    {
+        static thread_local std::unique_ptr<Recorder> recorder = std::make_unique<Recorder>();
+        return *recorder;
+    }
+}
+
+LatencyHistogram::LatencyHistogram()
+    : m_counts(BucketCount, 0)
+    , m_totalCount(0)
+    , m_max(0)
+    , m_sum(0)
+{
+}
+
+size_t LatencyHistogram::IndexOf(uint64_t value)
+{
+    if (value < SubBucketCount)
+    {
+        return (size_t)value;
+    }
+    // La valeur decalee tombe entre SubBucketCount / 2 et SubBucketCount
+    size_t shift = HighestBit(value) - (SubBucketBits - 1);
+    return SubBucketCount + (shift - 1) * HalfSubBucketCount + (size_t)(value >> shift) - HalfSubBucketCount;
+}
+
+uint64_t LatencyHistogram::HighestEquivalentValue(size_t index)
+{
+    if (index < SubBucketCount)
+    {
+        return index;
+    }
+    size_t shift = (index - SubBucketCount) / HalfSubBucketCount + 1;
+    uint64_t lowest = (uint64_t)((index - SubBucketCount) % HalfSubBucketCount + HalfSubBucketCount) << shift;
+    return lowest + ((uint64_t(1) << shift) - 1);
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds value)
+{
+    uint64_t nanoseconds = (uint64_t)std::max<int64_t>(value.count(), 0);
+    add(IndexOf(nanoseconds), 1);
+    raiseMax(value);
+    m_sum += nanoseconds;
+}
+
+void LatencyHistogram::add(size_t index, uint64_t count)
+{
+    m_counts[index] += count;
+    m_totalCount += count;
+}
+
+void LatencyHistogram::raiseMax(std::chrono::nanoseconds value)
+{
+    m_max = std::max(m_max, (uint64_t)std::max<int64_t>(value.count(), 0));
+}
+
+void LatencyHistogram::addToSum(std::chrono::nanoseconds value)
+{
+    m_sum += (uint64_t)std::max<int64_t>(value.count(), 0);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    for (size_t index = 0; index < BucketCount; ++index)
+    {
+        m_counts[index] += other.m_counts[index];
+    }
+    m_totalCount += other.m_totalCount;
+    m_max = std::max(m_max, other.m_max);
+    m_sum += other.m_sum;
+}
+
+void LatencyHistogram::clear()
+{
+    std::fill(m_counts.begin(), m_counts.end(), 0);
+    m_totalCount = 0;
+    m_max = 0;
+    m_sum = 0;
+}
+
+uint64_t LatencyHistogram::count() const
+{
+    return m_totalCount;
+}
+
+std::chrono::nanoseconds LatencyHistogram::max() const
+{
+    return std::chrono::nanoseconds(m_max);
+}
+
+std::chrono::nanoseconds LatencyHistogram::sum() const
+{
+    return std::chrono::nanoseconds(m_sum);
+}
+
+std::chrono::nanoseconds LatencyHistogram::percentile(double percent) const
+{
+    if (m_totalCount == 0)
+    {
+        return std::chrono::nanoseconds(0);
+    }
+    // Rang le plus proche, comme GoodputBenchmark
+    uint64_t rank = std::max<uint64_t>((uint64_t)(percent / 100.0 * m_totalCount + 0.999999), 1);
+    uint64_t seen = 0;
+    for (size_t index = 0; index < BucketCount; ++index)
+    {
+        seen += m_counts[index];
+        if (seen >= rank)
+        {
+            return std::chrono::nanoseconds(std::min(HighestEquivalentValue(index), m_max));
+        }
+    }
+    return max();
+}
+
+std::ostream& operator<<(std::ostream& out, const LatencyHistogram& histogram)
+{
+    out << "Nombre : " << histogram.count();
+    if (histogram.count() > 0)
+    {
+        out << ", p50 : " << ToMilliseconds(histogram.percentile(50.0)) << " ms"
+            << ", p99 : " << ToMilliseconds(histogram.percentile(99.0)) << " ms"
+            << ", p999 : " << ToMilliseconds(histogram.percentile(99.9)) << " ms"
+            << ", max : " << ToMilliseconds(histogram.max()) << " ms";
+    }
+    return out;
+}
+
+const Latencies::Description& Latencies::Describe(Latency latency)
+{
+    return Descriptions[(size_t)latency];
+}
+
+void Latencies::Record(Latency latency, std::chrono::nanoseconds value)
+{
+    // Un seul fil ecrit la case : pas besoin d'une operation atomique de lecture-modification-ecriture
+    uint64_t nanoseconds = (uint64_t)std::max<int64_t>(value.count(), 0);
+    Recorder& recorder = localRecorder();
+    std::atomic<uint64_t>& count = recorder.Counts[(size_t)latency][LatencyHistogram::IndexOf(nanoseconds)];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic<uint64_t>& max = recorder.Max[(size_t)latency];
+    if (nanoseconds > max.load(std::memory_order_relaxed))
+    {
+        max.store(nanoseconds, std::memory_order_relaxed);
+    }
+    std::atomic<uint64_t>& sum = recorder.Sum[(size_t)latency];
+    sum.store(sum.load(std::memory_order_relaxed) + nanoseconds, std::memory_order_relaxed);
+}
+
+LatencyHistogram Latencies::TakeSnapshot(Latency latency)
+{
+    Registry& latencies = registry();
+    std::lock_guard<std::mutex> lock(latencies.Mutex);
+    LatencyHistogram snapshot = latencies.Retired[(size_t)latency];
+    for (const Recorder* recorder : latencies.Recorders)
+    {
+        recorder->copyTo(latency, snapshot);
+    }
+    return snapshot;
+}
+
+std::chrono::nanoseconds Latencies::Now()
+{
+    // Appele pour chaque mesure : la simulation est lue sans verrou
+    EventSimulator* simulator = EventSimulator::SharedIfEnabled();
+    if (simulator)
+    {
+        return simulator->now();
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+}
+
+void Latencies::WriteSummary(std::ostream& out)
+{
+    for (size_t i = 0; i < LatencyCount; ++i)
+    {
+        out << "Latences " << Descriptions[i].Name << " : " << TakeSnapshot((Latency)i) << std::endl;
+    }
+}
\ No newline at end of file
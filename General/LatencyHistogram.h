@@ -0,0 +1,86 @@
+#ifndef _GENERAL_LATENCY_HISTOGRAM_H_
+#define _GENERAL_LATENCY_HISTOGRAM_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Durees mesurees par la simulation, additionnees pour tous les ordinateurs
+enum class Latency : uint8_t
+{
+    FrameRoundTrip, // Couche liaison : entree d'une trame de donnees dans la fenetre d'envoi jusqu'a son ACK, reenvois compris
+    FileCompletion, // Couche reseau : debut de l'envoi d'un fichier jusqu'a la reception de son dernier octet
+
+    Count
+};
+
+// Histogramme a grande plage dynamique (HDR) de durees en nanosecondes.
+// Les valeurs sous SubBucketCount sont exactes ; au-dela, chaque puissance de deux est divisee en SubBucketCount / 2 cases,
+// soit une erreur relative d'au plus 2 / SubBucketCount (1,6 %) pour toutes les valeurs jusqu'a 2^64 ns.
+class LatencyHistogram
+{
+public:
+    static constexpr size_t SubBucketBits = 7;
+    static constexpr size_t SubBucketCount = size_t(1) << SubBucketBits;
+    static constexpr size_t BucketCount = SubBucketCount + (64 - SubBucketBits) * (SubBucketCount / 2);
+
+private:
+    std::vector<uint64_t> m_counts;
+    uint64_t m_totalCount;
+    uint64_t m_max;
+    uint64_t m_sum;
+
+public:
+    LatencyHistogram();
+
+    void record(std::chrono::nanoseconds value);
+    // Ajoute count valeurs dans la case index, sans changer le maximum ni la somme (voir raiseMax et addToSum)
+    void add(size_t index, uint64_t count);
+    void raiseMax(std::chrono::nanoseconds value);
+    void addToSum(std::chrono::nanoseconds value);
+    void merge(const LatencyHistogram& other);
+    void clear();
+
+    uint64_t count() const;
+    std::chrono::nanoseconds max() const;
+    std::chrono::nanoseconds sum() const;
+    // Plus grande valeur equivalente de la case qui contient le rang percent (0 a 100), au plus max()
+    std::chrono::nanoseconds percentile(double percent) const;
+
+    static size_t IndexOf(uint64_t value);
+    // Plus grande valeur qui tombe dans la case index
+    static uint64_t HighestEquivalentValue(size_t index);
+};
+
+// Ex. : "Nombre : 812, p50 : 3.2 ms, p99 : 41.5 ms, p999 : 80.1 ms, max : 80.3 ms"
+std::ostream& operator<<(std::ostream& out, const LatencyHistogram& histogram);
+
+
+// Registre des histogrammes de la simulation.
+// Comme pour Metrics, chaque fil d'execution enregistre dans ses propres histogrammes, sans verrou ;
+// un snapshot les additionne sous verrou. Les histogrammes des fils termines restent dans les totaux.
+class Latencies
+{
+public:
+    struct Description
+    {
+        const char* Name; // Nom de la serie, sans prefixe ni unite
+        const char* Help;
+    };
+
+    static const Description& Describe(Latency latency);
+
+    static void Record(Latency latency, std::chrono::nanoseconds value);
+
+    static LatencyHistogram TakeSnapshot(Latency latency);
+
+    // Horloge des mesures : temps virtuel avec l'EventSimulator, temps reel sinon
+    static std::chrono::nanoseconds Now();
+
+    // Une ligne par histogramme, pour l'arret du simulateur
+    static void WriteSummary(std::ostream& out);
+};
+
+#endif //_GENERAL_LATENCY_HISTOGRAM_H_
@@ -0,0 +1,157 @@
+#include "Log.h"
+
+#include <chrono>
+
+constexpr uint32_t LogSite::UnregisteredID;
+
+std::mutex Log::s_formatsMutex;
+std::vector<Log::FormatDefinition> Log::s_formats;
+std::atomic<bool> Log::s_binaryTrace(false);
+std::atomic<int64_t> Log::s_traceStart(0);
+std::atomic<int> Log::s_minimumLevel(0);
+
+LogSite::LogSite(LogLevel level, LogCategory category, const char* file, uint32_t line)
+    : m_id(UnregisteredID)
+    , m_level(level)
+    , m_category(category)
+    , m_file(file)
+    , m_line(line)
+{
+}
+
+uint32_t LogSite::registerFormat(const char* format, const char* argumentCodes)
+{
+    return Log::RegisterFormat(*this, format, argumentCodes);
+}
+
+uint32_t Log::RegisterFormat(LogSite& site, const char* format, const char* argumentCodes)
+{
+    std::lock_guard<std::mutex> lock(s_formatsMutex);
+    // Un autre fil a pu enregistrer le site pendant l'attente du verrou
+    uint32_t id = site.m_id.load(std::memory_order_relaxed);
+    if (id == LogSite::UnregisteredID)
+    {
+        s_formats.push_back(FormatDefinition{ &site, format, argumentCodes });
+        id = static_cast<uint32_t>(s_formats.size());
+        if (BinaryTrace())
+        {
+            writeDefinition(id, s_formats.back());
+        }
+        site.m_id.store(id, std::memory_order_release);
+    }
+    return id;
+}
+
+void Log::writeDefinition(uint32_t id, const FormatDefinition& definition)
+{
+    std::string record;
+    record.push_back(static_cast<char>(TraceFormat::DefinitionRecord));
+    AppendLogValue(record, id);
+    AppendLogValue(record, static_cast<uint8_t>(definition.Site->level()));
+    AppendLogValue(record, static_cast<uint8_t>(definition.Site->category()));
+    AppendLogValue(record, definition.Site->line());
+    size_t fileSize = std::strlen(definition.Site->file());
+    AppendLogValue(record, static_cast<uint16_t>(fileSize));
+    record.append(definition.Site->file(), fileSize);
+    AppendLogValue(record, static_cast<uint16_t>(definition.Format.size()));
+    record.append(definition.Format);
+    AppendLogValue(record, static_cast<uint8_t>(definition.ArgumentCodes.size()));
+    record.append(definition.ArgumentCodes);
+    LogWriter::Instance().write(record.data(), record.size());
+}
+
+void Log::SetMinimumLevel(LogLevel level)
+{
+    s_minimumLevel = static_cast<int>(level);
+}
+
+bool Log::EnableBinaryTrace(const std::string& fileName)
+{
+    std::lock_guard<std::mutex> lock(s_formatsMutex);
+    if (!LogWriter::Instance().setOutputFile(fileName, false))
+    {
+        return false;
+    }
+    s_traceStart = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    std::string header(TraceFormat::Magic(), TraceFormat::MagicSize);
+    AppendLogValue(header, TraceFormat::Version);
+    LogWriter::Instance().write(header.data(), header.size());
+    // Les formats deja utilises en mode texte ne seront plus definis par leur site
+    for (size_t i = 0; i < s_formats.size(); ++i)
+    {
+        writeDefinition(static_cast<uint32_t>(i + 1), s_formats[i]);
+    }
+    s_binaryTrace = true;
+    return true;
+}
+
+std::string& Log::threadRecord()
+{
+    static thread_local std::string record;
+    return record;
+}
+
+uint64_t Log::elapsedNanoseconds()
+{
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    return static_cast<uint64_t>(now - s_traceStart.load(std::memory_order_relaxed));
+}
+
+void Log::printFormat(std::ostream& out, const char*& format)
+{
+    // Ecrit le texte jusqu'au prochain {} et s'y arrete
+    const char* next = std::strstr(format, "{}");
+    if (next == nullptr)
+    {
+        next = format + std::strlen(format);
+    }
+    out.write(format, next - format);
+    format = next;
+}
+
+void Log::beginEvent(std::string& record, uint32_t id)
+{
+    record.clear();
+    record.push_back(static_cast<char>(TraceFormat::EventRecord));
+    AppendLogValue(record, id);
+    AppendLogValue(record, elapsedNanoseconds());
+    AppendLogValue(record, uint32_t(0)); // Taille des arguments, voir endEvent
+}
+
+void Log::endEvent(std::string& record)
+{
+    uint32_t argumentsSize = static_cast<uint32_t>(record.size() - TraceFormat::EventHeaderSize);
+    std::memcpy(&record[TraceFormat::EventHeaderSize - sizeof(argumentsSize)], &argumentsSize, sizeof(argumentsSize));
+}
+
+void Log::beginText(const LogSite& site, std::ostringstream& message)
+{
+    message << '[' << LogCategoryName(site.category()) << "] ";
+}
+
+void Log::endText(std::ostringstream& message)
+{
+    message << '\n';
+    const std::string text = message.str();
+    LogWriter::Instance().write(text.data(), text.size());
+}
+
+void Log::WriteMessage(const std::string& message)
+{
+    if (BinaryTrace())
+    {
+        // Le message devient un evenement avec un seul argument, sans le saut de ligne final que le decodeur ajoute
+        static LogSite site(LogLevel::Info, LogCategory::General, __FILE__, __LINE__);
+        size_t size = message.size();
+        while (size > 0 && message[size - 1] == '\n')
+        {
+            --size;
+        }
+        Write(site, "{}", message.substr(0, size));
+    }
+    else
+    {
+        LogWriter::Instance().write(message.data(), message.size());
+    }
+}
\ No newline at end of file
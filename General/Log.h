@@ -0,0 +1,268 @@
+#ifndef _GENERAL_LOG_H_
+#define _GENERAL_LOG_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "LogTypes.h"
+#include "LogWriter.h"
+#include "../DataStructures/MACAddress.h"
+
+// Niveau minimal des journaux conserves a la compilation (voir LogLevel).
+// Les instructions LOG_* d'un niveau inferieur sont eliminees : ni leurs arguments ni leur formatage ne sont evalues.
+#ifndef LOG_MINIMUM_LEVEL
+#define LOG_MINIMUM_LEVEL 0
+#endif
+
+// Journalisation avec un format contenant des {} remplaces par les arguments, dans l'ordre :
+//     LOG_TRACE(LogCategory::Link, "Sending DATA to {} : {}", frame.Destination, frame.NumberSequence);
+// En mode texte, le message est formate puis ecrit par le LogWriter.
+// En mode trace binaire (voir Log::EnableBinaryTrace), seuls l'identifiant du format et les valeurs brutes des arguments sont ecrits.
+// Les journaux compiles peuvent encore etre ignores a l'execution (voir Log::SetMinimumLevel), sans evaluer leurs arguments.
+#define LOG_AT(level, category, ...) \
+    do \
+    { \
+        if (Log::IsCompiled(level) && Log::IsEnabled(level)) \
+        { \
+            static LogSite logSite(level, category, __FILE__, __LINE__); \
+            Log::Write(logSite, __VA_ARGS__); \
+        } \
+    } while (false)
+
+#define LOG_TRACE(category, ...) LOG_AT(LogLevel::Trace, category, __VA_ARGS__)
+#define LOG_DEBUG(category, ...) LOG_AT(LogLevel::Debug, category, __VA_ARGS__)
+#define LOG_INFO(category, ...) LOG_AT(LogLevel::Info, category, __VA_ARGS__)
+#define LOG_WARNING(category, ...) LOG_AT(LogLevel::Warning, category, __VA_ARGS__)
+#define LOG_ERROR(category, ...) LOG_AT(LogLevel::Error, category, __VA_ARGS__)
+
+// Ajoute la representation memoire de la valeur a la fin de l'enregistrement
+template<typename T>
+inline void AppendLogValue(std::string& out, T value)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Conversion d'un argument vers sa representation dans les traces binaires.
+// Les entiers sont elargis a 64 bits, les adresses MAC sont ecrites comme un entier de 48 bits.
+template<typename T, typename Enable = void>
+struct LogArgument;
+
+template<typename T>
+struct LogArgument<T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type>
+{
+    static constexpr char Code = TraceFormat::SignedArgument;
+    static void encode(std::string& out, T value) { AppendLogValue(out, static_cast<int64_t>(value)); }
+    static void print(std::ostream& out, T value) { out << static_cast<int64_t>(value); }
+};
+
+template<typename T>
+struct LogArgument<T, typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type>
+{
+    static constexpr char Code = TraceFormat::UnsignedArgument;
+    static void encode(std::string& out, T value) { AppendLogValue(out, static_cast<uint64_t>(value)); }
+    static void print(std::ostream& out, T value) { out << static_cast<uint64_t>(value); }
+};
+
+template<typename T>
+struct LogArgument<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+    static constexpr char Code = TraceFormat::FloatArgument;
+    static void encode(std::string& out, T value) { AppendLogValue(out, static_cast<double>(value)); }
+    static void print(std::ostream& out, T value) { out << value; }
+};
+
+template<>
+struct LogArgument<MACAddress>
+{
+    static constexpr char Code = TraceFormat::MACAddressArgument;
+    static void encode(std::string& out, const MACAddress& value) { AppendLogValue(out, value.value()); }
+    static void print(std::ostream& out, const MACAddress& value) { out << value; }
+};
+
+template<>
+struct LogArgument<const char*>
+{
+    static constexpr char Code = TraceFormat::StringArgument;
+    static void encode(std::string& out, const char* value) { encode(out, value, std::strlen(value)); }
+    static void encode(std::string& out, const char* value, size_t size)
+    {
+        AppendLogValue(out, static_cast<uint32_t>(size));
+        out.append(value, size);
+    }
+    static void print(std::ostream& out, const char* value) { out << value; }
+};
+
+template<>
+struct LogArgument<char*> : LogArgument<const char*> {};
+
+template<>
+struct LogArgument<std::string>
+{
+    static constexpr char Code = TraceFormat::StringArgument;
+    static void encode(std::string& out, const std::string& value) { LogArgument<const char*>::encode(out, value.data(), value.size()); }
+    static void print(std::ostream& out, const std::string& value) { out << value; }
+};
+
+// Les tableaux de caracteres (litteraux) sont traites comme des const char*
+template<typename T>
+using LogArgumentOf = LogArgument<typename std::decay<T>::type>;
+
+// Codes des arguments d'un format, termines par un zero
+template<typename... Args>
+struct LogArgumentCodes
+{
+    static constexpr char Codes[sizeof...(Args) + 1] = { LogArgumentOf<Args>::Code..., '\0' };
+};
+
+template<typename... Args>
+constexpr char LogArgumentCodes<Args...>::Codes[sizeof...(Args) + 1];
+
+// Emplacement d'une instruction de journalisation. L'identifiant du format est attribue a la premiere execution.
+class LogSite
+{
+    friend class Log;
+
+    std::atomic<uint32_t> m_id;
+    LogLevel m_level;
+    LogCategory m_category;
+    const char* m_file;
+    uint32_t m_line;
+
+public:
+    static constexpr uint32_t UnregisteredID = 0;
+
+    LogSite(LogLevel level, LogCategory category, const char* file, uint32_t line);
+
+    uint32_t id(const char* format, const char* argumentCodes)
+    {
+        uint32_t id = m_id.load(std::memory_order_acquire);
+        return id != UnregisteredID ? id : registerFormat(format, argumentCodes);
+    }
+
+    // Voir Log::RegisterFormat
+    uint32_t registerFormat(const char* format, const char* argumentCodes);
+
+    LogLevel level() const { return m_level; }
+    LogCategory category() const { return m_category; }
+    const char* file() const { return m_file; }
+    uint32_t line() const { return m_line; }
+};
+
+class Log
+{
+    struct FormatDefinition
+    {
+        const LogSite* Site;
+        std::string Format;
+        std::string ArgumentCodes;
+    };
+
+    static std::mutex s_formatsMutex;
+    static std::vector<FormatDefinition> s_formats; // Indice : identifiant - 1
+    static std::atomic<bool> s_binaryTrace;
+    static std::atomic<int> s_minimumLevel;
+    static std::atomic<int64_t> s_traceStart; // Debut de la trace, en nanosecondes de steady_clock
+
+    static void writeDefinition(uint32_t id, const FormatDefinition& definition);
+
+    // Buffer de composition du fil courant, reutilise d'un message a l'autre
+    static std::string& threadRecord();
+
+    static uint64_t elapsedNanoseconds();
+
+    static void printFormat(std::ostream& out, const char*& format);
+
+    static void print(std::ostream& out, const char* format)
+    {
+        printFormat(out, format);
+        out << format;
+    }
+
+    template<typename T, typename... Rest>
+    static void print(std::ostream& out, const char* format, const T& value, const Rest&... rest)
+    {
+        printFormat(out, format);
+        LogArgumentOf<T>::print(out, value);
+        if (*format != '\0')
+        {
+            format += 2; // {}
+        }
+        print(out, format, rest...);
+    }
+
+    static void encode(std::string&) {}
+
+    template<typename T, typename... Rest>
+    static void encode(std::string& out, const T& value, const Rest&... rest)
+    {
+        LogArgumentOf<T>::encode(out, value);
+        encode(out, rest...);
+    }
+
+    static void beginEvent(std::string& record, uint32_t id);
+    static void endEvent(std::string& record);
+    static void beginText(const LogSite& site, std::ostringstream& message);
+    static void endText(std::ostringstream& message);
+
+public:
+    static constexpr bool IsCompiled(LogLevel level)
+    {
+        // Comparaison entre LogLevel : un entier compare a 0 ferait avertir -Wtype-limits dans chaque fichier qui inclut Log.h
+        return level >= static_cast<LogLevel>(LOG_MINIMUM_LEVEL);
+    }
+
+    static bool IsEnabled(LogLevel level)
+    {
+        return static_cast<int>(level) >= s_minimumLevel.load(std::memory_order_relaxed);
+    }
+
+    // Niveau minimal des journaux ecrits a l'execution. Par defaut, tous les journaux compiles sont ecrits.
+    static void SetMinimumLevel(LogLevel level);
+
+    static bool BinaryTrace()
+    {
+        return s_binaryTrace.load(std::memory_order_relaxed);
+    }
+
+    // Les journaux suivants sont ecrits dans le fichier en format binaire, a decoder avec TraceDecoder.
+    // A appeler au demarrage, avant que les couches ne commencent a journaliser.
+    // Retourne faux si le fichier ne peut pas etre cree ; les journaux restent alors en texte.
+    static bool EnableBinaryTrace(const std::string& fileName);
+
+    // Attribue un identifiant au format du site s'il n'en a pas encore et, en mode trace binaire, ecrit sa definition
+    static uint32_t RegisterFormat(LogSite& site, const char* format, const char* argumentCodes);
+
+    template<typename... Args>
+    static void Write(LogSite& site, const char* format, const Args&... args)
+    {
+        uint32_t id = site.id(format, LogArgumentCodes<Args...>::Codes);
+        if (BinaryTrace())
+        {
+            std::string& record = threadRecord();
+            beginEvent(record, id);
+            encode(record, args...);
+            endEvent(record);
+            LogWriter::Instance().write(record.data(), record.size());
+        }
+        else
+        {
+            std::ostringstream& message = LogWriter::AcquireStream();
+            beginText(site, message);
+            print(message, format, args...);
+            endText(message);
+            LogWriter::ReleaseStream();
+        }
+    }
+
+    // Message deja formate (voir Logger)
+    static void WriteMessage(const std::string& message);
+};
+
+#endif //_GENERAL_LOG_H_
@@ -0,0 +1,69 @@
+#ifndef _GENERAL_LOG_TYPES_H_
+#define _GENERAL_LOG_TYPES_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Niveaux et categories des journaux, partages par le simulateur et le decodeur de traces
+
+enum class LogLevel : uint8_t
+{
+    Trace = 0, // Evenements au niveau des trames
+    Debug = 1,
+    Info = 2,
+    Warning = 3,
+    Error = 4
+};
+
+enum class LogCategory : uint8_t
+{
+    General = 0,
+    Phy = 1,
+    Link = 2,
+    Net = 3,
+    Hub = 4
+};
+
+inline const char* LogLevelName(LogLevel level)
+{
+    static const char* const names[] = { "TRACE", "DEBUG", "INFO", "WARNING", "ERROR" };
+    size_t index = static_cast<size_t>(level);
+    return index < sizeof(names) / sizeof(names[0]) ? names[index] : "?";
+}
+
+inline const char* LogCategoryName(LogCategory category)
+{
+    static const char* const names[] = { "GENERAL", "PHY", "LINK", "NET", "HUB" };
+    size_t index = static_cast<size_t>(category);
+    return index < sizeof(names) / sizeof(names[0]) ? names[index] : "?";
+}
+
+// Format des traces binaires. Les valeurs sont ecrites dans l'ordre des octets de la machine.
+//
+// Entete du fichier : Magic (8 octets), Version (uint32)
+// Definition d'un format : 'D', id (uint32), niveau (uint8), categorie (uint8), ligne (uint32),
+//                          taille du fichier (uint16), fichier, taille du format (uint16), format,
+//                          nombre d'arguments (uint8), codes des arguments (1 octet chacun)
+// Evenement : 'E', id (uint32), temps depuis le debut de la trace en nanosecondes (uint64), taille des arguments (uint32), arguments
+//
+// Une definition est toujours ecrite avant les evenements du meme fil qui l'utilisent,
+// mais peut apparaitre apres ceux d'un autre fil : le decodeur lit d'abord toutes les definitions.
+struct TraceFormat
+{
+    static const char* Magic() { return "SIMTRACE"; }
+    static constexpr size_t MagicSize = 8;
+    static constexpr uint32_t Version = 1;
+
+    static constexpr uint8_t DefinitionRecord = 'D';
+    static constexpr uint8_t EventRecord = 'E';
+    static constexpr size_t EventHeaderSize = 1 + sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t);
+
+    // Codes des arguments
+    static constexpr char SignedArgument = 'i'; // int64_t
+    static constexpr char UnsignedArgument = 'u'; // uint64_t
+    static constexpr char FloatArgument = 'f'; // double
+    static constexpr char MACAddressArgument = 'm'; // uint64_t, voir MACAddress::value()
+    static constexpr char StringArgument = 's'; // Taille (uint32) suivie des caracteres
+};
+
+#endif //_GENERAL_LOG_TYPES_H_
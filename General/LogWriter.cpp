@@ -0,0 +1,209 @@
+#include "LogWriter.h"
+
+#include <algorithm>
+#include <iostream>
+
+constexpr std::chrono::milliseconds LogWriter::WriteInterval;
+
+LogWriter::ThreadBufferOwner::~ThreadBufferOwner()
+{
+    if (Buffer)
+    {
+        Buffer->Abandoned = true;
+    }
+}
+
+LogWriter::LogWriter()
+    : m_threadBufferSize(Configuration::LOG_THREAD_BUFFER_SIZE_DEFAULT_VALUE)
+    , m_output(&std::cout)
+    , m_running(true)
+    , m_writing(false)
+    , m_wakeUpRequested(false)
+{
+    m_writerThread = std::thread(&LogWriter::writerLoop, this);
+}
+
+LogWriter::~LogWriter()
+{
+    m_running = false;
+    wakeUp();
+    if (m_writerThread.joinable())
+    {
+        m_writerThread.join();
+    }
+}
+
+LogWriter& LogWriter::Instance()
+{
+    static LogWriter instance;
+    return instance;
+}
+
+LogWriter::ThreadBuffer& LogWriter::threadBuffer()
+{
+    static thread_local ThreadBufferOwner owner;
+    if (!owner.Buffer)
+    {
+        owner.Buffer = std::make_shared<ThreadBuffer>(m_threadBufferSize.load(std::memory_order_relaxed));
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        m_buffers.push_back(owner.Buffer);
+    }
+    return *owner.Buffer;
+}
+
+void LogWriter::setThreadBufferSize(size_t size)
+{
+    m_threadBufferSize.store(std::max<size_t>(size, 1), std::memory_order_relaxed);
+}
+
+void LogWriter::wakeUp()
+{
+    m_wakeUpRequested = true;
+    m_wakeUpNotifier.notify();
+}
+
+void LogWriter::write(const char* data, size_t size)
+{
+    ThreadBuffer& buffer = threadBuffer();
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    while (size > 0)
+    {
+        // Un message plus grand que le buffer est ajoute en plusieurs morceaux
+        size_t chunkSize = std::min(size, buffer.Queue.capacity());
+        if (!buffer.Queue.enoughSpaceFor(chunkSize))
+        {
+            // Buffer plein : on reveille le fil d'ecriture et on attend qu'il le vide
+            wakeUp();
+            while (!buffer.Queue.enoughSpaceFor(chunkSize))
+            {
+                buffer.Queue.spaceNotifier().wait([&buffer, chunkSize]() { return buffer.Queue.enoughSpaceFor(chunkSize); });
+            }
+        }
+        buffer.Queue.write(bytes, chunkSize);
+        bytes += chunkSize;
+        size -= chunkSize;
+    }
+
+    // Le fil d'ecriture se reveille de lui-meme a intervalle regulier, sauf si le buffer commence a se remplir
+    if (buffer.Queue.size() > buffer.Queue.capacity() / 2)
+    {
+        wakeUp();
+    }
+}
+
+bool LogWriter::buffersEmpty()
+{
+    std::lock_guard<std::mutex> lock(m_buffersMutex);
+    for (const std::shared_ptr<ThreadBuffer>& buffer : m_buffers)
+    {
+        if (buffer->Queue.size() > 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void LogWriter::flush()
+{
+    wakeUp();
+    // Les buffers sont verifies avant m_writing : un buffer vide alors qu'une ecriture est en cours sera vu comme non termine
+    while (!m_idleNotifier.wait([this]() { return buffersEmpty() && !m_writing; }))
+    {
+        wakeUp();
+    }
+}
+
+bool LogWriter::setOutputFile(const std::string& fileName, bool append)
+{
+    flush();
+    std::lock_guard<std::mutex> lock(m_outputMutex);
+    std::ofstream file(fileName, std::ios::out | std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+    if (!file.is_open())
+    {
+        return false;
+    }
+    m_outputFile = std::move(file);
+    m_output = &m_outputFile;
+    return true;
+}
+
+void LogWriter::drain()
+{
+    m_writing = true;
+    {
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        // Les buffers des fils termines sont retires une fois vides
+        m_buffers.erase(std::remove_if(m_buffers.begin(), m_buffers.end(), [](const std::shared_ptr<ThreadBuffer>& buffer)
+        {
+            return buffer->Abandoned && buffer->Queue.size() == 0;
+        }), m_buffers.end());
+        m_drainedBuffers = m_buffers;
+    }
+
+    // Tout le contenu disponible est regroupe pour ne faire qu'une ecriture et un vidage de la sortie
+    m_batch.clear();
+    for (const std::shared_ptr<ThreadBuffer>& buffer : m_drainedBuffers)
+    {
+        size_t available = buffer->Queue.size();
+        if (available > 0)
+        {
+            CircularQueue::ReadRegion region = buffer->Queue.peek(available);
+            m_batch.append(reinterpret_cast<const char*>(region.First), region.FirstSize);
+            m_batch.append(reinterpret_cast<const char*>(region.Second), region.SecondSize);
+            buffer->Queue.consume(available);
+        }
+    }
+    m_drainedBuffers.clear();
+
+    if (m_batch.size() > 0)
+    {
+        std::lock_guard<std::mutex> lock(m_outputMutex);
+        m_output->write(m_batch.data(), m_batch.size());
+        m_output->flush();
+    }
+    m_writing = false;
+    m_idleNotifier.notify();
+}
+
+void LogWriter::writerLoop()
+{
+    while (m_running)
+    {
+        m_wakeUpNotifier.wait([this]() { return m_wakeUpRequested.load(); }, WriteInterval);
+        m_wakeUpRequested = false;
+        drain();
+    }
+    // Derniers messages avant l'arret
+    drain();
+}
+
+LogWriter::StreamStack& LogWriter::threadStreams()
+{
+    static thread_local StreamStack stack;
+    return stack;
+}
+
+std::ostringstream& LogWriter::AcquireStream()
+{
+    // Les Logger peuvent etre imbriques, chaque niveau a son propre flux
+    StreamStack& stack = threadStreams();
+    if (stack.Depth == stack.Streams.size())
+    {
+        stack.Streams.push_back(std::make_unique<std::ostringstream>());
+    }
+    return *stack.Streams[stack.Depth++];
+}
+
+void LogWriter::ReleaseStream()
+{
+    StreamStack& stack = threadStreams();
+    std::ostringstream& stream = *stack.Streams[--stack.Depth];
+    // Le contenu et le formatage sont remis a zero, la memoire est conservee pour le prochain message
+    stream.str(std::string());
+    stream.clear();
+    stream.flags(std::ios_base::dec | std::ios_base::skipws);
+    stream.precision(6);
+    stream.width(0);
+    stream.fill(' ');
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#ifndef _GENERAL_LOG_WRITER_H_
+#define _GENERAL_LOG_WRITER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Configuration.h"
+#include "Metrics.h"
+#include "Notifier.h"
+#include "../DataStructures/CircularQueue.h"
+
+// Ecriture asynchrone des journaux.
+// Chaque fil d'execution ecrit ses messages dans son propre buffer circulaire (1 producteur, 1 consommateur, sans verrou).
+// Un seul fil d'ecriture vide regulierement tous les buffers et ecrit leur contenu en un bloc sur la sortie, puis la vide une seule fois.
+// Les messages d'un meme fil restent dans l'ordre. Un message n'est jamais coupe par celui d'un autre fil, sauf s'il depasse la taille d'un buffer.
+class LogWriter
+{
+    struct ThreadBuffer
+    {
+        CircularQueue Queue;
+        std::atomic<bool> Abandoned; // Le fil proprietaire est termine, le buffer sera retire une fois vide
+        QueueWatch Watch; // Les buffers de tous les fils forment une seule serie dans les metriques
+
+        ThreadBuffer(size_t capacity) : Queue(capacity), Abandoned(false), Watch("log", "", Queue) {}
+    };
+
+    // Buffer du fil courant, enregistre aupres du LogWriter a la premiere utilisation
+    struct ThreadBufferOwner
+    {
+        std::shared_ptr<ThreadBuffer> Buffer;
+        ~ThreadBufferOwner();
+    };
+
+    std::mutex m_buffersMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+    std::atomic<size_t> m_threadBufferSize; // Taille des buffers crees ensuite
+
+    std::mutex m_outputMutex; // Protege la sortie pendant qu'elle est changee ou ecrite
+    std::ostream* m_output;
+    std::ofstream m_outputFile;
+
+    std::string m_batch; // Utilise seulement par le fil d'ecriture
+    std::vector<std::shared_ptr<ThreadBuffer>> m_drainedBuffers; // Utilise seulement par le fil d'ecriture
+
+    std::atomic<bool> m_running;
+    std::atomic<bool> m_writing; // Vrai pendant que le fil d'ecriture vide les buffers et ecrit sur la sortie
+    std::atomic<bool> m_wakeUpRequested;
+    Notifier m_wakeUpNotifier; // Reveille le fil d'ecriture avant la fin de son intervalle
+    Notifier m_idleNotifier; // Notifie apres chaque ecriture, pour flush()
+    std::thread m_writerThread;
+
+    LogWriter& operator=(const LogWriter&) = delete;
+    LogWriter(const LogWriter&) = delete;
+
+    LogWriter();
+
+    // Pile des flux de formatage du fil courant, Depth est le nombre de flux en cours d'utilisation
+    struct StreamStack
+    {
+        std::vector<std::unique_ptr<std::ostringstream>> Streams;
+        size_t Depth = 0;
+    };
+    static StreamStack& threadStreams();
+
+    ThreadBuffer& threadBuffer();
+    void wakeUp();
+    bool buffersEmpty();
+    void drain();
+    void writerLoop();
+
+public:
+    // Delai maximal entre l'ajout d'un message et son ecriture
+    static constexpr std::chrono::milliseconds WriteInterval = std::chrono::milliseconds(10);
+
+    ~LogWriter();
+
+    static LogWriter& Instance();
+
+    // Taille du buffer des fils qui n'ont pas encore journalise, Configuration::LOG_THREAD_BUFFER_SIZE par defaut.
+    // Les buffers deja crees gardent leur taille.
+    void setThreadBufferSize(size_t size);
+
+    // Ajoute le message au buffer du fil courant. N'attend que si ce buffer est plein.
+    void write(const char* data, size_t size);
+
+    // Attend que tous les messages ajoutes avant l'appel soient ecrits sur la sortie
+    void flush();
+
+    // Les messages suivants sont ecrits dans le fichier plutot que sur la sortie standard, a la fin du fichier ou a la place de son contenu.
+    // Retourne faux si le fichier ne peut pas etre ouvert ; la sortie reste alors inchangee.
+    bool setOutputFile(const std::string& fileName, bool append = true);
+
+    // Flux de formatage reutilisables du fil courant, pour eviter de construire un stringstream par message.
+    // Chaque AcquireStream doit etre suivi d'un ReleaseStream, dans l'ordre inverse.
+    static std::ostringstream& AcquireStream();
+    static void ReleaseStream();
+};
+
+#endif //_GENERAL_LOG_WRITER_H_
@@ -1,20 +1,36 @@
 #ifndef _GENERAL_LOGGER_H_
 #define _GENERAL_LOGGER_H_
 
+#include <iostream>
 #include <ostream>
 #include <sstream>
+#include <string>
 
+#include "Log.h"
+#include "LogWriter.h"
+
+// Les messages destines a std::cout passent par le LogWriter asynchrone (voir Log::WriteMessage), les autres flux sont ecrits directement.
+// Pour les nouveaux messages, preferer les macros LOG_* de Log.h qui ont un niveau et une categorie.
 class Logger
 {
-    std::stringstream ss;
+    std::ostringstream& ss;
     std::ostream& stream;
 
 public:
-    Logger(std::ostream& out) : stream(out) {}
+    Logger(std::ostream& out) : ss(LogWriter::AcquireStream()), stream(out) {}
     ~Logger()
     {
-        stream << ss.str();
-        stream.flush();
+        const std::string message = ss.str();
+        if (&stream == &std::cout)
+        {
+            Log::WriteMessage(message);
+        }
+        else
+        {
+            stream << message;
+            stream.flush();
+        }
+        LogWriter::ReleaseStream();
     }
 
     template<typename T>
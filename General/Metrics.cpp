@@ -0,0 +1,174 @@
+#include "Metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <utility>
+
+#include "../DataStructures/Utils.h"
+
+namespace
+{
+    constexpr size_t MetricCount = (size_t)Metric::Count;
+
+    const Metrics::Description Descriptions[MetricCount] = {
+        { "frames_sent_total", "physical", "Trames envoyees (paquets pour la couche reseau)" },
+        { "bytes_sent_total", "physical", "Octets envoyes, entetes compris" },
+        { "frames_received_total", "physical", "Trames recues (paquets pour la couche reseau)" },
+        { "bytes_received_total", "physical", "Octets recus, entetes compris" },
+        { "drops_total", "physical", "Donnees perdues parce que le buffer de reception etait plein" },
+        { "corrupted_frames_total", "physical", "Trames corrompues rejetees" },
+
+        { "frames_sent_total", "link", nullptr },
+        { "bytes_sent_total", "link", nullptr },
+        { "frames_received_total", "link", nullptr },
+        { "bytes_received_total", "link", nullptr },
+        { "corrupted_frames_total", "link", nullptr },
+        { "retransmissions_total", "link", "Trames de donnees reenvoyees apres l'expiration de leur timer" },
+        { "naks_sent_total", "link", "NAK envoyes" },
+        { "naks_received_total", "link", "NAK recus" },
+        { "ack_timeouts_total", "link", "Timers de ACK arrives a echeance" },
+
+        { "frames_sent_total", "network", nullptr },
+        { "bytes_sent_total", "network", nullptr },
+        { "frames_received_total", "network", nullptr },
+        { "bytes_received_total", "network", nullptr },
+
+        { "frames_sent_total", "hub", nullptr },
+        { "drops_total", "hub", nullptr },
+    };
+
+    // Compteurs d'un fil d'execution : ecrits seulement par ce fil, lus par TakeSnapshot depuis un autre
+    struct alignas(CacheLineSize) Shard
+    {
+        std::atomic<uint64_t> Values[MetricCount];
+
+        Shard();
+        ~Shard();
+    };
+
+    struct WatchedQueue
+    {
+        std::string Queue;
+        std::string Node;
+        size_t Capacity;
+        std::function<size_t()> HighWaterMark;
+    };
+
+    struct Registry
+    {
+        std::mutex Mutex;
+        std::vector<Shard*> Shards; // Compteurs des fils d'execution vivants
+        uint64_t Retired[MetricCount] = {}; // Compteurs des fils d'execution termines
+        std::map<size_t, WatchedQueue> Queues;
+        size_t NextQueueID = 0;
+    };
+
+    // Jamais detruit : des fils d'execution et des files peuvent disparaitre pendant la destruction des objets statiques
+    Registry& registry()
+    {
+        static Registry* instance = new Registry();
+        return *instance;
+    }
+
+    Shard::Shard()
+    {
+        for (std::atomic<uint64_t>& value : Values)
+        {
+            value.store(0, std::memory_order_relaxed);
+        }
+        Registry& metrics = registry();
+        std::lock_guard<std::mutex> lock(metrics.Mutex);
+        metrics.Shards.push_back(this);
+    }
+
+    Shard::~Shard()
+    {
+        // Les compteurs du fil d'execution restent dans les totaux
+        Registry& metrics = registry();
+        std::lock_guard<std::mutex> lock(metrics.Mutex);
+        for (size_t i = 0; i < MetricCount; ++i)
+        {
+            metrics.Retired[i] += Values[i].load(std::memory_order_relaxed);
+        }
+        metrics.Shards.erase(std::find(metrics.Shards.begin(), metrics.Shards.end(), this));
+    }
+
+    Shard& localShard()
+    {
+        static thread_local Shard shard;
+        return shard;
+    }
+}
+
+const Metrics::Description& Metrics::Describe(Metric metric)
+{
+    return Descriptions[(size_t)metric];
+}
+
+void Metrics::Add(Metric metric, uint64_t value)
+{
+    // Un seul fil ecrit le compteur : pas besoin d'une operation atomique de lecture-modification-ecriture
+    std::atomic<uint64_t>& counter = localShard().Values[(size_t)metric];
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+Metrics::Snapshot Metrics::TakeSnapshot()
+{
+    Snapshot snapshot;
+    Registry& metrics = registry();
+    std::lock_guard<std::mutex> lock(metrics.Mutex);
+    for (size_t i = 0; i < MetricCount; ++i)
+    {
+        snapshot.Values[i] = metrics.Retired[i];
+        for (const Shard* shard : metrics.Shards)
+        {
+            snapshot.Values[i] += shard->Values[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    // Par exemple les buffers des journaux, un par fil d'execution : ils ne forment qu'une serie
+    std::map<std::pair<std::string, std::string>, size_t> positions;
+    for (const auto& entry : metrics.Queues)
+    {
+        const WatchedQueue& queue = entry.second;
+        size_t highWaterMark = queue.HighWaterMark();
+        auto inserted = positions.emplace(std::make_pair(queue.Queue, queue.Node), snapshot.Queues.size());
+        if (inserted.second)
+        {
+            snapshot.Queues.push_back(QueueSample{ queue.Queue, queue.Node, highWaterMark, queue.Capacity });
+        }
+        else
+        {
+            QueueSample& sample = snapshot.Queues[inserted.first->second];
+            sample.HighWaterMark = std::max(sample.HighWaterMark, highWaterMark);
+            sample.Capacity = std::max(sample.Capacity, queue.Capacity);
+        }
+    }
+    return snapshot;
+}
+
+size_t Metrics::WatchQueue(const std::string& queue, const std::string& node, size_t capacity, std::function<size_t()> highWaterMark)
+{
+    Registry& metrics = registry();
+    std::lock_guard<std::mutex> lock(metrics.Mutex);
+    size_t id = metrics.NextQueueID++;
+    metrics.Queues.emplace(id, WatchedQueue{ queue, node, capacity, std::move(highWaterMark) });
+    return id;
+}
+
+std::string Metrics::NodeLabel(const MACAddress& address)
+{
+    std::ostringstream label;
+    label << address;
+    return label.str();
+}
+
+void Metrics::UnwatchQueue(size_t id)
+{
+    Registry& metrics = registry();
+    std::lock_guard<std::mutex> lock(metrics.Mutex);
+    metrics.Queues.erase(id);
+}
\ No newline at end of file
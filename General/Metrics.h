@@ -0,0 +1,114 @@
+#ifndef _GENERAL_METRICS_H_
+#define _GENERAL_METRICS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "../DataStructures/MACAddress.h"
+
+// Compteurs de la simulation, additionnes pour tous les ordinateurs
+enum class Metric : uint8_t
+{
+    PhysicalFramesSent,
+    PhysicalBytesSent,
+    PhysicalFramesReceived,
+    PhysicalBytesReceived,
+    PhysicalDrops, // Buffer de reception de la couche physique plein
+    PhysicalCorruptedFrames, // Erreurs detectees et non corrigees par le decodeur
+
+    LinkFramesSent, // Donnees, ACK et NAK
+    LinkBytesSent,
+    LinkFramesReceived,
+    LinkBytesReceived,
+    LinkCorruptedFrames, // Trames trop courtes pour contenir un paquet
+    Retransmissions,
+    NaksSent,
+    NaksReceived,
+    AckTimeouts,
+
+    NetworkPacketsSent,
+    NetworkBytesSent,
+    NetworkPacketsReceived,
+    NetworkBytesReceived,
+
+    HubFramesDispatched, // Une fois par port destinataire
+    HubDrops, // Buffer du cable plein
+
+    Count
+};
+
+// Registre des compteurs et des jauges de la simulation.
+// Chaque fil d'execution incremente ses propres compteurs, sur leurs propres lignes de cache, sans verrou ni operation atomique
+// de lecture-modification-ecriture. Seule la lecture (snapshot) additionne les compteurs de tous les fils, sous verrou.
+// Les jauges sont les niveaux maximaux atteints par les files (voir QueueWatch), lus seulement au moment du snapshot.
+class Metrics
+{
+public:
+    struct Description
+    {
+        const char* Name; // Nom de la serie, sans prefixe ; plusieurs compteurs peuvent partager un nom avec des couches differentes
+        const char* Layer;
+        const char* Help;
+    };
+
+    struct QueueSample
+    {
+        std::string Queue;
+        std::string Node;
+        size_t HighWaterMark;
+        size_t Capacity;
+    };
+
+    struct Snapshot
+    {
+        uint64_t Values[(size_t)Metric::Count] = {};
+        std::vector<QueueSample> Queues; // Les files de meme nom et de meme noeud sont regroupees : niveau et capacite maximaux
+    };
+
+    static const Description& Describe(Metric metric);
+
+    static void Add(Metric metric, uint64_t value = 1);
+
+    static Snapshot TakeSnapshot();
+
+    // Enregistre une file a surveiller, retourne l'identifiant a passer a UnwatchQueue
+    static size_t WatchQueue(const std::string& queue, const std::string& node, size_t capacity, std::function<size_t()> highWaterMark);
+    static void UnwatchQueue(size_t id);
+
+    // Adresse ecrite comme dans les journaux (ex. : de:ad:be:ef:0:1)
+    static std::string NodeLabel(const MACAddress& address);
+};
+
+// Surveille le niveau maximal d'une file (CircularQueue ou ObjectQueue) pendant la duree de vie de l'objet.
+// Doit etre detruit avant la file : on le declare apres elle dans la classe qui la contient.
+class QueueWatch
+{
+    size_t m_id;
+
+    QueueWatch& operator=(const QueueWatch&) = delete;
+    QueueWatch(const QueueWatch&) = delete;
+
+public:
+    template<typename Queue>
+    QueueWatch(const std::string& queue, const std::string& node, const Queue& watched)
+        : m_id(Metrics::WatchQueue(queue, node, watched.capacity(), [&watched]() { return watched.highWaterMark(); }))
+    {
+    }
+
+    // Le noeud est l'adresse de l'ordinateur, ecrite comme dans les journaux
+    template<typename Queue>
+    QueueWatch(const std::string& queue, const MACAddress& node, const Queue& watched)
+        : QueueWatch(queue, Metrics::NodeLabel(node), watched)
+    {
+    }
+
+    ~QueueWatch()
+    {
+        Metrics::UnwatchQueue(m_id);
+    }
+};
+
+#endif //_GENERAL_METRICS_H_
@@ -0,0 +1,219 @@
+#include "MetricsExporter.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <set>
+
+#include "Configuration.h"
+
+namespace
+{
+    const char* const Prefix = "simulateur_";
+
+    // Quantiles exportes pour chaque histogramme ; 1 est le maximum
+    const double Quantiles[] = { 0.5, 0.99, 0.999, 1.0 };
+
+    double ToSeconds(std::chrono::nanoseconds time)
+    {
+        return std::chrono::duration<double>(time).count();
+    }
+
+    std::chrono::nanoseconds QuantileOf(const LatencyHistogram& histogram, double quantile)
+    {
+        return quantile >= 1.0 ? histogram.max() : histogram.percentile(quantile * 100.0);
+    }
+
+    bool EndsWith(const std::string& text, const std::string& suffix)
+    {
+        return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    // Etiquettes d'une file au format de Prometheus, sans noeud pour les files partagees par tous (ex. : les journaux)
+    std::string QueueLabels(const Metrics::QueueSample& sample)
+    {
+        std::string labels = "queue=\"" + sample.Queue + "\"";
+        if (!sample.Node.empty())
+        {
+            labels += ",node=\"" + sample.Node + "\"";
+        }
+        return labels;
+    }
+}
+
+MetricsExporter::MetricsExporter(const std::string& fileName, const Configuration& config)
+    : m_fileName(fileName)
+    , m_format(EndsWith(fileName, ".csv") ? Format::CSV : Format::Prometheus)
+    , m_interval(std::max(1, config.get(Configuration::METRICS_EXPORT_INTERVAL)))
+    , m_start(std::chrono::steady_clock::now())
+    , m_running(false)
+{
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    stop();
+}
+
+bool MetricsExporter::start()
+{
+    if (m_format == Format::CSV)
+    {
+        m_csvFile.open(m_fileName, std::ios::out | std::ios::trunc);
+        if (!m_csvFile)
+        {
+            return false;
+        }
+        WriteCSVHeader(m_csvFile);
+    }
+    else if (!std::ofstream(m_fileName))
+    {
+        return false;
+    }
+
+    m_start = std::chrono::steady_clock::now();
+    m_running = true;
+    m_thread = std::thread(&MetricsExporter::exporterLoop, this);
+    return true;
+}
+
+void MetricsExporter::stop()
+{
+    if (!m_running.exchange(false))
+    {
+        return;
+    }
+    m_stopNotifier.notify();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+    // Dernier snapshot, une fois tout le trafic termine
+    exportSnapshot();
+    m_csvFile.close();
+}
+
+void MetricsExporter::exporterLoop()
+{
+    while (m_running)
+    {
+        if (!m_stopNotifier.wait([this]() { return !m_running; }, m_interval))
+        {
+            exportSnapshot();
+        }
+    }
+}
+
+bool MetricsExporter::exportSnapshot()
+{
+    Metrics::Snapshot snapshot = Metrics::TakeSnapshot();
+    std::vector<LatencyHistogram> latencies;
+    for (size_t i = 0; i < (size_t)Latency::Count; ++i)
+    {
+        latencies.push_back(Latencies::TakeSnapshot((Latency)i));
+    }
+    if (m_format == Format::CSV)
+    {
+        int64_t elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_start).count();
+        WriteCSV(m_csvFile, snapshot, latencies, elapsed);
+        m_csvFile.flush();
+        return (bool)m_csvFile;
+    }
+
+    // Le fichier est ecrit a cote puis renomme : un lecteur ne voit jamais un snapshot incomplet
+    std::string temporaryName = m_fileName + ".tmp";
+    {
+        std::ofstream out(temporaryName, std::ios::out | std::ios::trunc);
+        WritePrometheus(out, snapshot, latencies);
+        if (!out)
+        {
+            return false;
+        }
+    }
+    if (std::rename(temporaryName.c_str(), m_fileName.c_str()) != 0)
+    {
+        // Sous Windows, rename ne remplace pas un fichier existant
+        std::remove(m_fileName.c_str());
+        return std::rename(temporaryName.c_str(), m_fileName.c_str()) == 0;
+    }
+    return true;
+}
+
+void MetricsExporter::WritePrometheus(std::ostream& out, const Metrics::Snapshot& snapshot, const std::vector<LatencyHistogram>& latencies)
+{
+    // Les compteurs de meme nom doivent se suivre, sous une seule description
+    std::set<std::string> written;
+    for (size_t i = 0; i < (size_t)Metric::Count; ++i)
+    {
+        const Metrics::Description& description = Metrics::Describe((Metric)i);
+        if (!written.insert(description.Name).second)
+        {
+            continue;
+        }
+        out << "# HELP " << Prefix << description.Name << " " << description.Help << "\n";
+        out << "# TYPE " << Prefix << description.Name << " counter\n";
+        for (size_t j = i; j < (size_t)Metric::Count; ++j)
+        {
+            const Metrics::Description& other = Metrics::Describe((Metric)j);
+            if (std::string(other.Name) == description.Name)
+            {
+                out << Prefix << other.Name << "{layer=\"" << other.Layer << "\"} " << snapshot.Values[j] << "\n";
+            }
+        }
+    }
+
+    out << "# HELP " << Prefix << "queue_high_water_mark Plus grand nombre d'elements (octets pour un buffer circulaire) presents en meme temps dans la file\n";
+    out << "# TYPE " << Prefix << "queue_high_water_mark gauge\n";
+    for (const Metrics::QueueSample& sample : snapshot.Queues)
+    {
+        out << Prefix << "queue_high_water_mark{" << QueueLabels(sample) << "} " << sample.HighWaterMark << "\n";
+    }
+    out << "# HELP " << Prefix << "queue_capacity Capacite de la file, dans la meme unite\n";
+    out << "# TYPE " << Prefix << "queue_capacity gauge\n";
+    for (const Metrics::QueueSample& sample : snapshot.Queues)
+    {
+        out << Prefix << "queue_capacity{" << QueueLabels(sample) << "} " << sample.Capacity << "\n";
+    }
+
+    for (size_t i = 0; i < latencies.size(); ++i)
+    {
+        const Latencies::Description& description = Latencies::Describe((Latency)i);
+        const LatencyHistogram& histogram = latencies[i];
+        out << "# HELP " << Prefix << description.Name << "_seconds " << description.Help << "\n";
+        out << "# TYPE " << Prefix << description.Name << "_seconds summary\n";
+        for (double quantile : Quantiles)
+        {
+            out << Prefix << description.Name << "_seconds{quantile=\"" << quantile << "\"} " << ToSeconds(QuantileOf(histogram, quantile)) << "\n";
+        }
+        out << Prefix << description.Name << "_seconds_sum " << ToSeconds(histogram.sum()) << "\n";
+        out << Prefix << description.Name << "_seconds_count " << histogram.count() << "\n";
+    }
+}
+
+void MetricsExporter::WriteCSVHeader(std::ostream& out)
+{
+    out << "elapsed_ms,metric,layer,queue,node,value\n";
+}
+
+void MetricsExporter::WriteCSV(std::ostream& out, const Metrics::Snapshot& snapshot, const std::vector<LatencyHistogram>& latencies, int64_t elapsedMilliseconds)
+{
+    for (size_t i = 0; i < (size_t)Metric::Count; ++i)
+    {
+        const Metrics::Description& description = Metrics::Describe((Metric)i);
+        out << elapsedMilliseconds << "," << description.Name << "," << description.Layer << ",,," << snapshot.Values[i] << "\n";
+    }
+    for (const Metrics::QueueSample& sample : snapshot.Queues)
+    {
+        out << elapsedMilliseconds << ",queue_high_water_mark,," << sample.Queue << "," << sample.Node << "," << sample.HighWaterMark << "\n";
+        out << elapsedMilliseconds << ",queue_capacity,," << sample.Queue << "," << sample.Node << "," << sample.Capacity << "\n";
+    }
+    // Quantiles en secondes, par exemple frame_round_trip_p99
+    for (size_t i = 0; i < latencies.size(); ++i)
+    {
+        const char* name = Latencies::Describe((Latency)i).Name;
+        out << elapsedMilliseconds << "," << name << "_count,,,," << latencies[i].count() << "\n";
+        out << elapsedMilliseconds << "," << name << "_p50,,,," << ToSeconds(latencies[i].percentile(50.0)) << "\n";
+        out << elapsedMilliseconds << "," << name << "_p99,,,," << ToSeconds(latencies[i].percentile(99.0)) << "\n";
+        out << elapsedMilliseconds << "," << name << "_p999,,,," << ToSeconds(latencies[i].percentile(99.9)) << "\n";
+        out << elapsedMilliseconds << "," << name << "_max,,,," << ToSeconds(latencies[i].max()) << "\n";
+    }
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#ifndef _GENERAL_METRICS_EXPORTER_H_
+#define _GENERAL_METRICS_EXPORTER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LatencyHistogram.h"
+#include "Metrics.h"
+#include "Notifier.h"
+
+class Configuration;
+
+// Ecrit regulierement un snapshot des metriques (voir Metrics) dans un fichier local, depuis son propre fil d'execution.
+// Format texte de Prometheus : le fichier est remplace a chaque snapshot, comme l'attend le collecteur textfile de node_exporter.
+// Format CSV (fichier en .csv) : chaque snapshot ajoute une ligne par serie, avec le temps ecoule depuis le demarrage.
+// Les histogrammes de Latencies sont exportes avec les metriques (p50, p99, p999 et max).
+// Un dernier snapshot est ecrit a l'arret.
+class MetricsExporter
+{
+public:
+    enum class Format
+    {
+        Prometheus,
+        CSV,
+    };
+
+private:
+    std::string m_fileName;
+    Format m_format;
+    std::chrono::milliseconds m_interval;
+    std::chrono::steady_clock::time_point m_start;
+    std::ofstream m_csvFile;
+
+    std::atomic<bool> m_running;
+    Notifier m_stopNotifier;
+    std::thread m_thread;
+
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+    MetricsExporter(const MetricsExporter&) = delete;
+
+    void exporterLoop();
+
+public:
+    // L'intervalle vient de la configuration globale
+    MetricsExporter(const std::string& fileName, const Configuration& config);
+    ~MetricsExporter();
+
+    // Retourne faux si le fichier ne peut pas etre cree
+    bool start();
+    void stop();
+
+    // Ecrit un snapshot immediatement. Retourne faux si le fichier n'a pas pu etre ecrit.
+    bool exportSnapshot();
+
+    // latencies contient un histogramme par valeur de Latency, dans l'ordre
+    static void WritePrometheus(std::ostream& out, const Metrics::Snapshot& snapshot, const std::vector<LatencyHistogram>& latencies);
+    static void WriteCSVHeader(std::ostream& out);
+    static void WriteCSV(std::ostream& out, const Metrics::Snapshot& snapshot, const std::vector<LatencyHistogram>& latencies, int64_t elapsedMilliseconds);
+};
+
+#endif //_GENERAL_METRICS_EXPORTER_H_
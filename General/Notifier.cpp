@@ -0,0 +1,35 @@
+#include "Notifier.h"
+#include "Executor.h"
+
+constexpr unsigned int Notifier::SpinCount;
+constexpr std::chrono::milliseconds Notifier::MaximumWaitTime;
+
+Notifier::Notifier()
+    : m_waiters(0)
+    , m_task(nullptr)
+{
+}
+
+void Notifier::notify()
+{
+    // Les donnees publiees par l'appelant doivent etre visibles avant qu'on regarde si quelqu'un attend
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    Task* task = m_task.load(std::memory_order_relaxed);
+    if (task)
+    {
+        task->schedule();
+    }
+    if (m_waiters.load(std::memory_order_relaxed) > 0)
+    {
+        // Prendre le verrou garantit que le fil en attente est soit avant sa verification de la condition, soit deja endormi
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+        }
+        m_condition.notify_all();
+    }
+}
+
+void Notifier::setTask(Task* task)
+{
+    m_task = task;
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#ifndef _GENERAL_NOTIFIER_H_
+#define _GENERAL_NOTIFIER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+class Task;
+
+// Permet a un fil d'execution d'attendre qu'une condition devienne vraie sans faire d'attente active.
+// L'attente verifie d'abord la condition quelques fois, puis le fil d'execution est endormi sur une variable de condition.
+// Le producteur appelle notify() apres avoir publie ses donnees : l'appel ne coute qu'une lecture atomique si personne n'attend.
+// Lorsque le consommateur est une Task de l'Executor plutot qu'un fil d'execution, notify() programme la tache associee.
+class Notifier
+{
+    std::atomic<unsigned int> m_waiters;
+    std::atomic<Task*> m_task;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+
+    Notifier& operator=(const Notifier&) = delete;
+    Notifier(const Notifier&) = delete;
+
+public:
+    // Nombre de verifications de la condition avant d'endormir le fil d'execution
+    static constexpr unsigned int SpinCount = 64;
+    // Delai maximal d'une attente, par securite si une notification n'est jamais envoyee
+    static constexpr std::chrono::milliseconds MaximumWaitTime = std::chrono::milliseconds(100);
+
+    Notifier();
+    ~Notifier() = default;
+
+    void notify();
+
+    // Tache a programmer a chaque notification. Doit vivre aussi longtemps que le Notifier.
+    void setTask(Task* task);
+
+    // Attend que ready() retourne vrai ou que le delai soit ecoule. Retourne la derniere valeur de ready().
+    template<typename Predicate>
+    bool wait(Predicate ready, std::chrono::milliseconds timeout = MaximumWaitTime)
+    {
+        for (unsigned int i = 0; i < SpinCount; ++i)
+        {
+            if (ready())
+            {
+                return true;
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_waiters.fetch_add(1);
+        // La condition est verifiee apres s'etre annonce : une publication faite avant sera vue, une publication faite apres nous reveillera
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool result = m_condition.wait_for(lock, timeout, ready);
+        m_waiters.fetch_sub(1);
+        return result;
+    }
+};
+
+#endif //_GENERAL_NOTIFIER_H_
\ No newline at end of file
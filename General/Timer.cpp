@@ -1,10 +1,432 @@
 #include "Timer.h"
+#include "Configuration.h"
 
 #include<algorithm>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#include <iterator>
+#include <stdexcept>
 
-Timer::Timer()
-    : m_timerRunning(false)
-    , m_nextID(1)
+std::unique_ptr<TimerQueue> TimerQueue::CreateTimerQueue(const Configuration& config)
+{
+    int timerQueueConfig = config.get(Configuration::LINK_LAYER_TIMER_QUEUE);
+    if (timerQueueConfig == 1)
+    {
+        return std::make_unique<HeapTimerQueue>();
+    }
+    else
+    {
+        return std::make_unique<TimingWheelTimerQueue>();
+    }
+}
+
+//===========================================
+
+HeapTimerQueue::HeapTimerQueue()
+    : m_nextID(1)
+{
+}
+
+size_t HeapTimerQueue::add(std::chrono::milliseconds interval, Callback function, NumberSequence numberData, Clock::time_point now)
+{
+    size_t timerID = m_nextID++;
+    TimerInfo info;
+    info.ID = timerID;
+    info.Interval = interval;
+    info.Function = std::move(function);
+    info.NumberData = numberData;
+    info.Start = now;
+    info.NextTick = info.Start + info.Interval;
+
+    m_timersHeap.push_back(std::move(info));
+    std::push_heap(m_timersHeap.begin(), m_timersHeap.end(), m_comparer);
+    return timerID;
+}
+
+bool HeapTimerQueue::restart(size_t timerID, NumberSequence numberData, Clock::time_point now)
+{
+    for (auto it = m_timersHeap.begin(); it != m_timersHeap.end(); ++it)
+    {
+        if ((*it).ID == timerID)
+        {
+            (*it).Start = now;
+            (*it).NextTick = (*it).Start + (*it).Interval;
+            (*it).NumberData = numberData;
+            std::iter_swap(it, --m_timersHeap.end());
+            std::make_heap(m_timersHeap.begin(), m_timersHeap.end(), m_comparer);
+            return true;
+        }
+    }
+    return false;
+}
+
+void HeapTimerQueue::remove(size_t timerID)
+{
+    for (auto it = m_timersHeap.begin(); it != m_timersHeap.end(); ++it)
+    {
+        if (it->ID == timerID)
+        {
+            std::iter_swap(it, --m_timersHeap.end());
+            m_timersHeap.pop_back();
+            std::make_heap(m_timersHeap.begin(), m_timersHeap.end(), m_comparer);
+            return;
+        }
+    }
+}
+
+void HeapTimerQueue::restartAll(Clock::time_point now)
+{
+    for (auto it = m_timersHeap.begin(); it != m_timersHeap.end(); ++it)
+    {
+        (*it).Start = now;
+        (*it).NextTick = (*it).Start + (*it).Interval;
+    }
+    // Ordonne les timers par priorite
+    std::make_heap(m_timersHeap.begin(), m_timersHeap.end(), m_comparer);
+}
+
+void HeapTimerQueue::popExpired(Clock::time_point now, std::vector<TimerInfo>& expired)
+{
+    while (m_timersHeap.size() > 0 && now >= m_timersHeap.front().NextTick)
+    {
+        // Enleve le timer et recupere le prochain
+        std::pop_heap(m_timersHeap.begin(), m_timersHeap.end(), m_comparer);
+        expired.push_back(std::move(m_timersHeap.back()));
+        m_timersHeap.pop_back();
+    }
+}
+
+TimerQueue::Clock::time_point HeapTimerQueue::nextDeadline() const
+{
+    if (m_timersHeap.size() > 0)
+    {
+        return m_timersHeap.front().NextTick;
+    }
+    return Clock::time_point::max();
+}
+
+size_t HeapTimerQueue::size() const
+{
+    return m_timersHeap.size();
+}
+
+//===========================================
+
+// Position du premier bit a 1. value ne doit pas etre nul.
+static uint32_t CountTrailingZeros(uint64_t value)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (uint32_t)index;
+#elif defined(__GNUC__)
+    return (uint32_t)__builtin_ctzll(value);
+#else
+    uint32_t index = 0;
+    while ((value & 1) == 0)
+    {
+        value >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+constexpr uint32_t TimingWheelTimerQueue::SlotBits;
+constexpr uint32_t TimingWheelTimerQueue::SlotCount;
+constexpr uint32_t TimingWheelTimerQueue::LevelCount;
+constexpr uint32_t TimingWheelTimerQueue::NoEntry;
+constexpr size_t TimingWheelTimerQueue::IndexBits;
+
+TimingWheelTimerQueue::TimingWheelTimerQueue(std::chrono::milliseconds tickDuration)
+    : m_tickDuration(std::chrono::duration_cast<Clock::duration>(tickDuration))
+    , m_origin(Clock::now())
+    , m_currentTick(0)
+    , m_size(0)
+{
+    if (m_tickDuration.count() <= 0)
+    {
+        throw std::out_of_range("La duree d'un tick de la roue de temporisation doit etre positive.");
+    }
+    std::fill(std::begin(m_slots), std::end(m_slots), NoEntry);
+    std::fill(std::begin(m_occupiedSlots), std::end(m_occupiedSlots), 0);
+}
+
+uint64_t TimingWheelTimerQueue::tickAt(Clock::time_point time) const
+{
+    if (time <= m_origin)
+    {
+        return 0;
+    }
+    return (uint64_t)((time - m_origin) / m_tickDuration);
+}
+
+uint64_t TimingWheelTimerQueue::expiryTickOf(const TimerInfo& info) const
+{
+    // Arrondi vers le haut : un timer ne doit jamais expirer avant son echeance
+    if (info.NextTick <= m_origin)
+    {
+        return 0;
+    }
+    Clock::duration sinceOrigin = info.NextTick - m_origin;
+    return (uint64_t)((sinceOrigin + m_tickDuration - Clock::duration(1)) / m_tickDuration);
+}
+
+size_t TimingWheelTimerQueue::timerIDOf(uint32_t index) const
+{
+    // L'index est decale de 1 pour que le numero ne soit jamais InvalidTimerID
+    return ((size_t)m_entries[index].Generation << IndexBits) | (size_t)(index + 1);
+}
+
+TimingWheelTimerQueue::Entry* TimingWheelTimerQueue::entryFor(size_t timerID)
+{
+    size_t index = (timerID & (((size_t)1 << IndexBits) - 1)) - 1;
+    if (index >= m_entries.size() || m_entries[index].Slot == NoEntry || timerIDOf((uint32_t)index) != timerID)
+    {
+        return nullptr;
+    }
+    return &m_entries[index];
+}
+
+void TimingWheelTimerQueue::schedule(uint32_t index, uint64_t earliestTick)
+{
+    Entry& entry = m_entries[index];
+    uint64_t expiry = std::max(entry.ExpiryTick, earliestTick);
+    uint64_t delta = expiry - m_currentTick;
+
+    // Le plus bas niveau dont l'etendue couvre l'echeance
+    uint32_t level = 0;
+    while (level + 1 < LevelCount && delta >= ((uint64_t)1 << (SlotBits * (level + 1))))
+    {
+        ++level;
+    }
+    // Une echeance au-dela de la roue est placee dans la derniere case atteignable, puis sera replacee lors de la redistribution
+    uint64_t wheelSpan = (uint64_t)1 << (SlotBits * LevelCount);
+    if (delta >= wheelSpan)
+    {
+        expiry = m_currentTick + wheelSpan - 1;
+    }
+
+    uint32_t slot = level * SlotCount + (uint32_t)((expiry >> (SlotBits * level)) & (SlotCount - 1));
+    entry.Slot = slot;
+    entry.Previous = NoEntry;
+    entry.Next = m_slots[slot];
+    if (entry.Next != NoEntry)
+    {
+        m_entries[entry.Next].Previous = index;
+    }
+    m_slots[slot] = index;
+    m_occupiedSlots[level] |= (uint64_t)1 << (slot & (SlotCount - 1));
+}
+
+void TimingWheelTimerQueue::unlink(uint32_t index)
+{
+    Entry& entry = m_entries[index];
+    if (entry.Previous != NoEntry)
+    {
+        m_entries[entry.Previous].Next = entry.Next;
+    }
+    else
+    {
+        m_slots[entry.Slot] = entry.Next;
+        if (entry.Next == NoEntry)
+        {
+            m_occupiedSlots[entry.Slot / SlotCount] &= ~((uint64_t)1 << (entry.Slot & (SlotCount - 1)));
+        }
+    }
+    if (entry.Next != NoEntry)
+    {
+        m_entries[entry.Next].Previous = entry.Previous;
+    }
+    entry.Previous = NoEntry;
+    entry.Next = NoEntry;
+}
+
+void TimingWheelTimerQueue::release(uint32_t index)
+{
+    Entry& entry = m_entries[index];
+    entry.Slot = NoEntry;
+    entry.Info.Function = nullptr;
+    ++entry.Generation;
+    m_freeEntries.push_back(index);
+    --m_size;
+}
+
+void TimingWheelTimerQueue::cascade(uint32_t level)
+{
+    uint32_t slot = level * SlotCount + (uint32_t)((m_currentTick >> (SlotBits * level)) & (SlotCount - 1));
+    uint32_t index = m_slots[slot];
+    m_slots[slot] = NoEntry;
+    m_occupiedSlots[level] &= ~((uint64_t)1 << (slot & (SlotCount - 1)));
+    while (index != NoEntry)
+    {
+        uint32_t next = m_entries[index].Next;
+        // Un timer dont l'echeance est le tick courant va dans la case du niveau 0 traitee juste apres
+        schedule(index, m_currentTick);
+        index = next;
+    }
+}
+
+uint64_t TimingWheelTimerQueue::nextEventTick() const
+{
+    uint64_t nextTick = std::numeric_limits<uint64_t>::max();
+    for (uint32_t level = 0; level < LevelCount; ++level)
+    {
+        uint64_t occupied = m_occupiedSlots[level];
+        if (occupied == 0)
+        {
+            continue;
+        }
+        // Les cases sont parcourues a partir de celle qui suit la case courante du niveau
+        uint64_t currentUnit = m_currentTick >> (SlotBits * level);
+        uint32_t first = (uint32_t)((currentUnit + 1) & (SlotCount - 1));
+        uint64_t rotated = first == 0 ? occupied : (occupied >> first) | (occupied << (SlotCount - first));
+        uint64_t unit = currentUnit + 1 + CountTrailingZeros(rotated);
+        nextTick = std::min(nextTick, unit << (SlotBits * level));
+    }
+    return nextTick;
+}
+
+size_t TimingWheelTimerQueue::add(std::chrono::milliseconds interval, Callback function, NumberSequence numberData, Clock::time_point now)
+{
+    uint32_t index;
+    if (m_freeEntries.size() > 0)
+    {
+        index = m_freeEntries.back();
+        m_freeEntries.pop_back();
+    }
+    else
+    {
+        if (m_entries.size() + 1 >= ((size_t)1 << IndexBits) || m_entries.size() >= NoEntry)
+        {
+            throw std::out_of_range("Il y a trop de timers actifs dans la roue de temporisation.");
+        }
+        index = (uint32_t)m_entries.size();
+        Entry entry{};
+        entry.Slot = NoEntry;
+        m_entries.push_back(std::move(entry));
+    }
+
+    Entry& entry = m_entries[index];
+    entry.Info.ID = timerIDOf(index);
+    entry.Info.Interval = interval;
+    entry.Info.Function = std::move(function);
+    entry.Info.NumberData = numberData;
+    entry.Info.Start = now;
+    entry.Info.NextTick = entry.Info.Start + entry.Info.Interval;
+    entry.ExpiryTick = expiryTickOf(entry.Info);
+    schedule(index, m_currentTick + 1);
+    ++m_size;
+    return entry.Info.ID;
+}
+
+bool TimingWheelTimerQueue::restart(size_t timerID, NumberSequence numberData, Clock::time_point now)
+{
+    Entry* entry = entryFor(timerID);
+    if (entry == nullptr)
+    {
+        return false;
+    }
+    uint32_t index = (uint32_t)(entry - m_entries.data());
+    unlink(index);
+    entry->Info.Start = now;
+    entry->Info.NextTick = entry->Info.Start + entry->Info.Interval;
+    entry->Info.NumberData = numberData;
+    entry->ExpiryTick = expiryTickOf(entry->Info);
+    schedule(index, m_currentTick + 1);
+    return true;
+}
+
+void TimingWheelTimerQueue::remove(size_t timerID)
+{
+    Entry* entry = entryFor(timerID);
+    if (entry != nullptr)
+    {
+        uint32_t index = (uint32_t)(entry - m_entries.data());
+        unlink(index);
+        release(index);
+    }
+}
+
+void TimingWheelTimerQueue::restartAll(Clock::time_point now)
+{
+    // La roue repart de zero a partir de maintenant
+    std::fill(std::begin(m_slots), std::end(m_slots), NoEntry);
+    std::fill(std::begin(m_occupiedSlots), std::end(m_occupiedSlots), 0);
+    m_origin = now;
+    m_currentTick = 0;
+    for (uint32_t index = 0; index < (uint32_t)m_entries.size(); ++index)
+    {
+        Entry& entry = m_entries[index];
+        if (entry.Slot != NoEntry)
+        {
+            entry.Info.Start = now;
+            entry.Info.NextTick = entry.Info.Start + entry.Info.Interval;
+            entry.ExpiryTick = expiryTickOf(entry.Info);
+            schedule(index, m_currentTick + 1);
+        }
+    }
+}
+
+void TimingWheelTimerQueue::popExpired(Clock::time_point now, std::vector<TimerInfo>& expired)
+{
+    uint64_t targetTick = tickAt(now);
+    while (m_currentTick < targetTick)
+    {
+        // Les ticks sans case a traiter sont sautes d'un coup
+        uint64_t nextTick = nextEventTick();
+        if (nextTick > targetTick)
+        {
+            m_currentTick = targetTick;
+            break;
+        }
+        m_currentTick = nextTick;
+
+        // Les cases des niveaux superieurs qui commencent a ce tick sont redistribuees, du plus haut niveau au plus bas
+        uint32_t level = 0;
+        while (level + 1 < LevelCount && (m_currentTick & (((uint64_t)1 << (SlotBits * (level + 1))) - 1)) == 0)
+        {
+            ++level;
+        }
+        for (; level > 0; --level)
+        {
+            cascade(level);
+        }
+
+        uint32_t slot = (uint32_t)(m_currentTick & (SlotCount - 1));
+        while (m_slots[slot] != NoEntry)
+        {
+            uint32_t index = m_slots[slot];
+            unlink(index);
+            expired.push_back(std::move(m_entries[index].Info));
+            release(index);
+        }
+    }
+}
+
+TimerQueue::Clock::time_point TimingWheelTimerQueue::nextDeadline() const
+{
+    // Le prochain tick peut aussi etre une redistribution : popExpired sera simplement rappele au tick suivant
+    uint64_t nextTick = nextEventTick();
+    if (nextTick == std::numeric_limits<uint64_t>::max())
+    {
+        return Clock::time_point::max();
+    }
+    return m_origin + m_tickDuration * (Clock::duration::rep)nextTick;
+}
+
+size_t TimingWheelTimerQueue::size() const
+{
+    return m_size;
+}
+
+//===========================================
+
+Timer::Timer(std::unique_ptr<TimerQueue> timers)
+    : m_timers(std::move(timers))
+    , m_nextWakeUp(TimerQueue::Clock::time_point::max())
+    , m_timerRunning(false)
 {
 }
 
@@ -16,50 +438,67 @@ Timer::~Timer()
 
 void Timer::innerTimer()
 {
+    std::unique_lock<std::mutex> lock(m_lockMutex);
     while (m_timerRunning)
     {
-        std::lock_guard<std::mutex> lockGuard(m_lockMutex);
-        if (m_timersHeap.size() > 0)
+        m_timers->popExpired(TimerQueue::Clock::now(), m_expiredTimers);
+        if (m_expiredTimers.size() > 0)
         {
-            auto now = std::chrono::system_clock::now();
-            TimerInfo& info = m_timersHeap.front();
-            while (now > info.NextTick)
+            // Les fonctions sont appelees sans le mutex, pour ne pas bloquer les fils qui ajoutent ou retirent des timers
+            lock.unlock();
+            for (TimerQueue::TimerInfo& info : m_expiredTimers)
             {
                 info.Function(info.ID, info.NumberData);
-                // Enleve le timer et recupere le prochain
-                std::pop_heap(m_timersHeap.begin(), m_timersHeap.end(), m_comparer);
-                m_timersHeap.pop_back();
-                if (m_timersHeap.size() > 0)
-                {
-                    info = m_timersHeap.front();
-                }
-                else
-                {
-                    break;
-                }
             }
+            m_expiredTimers.clear();
+            lock.lock();
+            continue;
         }
+
+        // Attente passive jusqu'a la prochaine echeance, un ajout plus proche ou l'arret
+        m_nextWakeUp = m_timers->nextDeadline();
+        if (m_nextWakeUp == TimerQueue::Clock::time_point::max())
+        {
+            m_wakeUpCondition.wait(lock);
+        }
+        else
+        {
+            m_wakeUpCondition.wait_until(lock, m_nextWakeUp);
+        }
+    }
+    m_nextWakeUp = TimerQueue::Clock::time_point::max();
+}
+
+void Timer::wakeUpBefore(TimerQueue::Clock::time_point deadline)
+{
+    if (deadline < m_nextWakeUp)
+    {
+        // Le fil recalculera sa prochaine echeance ; on evite de le reveiller a nouveau d'ici la
+        m_nextWakeUp = deadline;
+        m_wakeUpCondition.notify_one();
     }
 }
 
 void Timer::start()
 {
     stop();
-    m_timerRunning = true;
-    // Initialize tous les timers deja enregistres
-    for (auto it = m_timersHeap.begin(); it != m_timersHeap.end(); ++it)
     {
-        (*it).Start = std::chrono::system_clock::now();
-        (*it).NextTick = (*it).Start + (*it).Interval;
+        // Initialize tous les timers deja enregistres
+        std::lock_guard<std::mutex> lockGuard(m_lockMutex);
+        m_timers->restartAll(TimerQueue::Clock::now());
+        m_timerRunning = true;
     }
-    // Ordonne les timers par priorite
-    std::make_heap(m_timersHeap.begin(), m_timersHeap.end(), m_comparer);
     m_timerThread = std::thread(&Timer::innerTimer, this);
 }
 
 void Timer::stop()
 {
-    m_timerRunning = false;
+    {
+        // Le changement est fait sous le mutex pour que le fil ne puisse pas le manquer juste avant de s'endormir
+        std::lock_guard<std::mutex> lockGuard(m_lockMutex);
+        m_timerRunning = false;
+        m_wakeUpCondition.notify_one();
+    }
     if (m_timerThread.joinable())
     {
         m_timerThread.join();
@@ -68,34 +507,21 @@ void Timer::stop()
 
 size_t Timer::addTimer(std::chrono::milliseconds interval, std::function<void(size_t, NumberSequence)> function, NumberSequence numberData)
 {
-    TimerInfo info;
-    info.Interval = interval;
-    info.Function = function;
-    info.NumberData = numberData;
-    info.Start = std::chrono::system_clock::now();
-    info.NextTick = info.Start + info.Interval;
-
+    auto now = TimerQueue::Clock::now();
     std::lock_guard<std::mutex> lockGuard(m_lockMutex);
-    info.ID = m_nextID++;
-    m_timersHeap.push_back(info);
-    std::push_heap(m_timersHeap.begin(), m_timersHeap.end(), m_comparer);
-    return info.ID;
+    size_t timerID = m_timers->add(interval, std::move(function), numberData, now);
+    wakeUpBefore(now + interval);
+    return timerID;
 }
 
 bool Timer::restartTimer(size_t timerID, NumberSequence numberData)
 {
+    auto now = TimerQueue::Clock::now();
     std::lock_guard<std::mutex> lockGuard(m_lockMutex);
-    for (auto it = m_timersHeap.begin(); it != m_timersHeap.end(); ++it)
+    if (m_timers->restart(timerID, numberData, now))
     {
-        if ((*it).ID == timerID)
-        {
-            (*it).Start = std::chrono::system_clock::now();
-            (*it).NextTick = (*it).Start + (*it).Interval;
-            (*it).NumberData = numberData;
-            std::iter_swap(it, --m_timersHeap.end());
-            std::make_heap(m_timersHeap.begin(), m_timersHeap.end(), m_comparer);
-            return true;
-        }
+        wakeUpBefore(m_timers->nextDeadline());
+        return true;
     }
     return false;
 }
@@ -103,14 +529,5 @@ bool Timer::restartTimer(size_t timerID, NumberSequence numberData)
 void Timer::removeTimer(size_t id)
 {
     std::lock_guard<std::mutex> lockGuard(m_lockMutex);
-    for (auto it = m_timersHeap.begin(); it != m_timersHeap.end(); ++it)
-    {
-        if (it->ID == id)
-        {
-            std::iter_swap(it, --m_timersHeap.end());
-            m_timersHeap.pop_back();
-            std::make_heap(m_timersHeap.begin(), m_timersHeap.end(), m_comparer);
-            return;
-        }
-    }
+    m_timers->remove(id);
 }
\ No newline at end of file
@@ -3,25 +3,59 @@
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
 #include <limits>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <vector>
 
 #include "../Computer/Driver/Layer/DataType.h"
 
-class Timer
+class Configuration;
+
+// Ensemble des timers en attente, ordonnes par echeance.
+// Les implementations ne sont pas thread-safe : Timer les protege avec son mutex.
+// Un timer arrive a echeance est retire de la file. Son numero n'est alors plus valide.
+class TimerQueue
 {
+public:
+    // Horloge monotone : un changement de l'heure du systeme ne doit pas declencher ou retarder les timers
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void(size_t, NumberSequence)>;
+
     struct TimerInfo
     {
         size_t ID;
         NumberSequence NumberData;
         std::chrono::milliseconds Interval;
-        std::chrono::system_clock::time_point Start;
-        std::chrono::system_clock::time_point NextTick;
-        std::function<void(size_t, NumberSequence)> Function;
+        Clock::time_point Start;
+        Clock::time_point NextTick;
+        Callback Function;
     };
 
+    virtual ~TimerQueue() = default;
+
+    virtual size_t add(std::chrono::milliseconds interval, Callback function, NumberSequence numberData, Clock::time_point now) = 0;
+    // Repart le timer de zero. Retourne faux si le timer n'existe plus.
+    virtual bool restart(size_t timerID, NumberSequence numberData, Clock::time_point now) = 0;
+    virtual void remove(size_t timerID) = 0;
+    // Repart tous les timers de zero
+    virtual void restartAll(Clock::time_point now) = 0;
+    // Retire les timers arrives a echeance a l'instant now et les ajoute a la fin de expired
+    virtual void popExpired(Clock::time_point now, std::vector<TimerInfo>& expired) = 0;
+    // Instant auquel popExpired doit etre appele la prochaine fois, Clock::time_point::max() s'il n'y a aucun timer
+    virtual Clock::time_point nextDeadline() const = 0;
+    virtual size_t size() const = 0;
+
+    static std::unique_ptr<TimerQueue> CreateTimerQueue(const Configuration& config);
+};
+
+// Monceau binaire : ajout en O(log n), mais redemarrage et retrait en O(n) (recherche lineaire puis reconstruction du monceau)
+class HeapTimerQueue : public TimerQueue
+{
     // Permet de construire le monceau en mettant la plus petite valeur au dbut. Le prochain Timer est celui dont le prochain tick est le plus petit.
     struct TimerInfoComparer
     {
@@ -34,17 +68,102 @@ class Timer
     size_t m_nextID;
     TimerInfoComparer m_comparer;
     std::vector<TimerInfo> m_timersHeap;
+
+public:
+    HeapTimerQueue();
+
+    size_t add(std::chrono::milliseconds interval, Callback function, NumberSequence numberData, Clock::time_point now) override;
+    bool restart(size_t timerID, NumberSequence numberData, Clock::time_point now) override;
+    void remove(size_t timerID) override;
+    void restartAll(Clock::time_point now) override;
+    void popExpired(Clock::time_point now, std::vector<TimerInfo>& expired) override;
+    Clock::time_point nextDeadline() const override;
+    size_t size() const override;
+};
+
+// Roue de temporisation hierarchique : ajout, redemarrage et retrait en O(1).
+// Le temps est divise en ticks de duree fixe. Le niveau 0 contient une case par tick pour les SlotCount prochains ticks,
+// chaque niveau superieur couvre SlotCount fois plus de temps avec des cases SlotCount fois plus larges.
+// Quand le temps atteint une case d'un niveau superieur, ses timers sont redistribues dans les niveaux inferieurs.
+// Chaque case est une liste doublement chainee de timers, dont les liens sont des index dans m_entries.
+// Le numero d'un timer contient son index dans m_entries et une generation, pour reconnaitre un numero perime en O(1).
+class TimingWheelTimerQueue : public TimerQueue
+{
+    static constexpr uint32_t SlotBits = 6; // SlotCount doit rester 64 : les cases occupees d'un niveau tiennent dans un uint64_t
+    static constexpr uint32_t SlotCount = 1 << SlotBits;
+    static constexpr uint32_t LevelCount = 4; // Avec des ticks de 1 ms, couvre 2^24 ms (environ 4 h 40). Les echeances plus lointaines sont revues en chemin.
+    static constexpr uint32_t NoEntry = std::numeric_limits<uint32_t>::max();
+
+    static constexpr size_t IndexBits = sizeof(size_t) * 4; // Bits du numero de timer reserves a l'index, les autres contiennent la generation
+
+    struct Entry
+    {
+        TimerInfo Info;
+        uint64_t ExpiryTick;
+        uint32_t Generation; // Augmente chaque fois que l'entree est liberee
+        uint32_t Slot; // Case (niveau * SlotCount + position) qui contient le timer, NoEntry si l'entree est libre
+        uint32_t Previous;
+        uint32_t Next;
+    };
+
+    Clock::duration m_tickDuration;
+    Clock::time_point m_origin; // Instant du tick 0
+    uint64_t m_currentTick; // Dernier tick traite
+    std::vector<Entry> m_entries;
+    std::vector<uint32_t> m_freeEntries;
+    size_t m_size;
+    uint32_t m_slots[LevelCount * SlotCount]; // Tete de la liste de chaque case
+    uint64_t m_occupiedSlots[LevelCount]; // Un bit par case non vide, pour sauter directement au prochain tick utile
+
+    uint64_t tickAt(Clock::time_point time) const;
+    uint64_t expiryTickOf(const TimerInfo& info) const;
+    size_t timerIDOf(uint32_t index) const;
+    Entry* entryFor(size_t timerID);
+
+    // Place le timer dans la case de son echeance, sans qu'elle soit avant earliestTick
+    void schedule(uint32_t index, uint64_t earliestTick);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+    // Redistribue dans les niveaux inferieurs les timers de la case du niveau qui commence au tick courant
+    void cascade(uint32_t level);
+    // Premier tick apres le tick courant ou une case non vide doit etre traitee ou redistribuee
+    uint64_t nextEventTick() const;
+
+public:
+    TimingWheelTimerQueue(std::chrono::milliseconds tickDuration = std::chrono::milliseconds(1));
+
+    size_t add(std::chrono::milliseconds interval, Callback function, NumberSequence numberData, Clock::time_point now) override;
+    bool restart(size_t timerID, NumberSequence numberData, Clock::time_point now) override;
+    void remove(size_t timerID) override;
+    void restartAll(Clock::time_point now) override;
+    void popExpired(Clock::time_point now, std::vector<TimerInfo>& expired) override;
+    Clock::time_point nextDeadline() const override;
+    size_t size() const override;
+};
+
+// Le fil du Timer dort jusqu'a la prochaine echeance. Il est reveille plus tot si un timer plus proche est ajoute.
+// Les fonctions des timers arrives a echeance sont appelees apres avoir relache le mutex : elles peuvent donc ajouter,
+// redemarrer ou retirer des timers. Un timer retire pendant que les fonctions sont appelees peut encore etre signale une fois.
+class Timer
+{
+    std::unique_ptr<TimerQueue> m_timers;
+    std::vector<TimerQueue::TimerInfo> m_expiredTimers; // Utilise seulement par le fil du Timer
+    TimerQueue::Clock::time_point m_nextWakeUp; // Instant ou le fil du Timer doit se reveiller, protege par m_lockMutex
     
     std::atomic<bool> m_timerRunning;
     std::mutex m_lockMutex;
+    std::condition_variable m_wakeUpCondition;
     std::thread m_timerThread;
 
+    // Reveille le fil du Timer si deadline est avant son prochain reveil. Le mutex doit etre verrouille.
+    void wakeUpBefore(TimerQueue::Clock::time_point deadline);
+
     void innerTimer();
 
 public:
     static constexpr size_t InvalidTimerID = 0;
 
-    Timer();
+    Timer(std::unique_ptr<TimerQueue> timers = std::make_unique<HeapTimerQueue>());
     ~Timer();
 
     void start();
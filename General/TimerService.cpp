@@ -0,0 +1,189 @@
+#include "TimerService.h"
+#include "Configuration.h"
+#include "../Simulation/EventSimulator.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+std::mutex TimerService::s_sharedMutex;
+std::unique_ptr<TimerService> TimerService::s_shared;
+
+TimerService::TimerService(size_t shardCount, const Configuration& config)
+    : m_nextShard(0)
+{
+    if (shardCount == 0)
+    {
+        shardCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < shardCount; ++i)
+    {
+        std::shared_ptr<Timer> shard = std::make_shared<Timer>(TimerQueue::CreateTimerQueue(config));
+        shard->start();
+        m_shards.push_back(shard);
+    }
+}
+
+TimerService::~TimerService()
+{
+    for (std::shared_ptr<Timer>& shard : m_shards)
+    {
+        shard->stop();
+    }
+}
+
+size_t TimerService::shardCount() const
+{
+    return m_shards.size();
+}
+
+std::shared_ptr<Timer> TimerService::nextShard()
+{
+    return m_shards[m_nextShard.fetch_add(1, std::memory_order_relaxed) % m_shards.size()];
+}
+
+TimerService& TimerService::Shared()
+{
+    std::lock_guard<std::mutex> lock(s_sharedMutex);
+    if (!s_shared)
+    {
+        Configuration defaultConfig("");
+        s_shared = std::make_unique<TimerService>(defaultConfig.get(Configuration::TIMER_SERVICE_THREAD_COUNT), defaultConfig);
+    }
+    return *s_shared;
+}
+
+void TimerService::ConfigureShared(const Configuration& config)
+{
+    std::lock_guard<std::mutex> lock(s_sharedMutex);
+    if (s_shared)
+    {
+        throw std::logic_error("Le service de timers partage est deja utilise, il ne peut plus etre configure.");
+    }
+    s_shared = std::make_unique<TimerService>(config.get(Configuration::TIMER_SERVICE_THREAD_COUNT), config);
+}
+
+//===========================================
+
+TimerHandle::TimerHandle(TimerService& service)
+    : m_shard(service.nextShard())
+    , m_simulator(nullptr)
+    , m_state(std::make_shared<OwnerState>())
+{
+}
+
+TimerHandle::TimerHandle(EventSimulator& simulator)
+    : m_shard()
+    , m_simulator(&simulator)
+    , m_state(std::make_shared<OwnerState>())
+{
+}
+
+TimerHandle::~TimerHandle()
+{
+    stop();
+}
+
+void TimerHandle::start()
+{
+    std::lock_guard<std::mutex> lock(m_state->CallbackMutex);
+    uint64_t epoch = m_state->Epoch.load(std::memory_order_relaxed);
+    if (epoch % 2 == 0)
+    {
+        m_state->Epoch.store(epoch + 1, std::memory_order_relaxed);
+    }
+}
+
+void TimerHandle::stop()
+{
+    // Attend la fin d'une fonction en cours d'appel : les suivantes verront que l'epoque a change
+    std::lock_guard<std::mutex> lock(m_state->CallbackMutex);
+    uint64_t epoch = m_state->Epoch.load(std::memory_order_relaxed);
+    if (epoch % 2 == 1)
+    {
+        m_state->Epoch.store(epoch + 1, std::memory_order_relaxed);
+    }
+}
+
+size_t TimerHandle::addTimer(std::chrono::milliseconds interval, std::function<void(size_t, NumberSequence)> function, NumberSequence numberData)
+{
+    std::shared_ptr<OwnerState> state = m_state;
+    uint64_t epoch = state->Epoch.load(std::memory_order_relaxed);
+    if (m_simulator)
+    {
+        // Le numero n'est connu qu'apres la programmation : l'evenement le retrouve dans une variable partagee
+        std::shared_ptr<size_t> id = std::make_shared<size_t>(0);
+        *id = (size_t)m_simulator->schedule(interval, [state, epoch, id]()
+        {
+            auto it = state->VirtualTimers.find(*id);
+            if (it == state->VirtualTimers.end())
+            {
+                return;
+            }
+            VirtualTimer timer = std::move(it->second);
+            state->VirtualTimers.erase(it);
+            if (epoch % 2 == 1 && state->Epoch.load(std::memory_order_relaxed) == epoch)
+            {
+                timer.Function(*id, timer.NumberData);
+            }
+        });
+        state->VirtualTimers[*id] = { function, numberData };
+        return *id;
+    }
+    // Le verrou est tenu jusqu'a l'enregistrement du numero : un timer deja echu ne peut pas le retirer avant
+    std::lock_guard<std::mutex> timersLock(state->TimersMutex);
+    size_t id = m_shard->addTimer(interval, [state, epoch, function](size_t timerID, NumberSequence number)
+    {
+        {
+            std::lock_guard<std::mutex> lock(state->TimersMutex);
+            state->Timers.erase(timerID);
+        }
+        std::lock_guard<std::mutex> lock(state->CallbackMutex);
+        // Le timer est ignore si le proprietaire a ete arrete (et peut-etre detruit) depuis l'ajout
+        if (epoch % 2 == 1 && state->Epoch.load(std::memory_order_relaxed) == epoch)
+        {
+            function(timerID, number);
+        }
+    }, numberData);
+    state->Timers.insert(id);
+    return id;
+}
+
+bool TimerHandle::restartTimer(size_t timerID, NumberSequence numberData)
+{
+    if (m_simulator)
+    {
+        auto it = m_state->VirtualTimers.find(timerID);
+        if (it == m_state->VirtualTimers.end() || !m_simulator->reschedule(timerID))
+        {
+            return false;
+        }
+        it->second.NumberData = numberData;
+        return true;
+    }
+    // Le fil est partage par plusieurs proprietaires : un numero qui ne vient pas de ce TimerHandle designe le timer d'un autre
+    std::lock_guard<std::mutex> lock(m_state->TimersMutex);
+    if (m_state->Timers.count(timerID) == 0)
+    {
+        return false;
+    }
+    return m_shard->restartTimer(timerID, numberData);
+}
+
+void TimerHandle::removeTimer(size_t id)
+{
+    if (m_simulator)
+    {
+        // Les numeros d'evenements sont partages avec les taches et les autres proprietaires de la partition
+        if (m_state->VirtualTimers.erase(id) > 0)
+        {
+            m_simulator->cancel(id);
+        }
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_state->TimersMutex);
+    if (m_state->Timers.erase(id) > 0)
+    {
+        m_shard->removeTimer(id);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#ifndef _GENERAL_TIMER_SERVICE_H_
+#define _GENERAL_TIMER_SERVICE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Timer.h"
+
+class Configuration;
+class EventSimulator;
+
+// Timers partages par tout le processus : un fil de Timer par coeur plutot qu'un par LinkLayer.
+// Chaque proprietaire de timers (une LinkLayer) obtient un TimerHandle, associe a un des fils a tour de role.
+class TimerService
+{
+    std::vector<std::shared_ptr<Timer>> m_shards;
+    std::atomic<size_t> m_nextShard;
+
+    static std::mutex s_sharedMutex;
+    static std::unique_ptr<TimerService> s_shared;
+
+    TimerService& operator=(const TimerService&) = delete;
+    TimerService(const TimerService&) = delete;
+
+public:
+    // shardCount a 0 utilise un fil par coeur
+    TimerService(size_t shardCount, const Configuration& config);
+    ~TimerService();
+
+    size_t shardCount() const;
+    // Fil auquel associer le prochain proprietaire
+    std::shared_ptr<Timer> nextShard();
+
+    // Service utilise par defaut. Il est cree avec la configuration par defaut s'il n'a pas ete configure.
+    static TimerService& Shared();
+    // Doit etre appele avant la premiere utilisation de Shared()
+    static void ConfigureShared(const Configuration& config);
+};
+
+// Acces d'un proprietaire a un fil du TimerService, avec la meme interface que Timer.
+// Les fonctions des timers ne sont appelees que lorsque le proprietaire est demarre. Apres stop(), plus aucune fonction
+// n'est en cours ou ne sera appelee : le proprietaire peut etre detruit. Les timers ajoutes avant start() ne sont jamais signales.
+// Construit sur un EventSimulator, les timers sont des evenements en temps virtuel : aucun fil n'est utilise.
+// Seuls les timers ajoutes par ce TimerHandle peuvent etre redemarres ou retires : les autres numeros sont ignores.
+class TimerHandle
+{
+    // Timer en temps virtuel. Son numero est celui de son evenement dans l'EventSimulator.
+    struct VirtualTimer
+    {
+        std::function<void(size_t, NumberSequence)> Function;
+        NumberSequence NumberData;
+    };
+
+    // Partage avec les timers en attente, qui peuvent survivre au TimerHandle
+    struct OwnerState
+    {
+        std::mutex CallbackMutex; // Tenu pendant l'appel des fonctions du proprietaire
+        std::atomic<uint64_t> Epoch; // Impair lorsque le proprietaire est demarre. Augmente a chaque start() et stop().
+        std::mutex TimersMutex;
+        std::unordered_set<size_t> Timers; // Timers du proprietaire encore en attente dans le fil partage
+        std::unordered_map<size_t, VirtualTimer> VirtualTimers; // Utilise seulement avec un EventSimulator
+
+        OwnerState() : Epoch(0) {}
+    };
+
+    std::shared_ptr<Timer> m_shard; // nullptr avec un EventSimulator
+    EventSimulator* m_simulator;
+    std::shared_ptr<OwnerState> m_state;
+
+    TimerHandle& operator=(const TimerHandle&) = delete;
+    TimerHandle(const TimerHandle&) = delete;
+
+public:
+    TimerHandle(TimerService& service = TimerService::Shared());
+    TimerHandle(EventSimulator& simulator);
+    ~TimerHandle();
+
+    void start();
+    void stop();
+
+    size_t addTimer(std::chrono::milliseconds interval, std::function<void(size_t, NumberSequence)> function, NumberSequence numberData);
+    bool restartTimer(size_t timerID, NumberSequence numberData);
+    void removeTimer(size_t id);
+};
+
+#endif //_GENERAL_TIMER_SERVICE_H_
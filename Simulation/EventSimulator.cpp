@@ -0,0 +1,451 @@
+#include "EventSimulator.h"
+#include "../General/Configuration.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+constexpr uint64_t EventSimulator::InvalidEventID;
+constexpr uint32_t EventSimulator::NoNode;
+
+thread_local EventSimulator::Partition* EventSimulator::s_currentPartition = nullptr;
+thread_local uint32_t EventSimulator::s_currentNode = EventSimulator::NoNode;
+
+std::mutex EventSimulator::s_sharedMutex;
+std::unique_ptr<EventSimulator> EventSimulator::s_shared;
+std::atomic<EventSimulator*> EventSimulator::s_sharedPointer(nullptr);
+
+EventSimulator::NodeScope::NodeScope(EventSimulator& simulator, uint32_t node)
+    : m_previousPartition(s_currentPartition)
+    , m_previousNode(s_currentNode)
+{
+    s_currentPartition = simulator.m_partitions[simulator.partitionOf(node)].get();
+    s_currentNode = node;
+}
+
+EventSimulator::NodeScope::~NodeScope()
+{
+    s_currentPartition = m_previousPartition;
+    s_currentNode = m_previousNode;
+}
+
+//===========================================
+
+EventSimulator::Partition::Partition()
+    : Now(0)
+    , NextID(InvalidEventID + 1)
+    , ProcessedEventCount(0)
+    , UnownedSequence(0)
+{
+}
+
+EventSimulator::EventKey EventSimulator::Partition::nextKey(Time when, uint32_t origin)
+{
+    if (origin == NoNode)
+    {
+        return { when, origin, UnownedSequence++ };
+    }
+    if (origin >= NodeSequences.size())
+    {
+        NodeSequences.resize(origin + 1, 0);
+    }
+    return { when, origin, NodeSequences[origin]++ };
+}
+
+uint64_t EventSimulator::Partition::push(PendingEvent event)
+{
+    uint64_t id = NextID++;
+    Queue.push_back({ event.Key, id });
+    std::push_heap(Queue.begin(), Queue.end(), std::greater<ScheduledEvent>());
+    PendingEvents[id] = std::move(event);
+    return id;
+}
+
+void EventSimulator::Partition::drainInbox()
+{
+    std::lock_guard<std::mutex> lock(InboxMutex);
+    // Les autres partitions ont rempli la boite dans un ordre quelconque : les numeros sont attribues dans l'ordre des cles
+    std::sort(Inbox.begin(), Inbox.end(), [](const PendingEvent& a, const PendingEvent& b) { return b.Key > a.Key; });
+    for (PendingEvent& event : Inbox)
+    {
+        push(std::move(event));
+    }
+    Inbox.clear();
+}
+
+bool EventSimulator::Partition::peekNextTime(Time& when)
+{
+    while (!Queue.empty())
+    {
+        const ScheduledEvent& next = Queue.front();
+        auto it = PendingEvents.find(next.ID);
+        if (it != PendingEvents.end() && it->second.Key == next.Key)
+        {
+            when = next.Key.When;
+            return true;
+        }
+        std::pop_heap(Queue.begin(), Queue.end(), std::greater<ScheduledEvent>());
+        Queue.pop_back();
+    }
+    return false;
+}
+
+//===========================================
+
+EventSimulator::EventSimulator(size_t partitionCount, Time lookahead)
+    : m_lookahead(lookahead)
+    , m_stopped(false)
+    , m_windowGeneration(0)
+    , m_windowEnd(0)
+    , m_runningWorkers(0)
+    , m_shutdown(false)
+{
+    if (lookahead <= Time(0))
+    {
+        throw std::invalid_argument("La latence du concentrateur doit etre positive en simulation a evenements discrets.");
+    }
+    if (partitionCount == 0)
+    {
+        partitionCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < partitionCount; ++i)
+    {
+        m_partitions.push_back(std::make_unique<Partition>());
+    }
+}
+
+EventSimulator::~EventSimulator()
+{
+    stop();
+}
+
+size_t EventSimulator::partitionCount() const
+{
+    return m_partitions.size();
+}
+
+size_t EventSimulator::partitionOf(uint32_t node) const
+{
+    return (node == NoNode) ? 0 : node % m_partitions.size();
+}
+
+EventSimulator::Time EventSimulator::lookahead() const
+{
+    return m_lookahead;
+}
+
+EventSimulator::Time EventSimulator::now() const
+{
+    if (s_currentPartition)
+    {
+        return s_currentPartition->Now;
+    }
+    Time latest(0);
+    for (const std::unique_ptr<Partition>& partition : m_partitions)
+    {
+        latest = std::max(latest, partition->Now);
+    }
+    return latest;
+}
+
+uint64_t EventSimulator::processedEventCount() const
+{
+    uint64_t count = 0;
+    for (const std::unique_ptr<Partition>& partition : m_partitions)
+    {
+        count += partition->ProcessedEventCount;
+    }
+    return count;
+}
+
+EventSimulator::Partition& EventSimulator::currentPartition() const
+{
+    // Hors d'une partition et de tout noeud, par exemple au demarrage du concentrateur
+    return s_currentPartition ? *s_currentPartition : *m_partitions[0];
+}
+
+// Une tache n'existe dans le simulateur que sous forme d'evenement programme par submit : il n'y a rien a enregistrer
+void EventSimulator::registerTask(Task* /*task*/)
+{
+}
+
+void EventSimulator::unregisterTask(Task* /*task*/)
+{
+}
+
+void EventSimulator::submit(Task* task)
+{
+    if (m_stopped)
+    {
+        task->discard();
+        return;
+    }
+    Partition& partition = currentPartition();
+    PendingEvent event;
+    event.Key = partition.nextKey(partition.Now, s_currentNode);
+    event.Delay = Time(0);
+    event.Node = s_currentNode;
+    event.TaskToRun = task;
+    partition.push(std::move(event));
+}
+
+uint64_t EventSimulator::schedule(Time delay, Action action)
+{
+    if (delay < Time(0))
+    {
+        throw std::invalid_argument("Un evenement ne peut pas etre programme dans le passe.");
+    }
+    if (m_stopped)
+    {
+        return InvalidEventID;
+    }
+    Partition& partition = currentPartition();
+    PendingEvent event;
+    event.Key = partition.nextKey(partition.Now + delay, s_currentNode);
+    event.Delay = delay;
+    event.Node = s_currentNode;
+    event.TaskToRun = nullptr;
+    event.Function = std::move(action);
+    return partition.push(std::move(event));
+}
+
+uint64_t EventSimulator::scheduleOnPartition(size_t partitionIndex, Time delay, Action action)
+{
+    Partition& source = currentPartition();
+    Partition& target = *m_partitions.at(partitionIndex);
+    if (&source == &target)
+    {
+        return schedule(delay, std::move(action));
+    }
+    if (delay < m_lookahead)
+    {
+        throw std::logic_error("Un evenement ne peut pas etre programme dans une autre partition avant la fin de la fenetre courante.");
+    }
+    if (m_stopped)
+    {
+        return InvalidEventID;
+    }
+    PendingEvent event;
+    event.Key = source.nextKey(source.Now + delay, s_currentNode);
+    event.Delay = delay;
+    event.Node = s_currentNode;
+    event.TaskToRun = nullptr;
+    event.Function = std::move(action);
+    std::lock_guard<std::mutex> lock(target.InboxMutex);
+    target.Inbox.push_back(std::move(event));
+    return InvalidEventID;
+}
+
+bool EventSimulator::reschedule(uint64_t eventID)
+{
+    Partition& partition = currentPartition();
+    auto it = partition.PendingEvents.find(eventID);
+    if (it == partition.PendingEvents.end())
+    {
+        return false;
+    }
+    // L'ancienne entree reste dans le monceau mais sa cle n'est plus la bonne
+    PendingEvent& event = it->second;
+    event.Key = partition.nextKey(partition.Now + event.Delay, s_currentNode);
+    partition.Queue.push_back({ event.Key, eventID });
+    std::push_heap(partition.Queue.begin(), partition.Queue.end(), std::greater<ScheduledEvent>());
+    return true;
+}
+
+void EventSimulator::cancel(uint64_t eventID)
+{
+    Partition& partition = currentPartition();
+    auto it = partition.PendingEvents.find(eventID);
+    // Une tache programmee doit s'executer pour redevenir Idle : son evenement n'est jamais annule
+    if (it != partition.PendingEvents.end() && !it->second.TaskToRun)
+    {
+        partition.PendingEvents.erase(it);
+    }
+}
+
+void EventSimulator::runWindow(size_t partitionIndex, Time end)
+{
+    Partition& partition = *m_partitions[partitionIndex];
+    Partition* previousPartition = s_currentPartition;
+    uint32_t previousNode = s_currentNode;
+    s_currentPartition = &partition;
+
+    Time when;
+    while (partition.peekNextTime(when) && when < end)
+    {
+        std::pop_heap(partition.Queue.begin(), partition.Queue.end(), std::greater<ScheduledEvent>());
+        uint64_t id = partition.Queue.back().ID;
+        partition.Queue.pop_back();
+
+        auto it = partition.PendingEvents.find(id);
+        PendingEvent event = std::move(it->second);
+        partition.PendingEvents.erase(it);
+
+        partition.Now = when;
+        ++partition.ProcessedEventCount;
+        s_currentNode = event.Node;
+        if (event.TaskToRun)
+        {
+            event.TaskToRun->run();
+        }
+        else
+        {
+            event.Function();
+        }
+    }
+
+    s_currentPartition = previousPartition;
+    s_currentNode = previousNode;
+}
+
+void EventSimulator::work(size_t partitionIndex)
+{
+    uint64_t lastGeneration = 0;
+    while (true)
+    {
+        Time end;
+        {
+            std::unique_lock<std::mutex> lock(m_windowMutex);
+            m_windowStarted.wait(lock, [this, lastGeneration]() { return m_shutdown || m_windowGeneration != lastGeneration; });
+            if (m_shutdown)
+            {
+                return;
+            }
+            lastGeneration = m_windowGeneration;
+            end = m_windowEnd;
+        }
+
+        runWindow(partitionIndex, end);
+
+        std::lock_guard<std::mutex> lock(m_windowMutex);
+        if (--m_runningWorkers == 0)
+        {
+            m_windowFinished.notify_one();
+        }
+    }
+}
+
+bool EventSimulator::run(const std::function<bool()>& done)
+{
+    // La partition 0 est executee par ce fil, les autres par leurs propres fils crees a la premiere execution
+    if (m_workers.empty())
+    {
+        for (size_t i = 1; i < m_partitions.size(); ++i)
+        {
+            m_workers.emplace_back(&EventSimulator::work, this, i);
+        }
+    }
+
+    while (!m_stopped)
+    {
+        // Entre deux fenetres, seul ce fil touche aux partitions
+        if (done())
+        {
+            return true;
+        }
+        bool pending = false;
+        Time start = Time::max();
+        for (std::unique_ptr<Partition>& partition : m_partitions)
+        {
+            partition->drainInbox();
+            Time when;
+            if (partition->peekNextTime(when))
+            {
+                pending = true;
+                start = std::min(start, when);
+            }
+        }
+        if (!pending)
+        {
+            return false;
+        }
+
+        // Aucun evenement de la fenetre ne peut en programmer un autre dans une autre partition avant end
+        Time end = start + m_lookahead;
+        {
+            std::lock_guard<std::mutex> lock(m_windowMutex);
+            m_windowEnd = end;
+            m_runningWorkers = m_workers.size();
+            ++m_windowGeneration;
+        }
+        m_windowStarted.notify_all();
+        runWindow(0, end);
+        std::unique_lock<std::mutex> lock(m_windowMutex);
+        m_windowFinished.wait(lock, [this]() { return m_runningWorkers == 0; });
+    }
+    return done();
+}
+
+void EventSimulator::stop()
+{
+    m_stopped = true;
+    {
+        std::lock_guard<std::mutex> lock(m_windowMutex);
+        m_shutdown = true;
+    }
+    m_windowStarted.notify_all();
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+    m_workers.clear();
+
+    for (std::unique_ptr<Partition>& partition : m_partitions)
+    {
+        for (auto& entry : partition->PendingEvents)
+        {
+            if (entry.second.TaskToRun)
+            {
+                entry.second.TaskToRun->discard();
+            }
+        }
+        partition->PendingEvents.clear();
+        partition->Queue.clear();
+        std::lock_guard<std::mutex> lock(partition->InboxMutex);
+        partition->Inbox.clear();
+    }
+}
+
+EventSimulator& EventSimulator::Shared()
+{
+    EventSimulator* shared = SharedIfEnabled();
+    if (shared)
+    {
+        return *shared;
+    }
+    std::lock_guard<std::mutex> lock(s_sharedMutex);
+    if (!s_shared)
+    {
+        Configuration defaultConfig;
+        s_shared = std::make_unique<EventSimulator>(defaultConfig.get(Configuration::DISCRETE_EVENT_SIMULATION_THREAD_COUNT),
+                                                    std::chrono::microseconds(defaultConfig.get(Configuration::TRANSMISSION_HUB_LATENCY)));
+        SetActive(s_shared.get());
+        s_sharedPointer.store(s_shared.get(), std::memory_order_release);
+    }
+    return *s_shared;
+}
+
+bool EventSimulator::Enabled()
+{
+    return SharedIfEnabled() != nullptr;
+}
+
+EventSimulator* EventSimulator::SharedIfEnabled()
+{
+    return s_sharedPointer.load(std::memory_order_acquire);
+}
+
+void EventSimulator::ConfigureShared(const Configuration& config)
+{
+    std::lock_guard<std::mutex> lock(s_sharedMutex);
+    if (s_shared)
+    {
+        throw std::logic_error("La simulation a evenements discrets est deja utilisee, elle ne peut plus etre configuree.");
+    }
+    if (config.get(Configuration::DISCRETE_EVENT_SIMULATION_ENABLED) != 0)
+    {
+        s_shared = std::make_unique<EventSimulator>(config.get(Configuration::DISCRETE_EVENT_SIMULATION_THREAD_COUNT),
+                                                    std::chrono::microseconds(config.get(Configuration::TRANSMISSION_HUB_LATENCY)));
+        SetActive(s_shared.get());
+        s_sharedPointer.store(s_shared.get(), std::memory_order_release);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,206 @@
+#ifndef _SIMULATION_EVENT_SIMULATOR_H_
+#define _SIMULATION_EVENT_SIMULATOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../DataStructures/FlatHashMap.h"
+#include "../General/Executor.h"
+
+class Configuration;
+
+// Simulation a evenements discrets : une horloge virtuelle et des files d'evenements ordonnes par instant.
+// L'horloge saute directement a l'instant du prochain evenement. Les taches des couches sont des evenements a l'instant courant,
+// les timers et la livraison par le concentrateur des evenements futurs.
+//
+// Les noeuds (les ports du concentrateur, dans l'ordre de connexion) sont repartis entre des partitions, chacune avec sa propre
+// file d'evenements et son propre fil d'execution. La synchronisation est conservatrice : toutes les partitions executent les
+// evenements d'une fenetre [T, T + lookahead[, ou T est le plus petit instant en attente, puis s'attendent. Une partition ne peut
+// programmer un evenement chez une autre qu'au moins lookahead plus tard (la latence du concentrateur) : il tombe toujours dans
+// une fenetre suivante. Ces evenements passent par la boite de reception de la partition destinataire, videe entre deux fenetres.
+//
+// Les evenements d'un meme instant sont ordonnes par le noeud qui les a programmes, puis par un compteur propre a ce noeud.
+// Cet ordre ne depend pas de la repartition : a configuration egale, le resultat est le meme quel que soit le nombre de partitions.
+class EventSimulator : public TaskScheduler
+{
+public:
+    using Time = std::chrono::nanoseconds; // Depuis le debut de la simulation
+    using Action = std::function<void()>;
+
+    // Jamais retourne par schedule()
+    static constexpr uint64_t InvalidEventID = 0;
+    // Contexte du fil principal avant le demarrage des noeuds
+    static constexpr uint32_t NoNode = std::numeric_limits<uint32_t>::max();
+
+private:
+    struct Partition;
+
+public:
+    // Execute le code qui suit dans le contexte du noeud : les evenements programmes lui appartiennent
+    // et vont dans la file de sa partition. Utilise au demarrage des ordinateurs et pour livrer les trames.
+    class NodeScope
+    {
+        Partition* m_previousPartition;
+        uint32_t m_previousNode;
+
+        NodeScope& operator=(const NodeScope&) = delete;
+        NodeScope(const NodeScope&) = delete;
+
+    public:
+        NodeScope(EventSimulator& simulator, uint32_t node);
+        ~NodeScope();
+    };
+
+private:
+    // Cle d'ordre d'un evenement
+    struct EventKey
+    {
+        Time When;
+        uint32_t Origin; // Noeud qui a programme l'evenement
+        uint64_t OriginSequence; // Compteur du noeud d'origine : departage les evenements d'un meme instant
+
+        bool operator>(const EventKey& other) const
+        {
+            if (When != other.When)
+            {
+                return When > other.When;
+            }
+            if (Origin != other.Origin)
+            {
+                return Origin > other.Origin;
+            }
+            return OriginSequence > other.OriginSequence;
+        }
+
+        bool operator==(const EventKey& other) const
+        {
+            return When == other.When && Origin == other.Origin && OriginSequence == other.OriginSequence;
+        }
+    };
+
+    // Entree du monceau. Une entree dont la cle ne correspond plus a celle de l'evenement est perimee :
+    // l'evenement a ete annule ou reprogramme, elle est ignoree a sa sortie du monceau.
+    struct ScheduledEvent
+    {
+        EventKey Key;
+        uint64_t ID;
+
+        // Permet de construire le monceau avec le plus petit instant au debut
+        bool operator>(const ScheduledEvent& other) const { return Key > other.Key; }
+    };
+
+    struct PendingEvent
+    {
+        EventKey Key;
+        Time Delay; // Pour reschedule()
+        uint32_t Node; // Contexte d'execution
+        Task* TaskToRun; // nullptr pour une action
+        Action Function;
+    };
+
+    // File d'evenements d'une partition. Seul le fil de la partition y touche pendant une fenetre,
+    // sauf la boite de reception, protegee par son mutex.
+    struct Partition
+    {
+        Time Now;
+        uint64_t NextID;
+        uint64_t ProcessedEventCount;
+        std::vector<ScheduledEvent> Queue;
+        FlatHashMap<uint64_t, PendingEvent> PendingEvents;
+        std::vector<uint64_t> NodeSequences; // Compteur de chaque noeud, seuls ceux de la partition sont utilises
+        uint64_t UnownedSequence; // Compteur des evenements programmes hors de tout noeud
+
+        std::mutex InboxMutex;
+        std::vector<PendingEvent> Inbox; // Evenements programmes par les autres partitions
+
+        Partition();
+        EventKey nextKey(Time when, uint32_t origin);
+        uint64_t push(PendingEvent event);
+        void drainInbox();
+        // Retire les entrees perimees du sommet. Retourne faux s'il n'y a plus d'evenement.
+        bool peekNextTime(Time& when);
+    };
+
+    std::vector<std::unique_ptr<Partition>> m_partitions;
+    Time m_lookahead;
+    bool m_stopped; // Apres stop(), plus aucun evenement n'est garde
+
+    // Fils des partitions 1 a n - 1. La partition 0 est executee par le fil qui appelle run().
+    std::vector<std::thread> m_workers;
+    std::mutex m_windowMutex;
+    std::condition_variable m_windowStarted;
+    std::condition_variable m_windowFinished;
+    uint64_t m_windowGeneration; // Augmente a chaque fenetre
+    Time m_windowEnd;
+    size_t m_runningWorkers; // Fils qui n'ont pas fini la fenetre courante
+    bool m_shutdown;
+
+    static thread_local Partition* s_currentPartition;
+    static thread_local uint32_t s_currentNode;
+
+    static std::mutex s_sharedMutex;
+    static std::unique_ptr<EventSimulator> s_shared;
+    static std::atomic<EventSimulator*> s_sharedPointer; // s_shared une fois creee, lue sans prendre s_sharedMutex
+
+    EventSimulator& operator=(const EventSimulator&) = delete;
+    EventSimulator(const EventSimulator&) = delete;
+
+    void registerTask(Task* task) override;
+    void unregisterTask(Task* task) override;
+    // La tache est executee a l'instant courant dans la partition courante
+    void submit(Task* task) override;
+
+    Partition& currentPartition() const;
+    void work(size_t partitionIndex);
+    // Execute dans l'ordre les evenements de la partition anterieurs a end
+    void runWindow(size_t partitionIndex, Time end);
+
+public:
+    // partitionCount a 0 utilise une partition par coeur. lookahead doit etre positif.
+    EventSimulator(size_t partitionCount, Time lookahead);
+    ~EventSimulator() override;
+
+    size_t partitionCount() const;
+    size_t partitionOf(uint32_t node) const;
+    Time lookahead() const;
+
+    // Instant courant de la partition courante. Hors d'une partition, le dernier instant atteint par la simulation.
+    Time now() const;
+    uint64_t processedEventCount() const;
+
+    // Programme action a l'instant now() + delay dans la partition courante. Retourne le numero de l'evenement.
+    uint64_t schedule(Time delay, Action action);
+    // Programme action dans la partition donnee. Si ce n'est pas la partition courante, delay doit etre d'au moins lookahead()
+    // et l'evenement ne peut pas etre annule : InvalidEventID est retourne.
+    uint64_t scheduleOnPartition(size_t partition, Time delay, Action action);
+    // Reporte l'evenement a now() plus son delai initial. Retourne faux s'il a deja ete execute ou annule.
+    bool reschedule(uint64_t eventID);
+    // Annule une action programmee. Les evenements des taches sont ignores : une tache doit s'executer pour redevenir Idle.
+    void cancel(uint64_t eventID);
+
+    // Execute les evenements par fenetres jusqu'a ce que done retourne vrai ou qu'il n'y ait plus d'evenement.
+    // done est appele entre deux fenetres, lorsque toutes les partitions sont arretees. Retourne le dernier resultat de done.
+    bool run(const std::function<bool()>& done);
+    // Termine la simulation : les evenements restants et ceux programmes ensuite sont abandonnes, pour que les taches
+    // reprogrammees pendant l'arret des ordinateurs ne soient jamais attendues
+    void stop();
+
+    // Simulation utilisee par les couches. Si elle n'a pas ete activee par la configuration, elle l'est a la premiere utilisation.
+    static EventSimulator& Shared();
+    // Indique si les couches, les timers et le concentrateur doivent utiliser Shared() plutot que des fils d'execution
+    static bool Enabled();
+    // Shared() si la simulation est activee, nullptr sinon. Sans verrou, pour les horloges lues a chaque mesure.
+    static EventSimulator* SharedIfEnabled();
+    // Doit etre appele avant la creation des ordinateurs. Si la simulation est activee, elle devient le TaskScheduler::Active().
+    static void ConfigureShared(const Configuration& config);
+};
+
+#endif //_SIMULATION_EVENT_SIMULATOR_H_
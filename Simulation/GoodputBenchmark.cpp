@@ -0,0 +1,163 @@
+#include "GoodputBenchmark.h"
+
+#include <algorithm>
+
+#include "../Computer/Driver/Layer/LinkLayer.h"
+#include "../General/Executor.h"
+#include "EventSimulator.h"
+
+namespace
+{
+    double ToMilliseconds(std::chrono::nanoseconds time)
+    {
+        return std::chrono::duration<double, std::milli>(time).count();
+    }
+
+    // Rang le plus proche : la plus petite valeur dont au moins percent % des valeurs sont inferieures ou egales
+    std::chrono::nanoseconds Percentile(const std::vector<std::chrono::nanoseconds>& sorted, double percent)
+    {
+        size_t rank = (size_t)(percent / 100.0 * sorted.size() + 0.999999);
+        return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+    }
+}
+
+GoodputBenchmark::GoodputBenchmark(const std::vector<std::unique_ptr<Computer>>& computers)
+    : m_computers(computers)
+    , m_wallStart(std::chrono::steady_clock::now())
+    , m_cpuStart(std::clock())
+    , m_elapsed(0)
+    , m_wallSeconds(0.0)
+    , m_cpuSeconds(0.0)
+    , m_completed(false)
+    , m_sentFrameCount(0)
+    , m_retransmissionCount(0)
+    , m_startedFileCount(0)
+    , m_receivedFileCount(0)
+    , m_deliveredBytes(0)
+{
+    for (const std::unique_ptr<Computer>& computer : m_computers)
+    {
+        computer->getNetworkInterfaceCard().getDriver().getNetworkLayer().setFileTransferObserver(this);
+    }
+}
+
+GoodputBenchmark::~GoodputBenchmark()
+{
+    for (const std::unique_ptr<Computer>& computer : m_computers)
+    {
+        computer->getNetworkInterfaceCard().getDriver().getNetworkLayer().setFileTransferObserver(nullptr);
+    }
+}
+
+GoodputBenchmark::Time GoodputBenchmark::now() const
+{
+    EventSimulator* simulator = EventSimulator::SharedIfEnabled();
+    if (simulator)
+    {
+        return simulator->now();
+    }
+    return std::chrono::duration_cast<Time>(std::chrono::steady_clock::now() - m_wallStart);
+}
+
+void GoodputBenchmark::start()
+{
+    m_wallStart = std::chrono::steady_clock::now();
+    m_cpuStart = std::clock();
+}
+
+void GoodputBenchmark::finish(bool completed)
+{
+    m_completed = completed;
+    m_elapsed = now();
+    m_wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_wallStart).count();
+    // Temps processeur de tout le processus, tous fils confondus
+    m_cpuSeconds = double(std::clock() - m_cpuStart) / CLOCKS_PER_SEC;
+
+    m_sentFrameCount = 0;
+    m_retransmissionCount = 0;
+    for (const std::unique_ptr<Computer>& computer : m_computers)
+    {
+        LinkLayer& link = computer->getNetworkInterfaceCard().getDriver().getLinkLayer();
+        m_sentFrameCount += link.sentFrameCount();
+        m_retransmissionCount += link.retransmissionCount();
+    }
+}
+
+void GoodputBenchmark::sendingStarted(const MACAddress& /*source*/, const MACAddress& /*destination*/, const std::string& /*fileName*/, uint64_t /*fileSize*/)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_startedFileCount;
+}
+
+void GoodputBenchmark::fileReceived(const MACAddress& /*source*/, const MACAddress& /*destination*/, const std::string& /*fileName*/, uint64_t fileSize, std::chrono::nanoseconds transferTime)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_receivedFileCount;
+    m_deliveredBytes += fileSize;
+    m_completionTimes.push_back(transferTime);
+}
+
+void GoodputBenchmark::writeJson(std::ostream& out, const Configuration& globalConfig) const
+{
+    bool simulated = EventSimulator::Enabled();
+    const char* mode = simulated ? "discrete_event" : (TaskScheduler::Active() ? "executor" : "threads");
+    double elapsedSeconds = std::chrono::duration<double>(m_elapsed).count();
+
+    std::vector<Time> completionTimes = m_completionTimes;
+    std::sort(completionTimes.begin(), completionTimes.end());
+
+    out << "{\n";
+    out << "  \"mode\": \"" << mode << "\",\n";
+    out << "  \"time_base\": \"" << (simulated ? "simulated" : "wall") << "\",\n";
+    out << "  \"nodes\": " << m_computers.size() << ",\n";
+    out << "  \"completed\": " << (m_completed ? "true" : "false") << ",\n";
+
+    out << "  \"configuration\": {\n";
+    if (!m_computers.empty())
+    {
+        const Configuration& config = m_computers.front()->getConfiguration();
+        for (const std::string* name : { &Configuration::NETWORK_LAYER_DATA_SIZE, &Configuration::LINK_LAYER_MAXIMUM_BUFFERED_FRAME,
+                                         &Configuration::LINK_LAYER_TIMEOUT, &Configuration::PHYSICAL_LAYER_DATA_ENCODER_DECODER })
+        {
+            out << "    \"" << *name << "\": " << config.get(*name) << ",\n";
+        }
+    }
+    for (const std::string* name : { &Configuration::TRANSMISSION_HUB_NOISE, &Configuration::TRANSMISSION_HUB_NOISE_FREQUENCY,
+                                     &Configuration::TRANSMISSION_HUB_NOISE_BYTE_ERROR_FREQUENCY, &Configuration::TRANSMISSION_HUB_NOISE_SEED,
+                                     &Configuration::TRANSMISSION_HUB_LATENCY, &Configuration::EXECUTOR_ENABLED })
+    {
+        out << "    \"" << *name << "\": " << globalConfig.get(*name) << ",\n";
+    }
+    out << "    \"" << Configuration::DISCRETE_EVENT_SIMULATION_ENABLED << "\": " << globalConfig.get(Configuration::DISCRETE_EVENT_SIMULATION_ENABLED) << "\n";
+    out << "  },\n";
+
+    out << "  \"files_started\": " << m_startedFileCount << ",\n";
+    out << "  \"files_received\": " << m_receivedFileCount << ",\n";
+    out << "  \"bytes_delivered\": " << m_deliveredBytes << ",\n";
+    out << "  \"elapsed_seconds\": " << elapsedSeconds << ",\n";
+    out << "  \"wall_seconds\": " << m_wallSeconds << ",\n";
+    out << "  \"cpu_seconds\": " << m_cpuSeconds << ",\n";
+    out << "  \"goodput_bytes_per_second\": " << (elapsedSeconds > 0.0 ? m_deliveredBytes / elapsedSeconds : 0.0) << ",\n";
+    out << "  \"frames_sent\": " << m_sentFrameCount << ",\n";
+    out << "  \"retransmissions\": " << m_retransmissionCount << ",\n";
+    out << "  \"retransmission_ratio\": " << (m_sentFrameCount > 0 ? double(m_retransmissionCount) / m_sentFrameCount : 0.0) << ",\n";
+
+    out << "  \"completion_time_ms\": {\n";
+    out << "    \"count\": " << completionTimes.size();
+    if (!completionTimes.empty())
+    {
+        Time total(0);
+        for (Time time : completionTimes)
+        {
+            total += time;
+        }
+        out << ",\n";
+        out << "    \"mean\": " << ToMilliseconds(total / completionTimes.size()) << ",\n";
+        out << "    \"p50\": " << ToMilliseconds(Percentile(completionTimes, 50.0)) << ",\n";
+        out << "    \"p90\": " << ToMilliseconds(Percentile(completionTimes, 90.0)) << ",\n";
+        out << "    \"p99\": " << ToMilliseconds(Percentile(completionTimes, 99.0)) << ",\n";
+        out << "    \"max\": " << ToMilliseconds(completionTimes.back());
+    }
+    out << "\n  }\n";
+    out << "}\n";
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#ifndef _SIMULATION_GOODPUT_BENCHMARK_H_
+#define _SIMULATION_GOODPUT_BENCHMARK_H_
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "../Computer/Computer.h"
+#include "../Computer/Driver/Layer/NetworkLayer.h"
+#include "../General/Configuration.h"
+
+// Mesure de bout en bout d'une simulation, ecrite en JSON a la fin (voir l'option -b du simulateur).
+// Le temps de transfert d'un fichier va du debut de son envoi par la couche reseau de la source a la reception de son dernier octet :
+// la couche reseau le mesure avec l'instant de debut transmis dans l'en-tete du fichier.
+// En simulation a evenements discrets, les temps et le debit sont en temps simule, sinon en temps reel.
+class GoodputBenchmark : public FileTransferObserver
+{
+    using Time = std::chrono::nanoseconds;
+
+    const std::vector<std::unique_ptr<Computer>>& m_computers;
+
+    std::chrono::steady_clock::time_point m_wallStart;
+    std::clock_t m_cpuStart;
+    Time m_elapsed;
+    double m_wallSeconds;
+    double m_cpuSeconds;
+    bool m_completed; // Faux si la simulation a ete arretee avant la reception de tous les fichiers
+    uint64_t m_sentFrameCount;
+    uint64_t m_retransmissionCount;
+
+    // Modifies par les boucles des couches de tous les ordinateurs
+    std::mutex m_mutex;
+    std::vector<Time> m_completionTimes;
+    uint64_t m_startedFileCount;
+    uint64_t m_receivedFileCount;
+    uint64_t m_deliveredBytes;
+
+    GoodputBenchmark& operator=(const GoodputBenchmark&) = delete;
+    GoodputBenchmark(const GoodputBenchmark&) = delete;
+
+    Time now() const;
+
+public:
+    // S'enregistre comme observateur de la couche reseau de chaque ordinateur, qui ne doivent pas encore etre demarres
+    GoodputBenchmark(const std::vector<std::unique_ptr<Computer>>& computers);
+    ~GoodputBenchmark() override;
+
+    // Juste avant le demarrage des ordinateurs
+    void start();
+    // A la fin de la simulation, avant l'arret des ordinateurs. completed est faux si des fichiers n'ont pas ete recus.
+    void finish(bool completed);
+
+    void sendingStarted(const MACAddress& source, const MACAddress& destination, const std::string& fileName, uint64_t fileSize) override;
+    void fileReceived(const MACAddress& source, const MACAddress& destination, const std::string& fileName, uint64_t fileSize, std::chrono::nanoseconds transferTime) override;
+
+    // Les parametres des ordinateurs sont ceux du premier ordinateur
+    void writeJson(std::ostream& out, const Configuration& globalConfig) const;
+};
+
+#endif //_SIMULATION_GOODPUT_BENCHMARK_H_
@@ -0,0 +1,493 @@
+#include "Scenario.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+
+namespace
+{
+    using Assignment = std::pair<std::string, int>;
+
+    // Valeurs propres a un ordinateur, appliquees par-dessus la configuration par defaut une fois tout le fichier lu
+    struct NodeOverrides
+    {
+        std::vector<Assignment> Parameters;
+        bool HasAddress = false;
+        MACAddress Address;
+    };
+
+    struct PendingTransfer
+    {
+        size_t Source;
+        std::string FileName;
+        std::string Destination;
+        size_t Line;
+    };
+
+    enum class WorkloadPattern
+    {
+        Pairwise,
+        AllToOne,
+        OneToAll,
+    };
+
+    // Taille des fichiers synthetiques, toujours d'au moins 1 octet (une taille nulle designe un fichier sur le disque)
+    struct SizeDistribution
+    {
+        enum Kind
+        {
+            Fixed,
+            Uniform,
+            Exponential,
+        };
+
+        Kind Type = Fixed;
+        uint64_t First = 100000; // Taille fixe, minimum ou moyenne
+        uint64_t Second = 0; // Maximum de la distribution uniforme
+
+        uint64_t sample(std::mt19937& random) const
+        {
+            uint64_t size = First;
+            if (Type == Uniform)
+            {
+                size = std::uniform_int_distribution<uint64_t>(First, Second)(random);
+            }
+            else if (Type == Exponential)
+            {
+                size = (uint64_t)std::exponential_distribution<double>(1.0 / (double)First)(random);
+            }
+            return std::max<uint64_t>(1, size);
+        }
+    };
+
+    struct PendingWorkload
+    {
+        WorkloadPattern Pattern;
+        size_t FilesPerPair = 1;
+        SizeDistribution Size;
+        uint32_t Seed = 1;
+        size_t Line;
+    };
+
+    const std::string* const MACAddressParameters[6] = {
+        &Configuration::MAC_ADDRESS_BYTE_1, &Configuration::MAC_ADDRESS_BYTE_2, &Configuration::MAC_ADDRESS_BYTE_3,
+        &Configuration::MAC_ADDRESS_BYTE_4, &Configuration::MAC_ADDRESS_BYTE_5, &Configuration::MAC_ADDRESS_BYTE_6
+    };
+
+    bool isNumber(const std::string& text)
+    {
+        return !text.empty() && std::all_of(text.begin(), text.end(), [](char c) { return std::isdigit((unsigned char)c) != 0; });
+    }
+}
+
+Scenario::Scenario(const Configuration& globalConfiguration)
+    : m_globalConfiguration(globalConfiguration)
+{
+}
+
+Scenario Scenario::Load(const std::string& fileName, const Configuration& globalConfiguration)
+{
+    std::ifstream file(fileName);
+    if (!file.is_open())
+    {
+        throw std::invalid_argument("Impossible d'ouvrir le scenario " + fileName + ".");
+    }
+
+    Scenario scenario(globalConfiguration);
+    Configuration defaults;
+    Configuration validation; // Sert seulement a verifier le nom des parametres des ordinateurs des leur lecture
+    std::map<size_t, NodeOverrides> nodes;
+    std::vector<PendingTransfer> transfers;
+    std::vector<PendingWorkload> workloads;
+
+    size_t lineNumber = 0;
+    auto fail = [&fileName, &lineNumber](const std::string& message)
+    {
+        throw std::invalid_argument(fileName + ":" + std::to_string(lineNumber) + " : " + message);
+    };
+    auto parseNumber = [&fail](const std::string& text)
+    {
+        if (!isNumber(text))
+        {
+            fail("'" + text + "' n'est pas un numero d'ordinateur.");
+        }
+        size_t number = std::stoul(text);
+        if (number == 0)
+        {
+            fail("Les numeros d'ordinateur commencent a 1.");
+        }
+        return number;
+    };
+    auto parseValue = [&fail](const std::string& text, const std::string& what)
+    {
+        if (!isNumber(text))
+        {
+            fail("'" + text + "' n'est pas " + what + ".");
+        }
+        return (uint64_t)std::stoull(text);
+    };
+    auto parseAssignment = [&fail](const std::string& text, Configuration& config)
+    {
+        size_t pos = text.find('=');
+        if (pos == std::string::npos)
+        {
+            fail("'" + text + "' n'est pas de la forme Parametre=valeur.");
+        }
+        Assignment assignment(text.substr(0, pos), 0);
+        try
+        {
+            assignment.second = std::stoi(text.substr(pos + 1), nullptr, 0);
+            config.set(assignment.first, assignment.second);
+        }
+        catch (const std::exception& e)
+        {
+            fail("'" + text + "' : " + e.what());
+        }
+        return assignment;
+    };
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+        std::istringstream tokens(line);
+        std::string command;
+        if (!(tokens >> command) || command[0] == '#')
+        {
+            continue;
+        }
+
+        std::string token;
+        if (command == "global")
+        {
+            while (tokens >> token)
+            {
+                parseAssignment(token, scenario.m_globalConfiguration);
+            }
+        }
+        else if (command == "default")
+        {
+            while (tokens >> token)
+            {
+                parseAssignment(token, defaults);
+            }
+        }
+        else if (command == "nodes")
+        {
+            tokens >> token;
+            size_t pos = token.find('-');
+            if (pos == std::string::npos)
+            {
+                fail("'nodes' doit etre suivi d'un intervalle premier-dernier.");
+            }
+            size_t first = parseNumber(token.substr(0, pos));
+            size_t last = parseNumber(token.substr(pos + 1));
+            if (last < first)
+            {
+                fail("L'intervalle " + token + " est vide.");
+            }
+            for (size_t id = first; id <= last; ++id)
+            {
+                nodes[id];
+            }
+        }
+        else if (command == "node")
+        {
+            tokens >> token;
+            NodeOverrides& node = nodes[parseNumber(token)];
+            while (tokens >> token)
+            {
+                if (token.compare(0, 4, "mac=") == 0)
+                {
+                    try
+                    {
+                        node.Address = MACAddress::FromString(token.substr(4));
+                    }
+                    catch (const std::exception& e)
+                    {
+                        fail(e.what());
+                    }
+                    node.HasAddress = true;
+                }
+                else
+                {
+                    node.Parameters.push_back(parseAssignment(token, validation));
+                }
+            }
+        }
+        else if (command == "transfer")
+        {
+            PendingTransfer transfer;
+            std::string source;
+            if (!(tokens >> source >> transfer.FileName >> transfer.Destination))
+            {
+                fail("'transfer' doit etre suivi du numero de l'ordinateur, du fichier et de la destination.");
+            }
+            transfer.Source = parseNumber(source);
+            transfer.Line = lineNumber;
+            transfers.push_back(transfer);
+        }
+        else if (command == "workload")
+        {
+            PendingWorkload workload;
+            workload.Line = lineNumber;
+            tokens >> token;
+            if (token == "pairwise")
+            {
+                workload.Pattern = WorkloadPattern::Pairwise;
+            }
+            else if (token == "all-to-one")
+            {
+                workload.Pattern = WorkloadPattern::AllToOne;
+            }
+            else if (token == "one-to-all")
+            {
+                workload.Pattern = WorkloadPattern::OneToAll;
+            }
+            else
+            {
+                fail("'workload' doit etre suivi de pairwise, all-to-one ou one-to-all.");
+            }
+
+            while (tokens >> token)
+            {
+                if (token.compare(0, 6, "files=") == 0)
+                {
+                    workload.FilesPerPair = (size_t)parseValue(token.substr(6), "un nombre de fichiers");
+                }
+                else if (token.compare(0, 5, "seed=") == 0)
+                {
+                    workload.Seed = (uint32_t)parseValue(token.substr(5), "une graine");
+                }
+                else if (token.compare(0, 13, "size=uniform:") == 0)
+                {
+                    std::string range = token.substr(13);
+                    size_t pos = range.find('-');
+                    if (pos == std::string::npos)
+                    {
+                        fail("La distribution uniforme doit etre de la forme uniform:<min>-<max>.");
+                    }
+                    workload.Size.Type = SizeDistribution::Uniform;
+                    workload.Size.First = parseValue(range.substr(0, pos), "une taille");
+                    workload.Size.Second = parseValue(range.substr(pos + 1), "une taille");
+                    if (workload.Size.Second < workload.Size.First)
+                    {
+                        fail("L'intervalle de tailles " + range + " est vide.");
+                    }
+                }
+                else if (token.compare(0, 17, "size=exponential:") == 0)
+                {
+                    workload.Size.Type = SizeDistribution::Exponential;
+                    workload.Size.First = parseValue(token.substr(17), "une taille moyenne");
+                    if (workload.Size.First == 0)
+                    {
+                        fail("La taille moyenne doit etre positive.");
+                    }
+                }
+                else if (token.compare(0, 5, "size=") == 0)
+                {
+                    workload.Size.Type = SizeDistribution::Fixed;
+                    workload.Size.First = parseValue(token.substr(5), "une taille");
+                }
+                else
+                {
+                    fail("Option de workload inconnue : " + token);
+                }
+            }
+            defaults.set(Configuration::NETWORK_LAYER_SAVE_RECEIVED_FILES, 0);
+            workloads.push_back(workload);
+        }
+        else
+        {
+            fail("Instruction inconnue : " + command);
+        }
+    }
+
+    // Configuration et adresse finales de chaque ordinateur
+    std::map<size_t, size_t> indexByID;
+    std::unordered_set<MACAddress> addresses;
+    scenario.m_nodes.reserve(nodes.size());
+    for (const auto& entry : nodes)
+    {
+        Node node{ entry.first, defaults, {} };
+        for (const Assignment& parameter : entry.second.Parameters)
+        {
+            node.Config.set(parameter.first, parameter.second);
+        }
+
+        uint64_t address = entry.second.HasAddress ? entry.second.Address.value() : MACAddress(node.Config).value() + node.ID - 1;
+        for (size_t i = 0; i < 6; ++i)
+        {
+            node.Config.set(*MACAddressParameters[i], (int)((address >> (8 * (5 - i))) & 0xFF));
+        }
+        if (!addresses.insert(MACAddress::FromValue(address)).second)
+        {
+            throw std::invalid_argument(fileName + " : l'adresse " + MACAddress::FromValue(address).toString() + " de l'ordinateur " + std::to_string(node.ID) + " est deja utilisee.");
+        }
+
+        indexByID[node.ID] = scenario.m_nodes.size();
+        scenario.m_nodes.push_back(std::move(node));
+    }
+
+    for (const PendingTransfer& transfer : transfers)
+    {
+        lineNumber = transfer.Line;
+        auto source = indexByID.find(transfer.Source);
+        if (source == indexByID.end())
+        {
+            fail("L'ordinateur " + std::to_string(transfer.Source) + " n'est pas declare.");
+        }
+
+        MACAddress destination;
+        if (isNumber(transfer.Destination))
+        {
+            auto target = indexByID.find(parseNumber(transfer.Destination));
+            if (target == indexByID.end())
+            {
+                fail("L'ordinateur de destination " + transfer.Destination + " n'est pas declare.");
+            }
+            destination = MACAddress(scenario.m_nodes[target->second].Config);
+        }
+        else
+        {
+            try
+            {
+                destination = MACAddress::FromString(transfer.Destination);
+            }
+            catch (const std::exception& e)
+            {
+                fail(e.what());
+            }
+        }
+        scenario.m_nodes[source->second].Transfers.push_back(FileTransfer{ transfer.FileName, destination });
+    }
+
+    for (const PendingWorkload& workload : workloads)
+    {
+        lineNumber = workload.Line;
+        if (scenario.m_nodes.size() < 2)
+        {
+            fail("Une charge synthetique demande au moins deux ordinateurs.");
+        }
+
+        std::mt19937 random(workload.Seed);
+        auto addTransfers = [&scenario, &workload, &random](size_t source, size_t destination)
+        {
+            Node& sender = scenario.m_nodes[source];
+            const Node& receiver = scenario.m_nodes[destination];
+            for (size_t i = 0; i < workload.FilesPerPair; ++i)
+            {
+                // Le nom est unique pour la source : il identifie le transfert dans les journaux et les mesures
+                FileTransfer transfer;
+                transfer.FileName = "synthetic-" + std::to_string(sender.ID) + "-to-" + std::to_string(receiver.ID) + "-" + std::to_string(sender.Transfers.size());
+                transfer.Destination = MACAddress(receiver.Config);
+                transfer.SyntheticSize = workload.Size.sample(random);
+                transfer.SyntheticSeed = (uint32_t)random();
+                sender.Transfers.push_back(transfer);
+            }
+        };
+
+        size_t count = scenario.m_nodes.size();
+        if (workload.Pattern == WorkloadPattern::Pairwise)
+        {
+            // Avec un nombre impair d'ordinateurs, le dernier n'envoie ni ne recoit rien
+            for (size_t i = 0; i + 1 < count; i += 2)
+            {
+                addTransfers(i, i + 1);
+                addTransfers(i + 1, i);
+            }
+        }
+        else
+        {
+            for (size_t i = 1; i < count; ++i)
+            {
+                if (workload.Pattern == WorkloadPattern::AllToOne)
+                {
+                    addTransfers(i, 0);
+                }
+                else
+                {
+                    addTransfers(0, i);
+                }
+            }
+        }
+    }
+
+    return scenario;
+}
+
+const Configuration& Scenario::globalConfiguration() const
+{
+    return m_globalConfiguration;
+}
+
+const std::vector<Scenario::Node>& Scenario::nodes() const
+{
+    return m_nodes;
+}
+
+std::vector<std::unique_ptr<Computer>> Scenario::createComputers() const
+{
+    return CreateInParallel(m_nodes.size(), [this](size_t index)
+    {
+        const Node& node = m_nodes[index];
+        return std::make_unique<Computer>(node.ID, node.Config, node.Transfers);
+    });
+}
+
+std::vector<std::unique_ptr<Computer>> Scenario::CreateInParallel(size_t count, const std::function<std::unique_ptr<Computer>(size_t)>& create)
+{
+    std::vector<std::unique_ptr<Computer>> computers(count);
+    std::atomic<size_t> nextIndex(0);
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    auto worker = [&]()
+    {
+        // Chaque fil prend le prochain indice libre : les constructions lentes ne retardent pas les autres fils
+        for (size_t index = nextIndex++; index < count; index = nextIndex++)
+        {
+            try
+            {
+                computers[index] = create(index);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+                nextIndex = count;
+            }
+        }
+    };
+
+    size_t threadCount = std::min<size_t>(count, std::max<size_t>(1, std::thread::hardware_concurrency()));
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; ++i)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+    return computers;
+}
\ No newline at end of file
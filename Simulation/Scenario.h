@@ -0,0 +1,69 @@
+#ifndef _SIMULATION_SCENARIO_H_
+#define _SIMULATION_SCENARIO_H_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Computer/Computer.h"
+#include "../General/Configuration.h"
+
+// Description complete d'une simulation dans un seul fichier : ordinateurs, adresses, configurations et fichiers a envoyer.
+// Remplace les fichiers ComputerN.txt et ComputerNFiles.txt, qu'il faudrait sinon ouvrir pour chaque ordinateur.
+//
+// Une instruction par ligne, les lignes vides et celles qui commencent par # sont ignorees :
+//     global <Parametre>=<valeur> ...          Configuration globale (concentrateur, timers)
+//     default <Parametre>=<valeur> ...         Configuration de tous les ordinateurs
+//     nodes <premier>-<dernier>                Ajoute les ordinateurs numerotes de premier a dernier
+//     node <numero> [mac=<adresse>] [<Parametre>=<valeur> ...]
+//                                              Ajoute l'ordinateur s'il n'existe pas et change sa configuration
+//     transfer <numero> <fichier> <numero de destination | adresse MAC de destination>
+//     workload <pairwise | all-to-one | one-to-all> [files=<nombre>] [size=<taille>] [seed=<graine>]
+//                                              Ajoute des transferts de fichiers synthetiques, generes en memoire, entre les ordinateurs
+//                                              declares (dans l'ordre de leur numero) :
+//                                                  pairwise : les ordinateurs sont groupes deux a deux et chacun envoie a l'autre
+//                                                  all-to-one : tous envoient au premier ; one-to-all : le premier envoie a tous les autres
+//                                              files : fichiers par couple source-destination (1 par defaut)
+//                                              size : <octets>, uniform:<min>-<max> ou exponential:<moyenne> (100000 par defaut)
+//                                              seed : graine des tailles et du contenu (1 par defaut)
+//                                              Les fichiers recus ne sont pas ecrits sur le disque : workload met NetworkLayerSaveReceivedFiles
+//                                              a 0 dans la configuration par defaut, une instruction default ou node placee apres peut le remettre a 1.
+//
+// Sans mac=, l'adresse d'un ordinateur est celle de sa configuration (parametres MacAddressByte*) plus son numero moins 1 :
+// avec les valeurs par defaut, l'ordinateur 1 a l'adresse de:ad:be:ef:0:1, l'ordinateur 2 de:ad:be:ef:0:2, etc.
+// Les parametres default s'appliquent a tous les ordinateurs, meme ceux declares avant eux.
+class Scenario
+{
+public:
+    struct Node
+    {
+        size_t ID;
+        Configuration Config; // MacAddressByte* contient l'adresse finale de l'ordinateur
+        std::vector<FileTransfer> Transfers;
+    };
+
+private:
+    Configuration m_globalConfiguration;
+    std::vector<Node> m_nodes; // Tries par numero
+
+    Scenario(const Configuration& globalConfiguration);
+
+public:
+    // Lance std::invalid_argument, avec le numero de la ligne fautive, si le fichier ne peut pas etre lu ou est invalide.
+    // Les instructions global s'appliquent a une copie de globalConfiguration.
+    static Scenario Load(const std::string& fileName, const Configuration& globalConfiguration);
+
+    const Configuration& globalConfiguration() const;
+    const std::vector<Node>& nodes() const;
+
+    // Construit les ordinateurs en parallele. Leurs fils d'execution ne sont crees qu'a l'appel de Computer::start().
+    std::vector<std::unique_ptr<Computer>> createComputers() const;
+
+    // Appelle create(0) a create(count - 1) sur tous les coeurs et retourne les ordinateurs dans l'ordre des indices.
+    // Une exception lancee par create est relancee ici, une fois tous les fils termines.
+    static std::vector<std::unique_ptr<Computer>> CreateInParallel(size_t count, const std::function<std::unique_ptr<Computer>(size_t)>& create);
+};
+
+#endif //_SIMULATION_SCENARIO_H_
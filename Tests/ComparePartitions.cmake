@@ -0,0 +1,29 @@
+# Execute le meme scenario en simulation a evenements discrets avec 1 puis PARTITIONS partitions et verifie que les
+# resultats de la mesure de debit sont identiques. Seuls les temps mesures sur l'horloge reelle peuvent differer.
+#
+# Utilisation : cmake -DSIMULATEUR=<executable> -DSCENARIO=<fichier> -DPARTITIONS=<nombre> -DWORK_DIRECTORY=<dossier> -P ComparePartitions.cmake
+
+file(MAKE_DIRECTORY "${WORK_DIRECTORY}")
+file(READ "${SCENARIO}" scenario)
+
+foreach(partitions 1 ${PARTITIONS})
+    set(scenarioFile "${WORK_DIRECTORY}/partitions_${partitions}.txt")
+    set(resultFile "${WORK_DIRECTORY}/partitions_${partitions}.json")
+    file(WRITE "${scenarioFile}" "${scenario}\nglobal DiscreteEventSimulationEnabled=1 DiscreteEventSimulationThreadCount=${partitions}\n")
+    file(REMOVE "${resultFile}")
+    execute_process(COMMAND "${SIMULATEUR}" -s "${scenarioFile}" -b "${resultFile}"
+        WORKING_DIRECTORY "${WORK_DIRECTORY}"
+        RESULT_VARIABLE result
+        OUTPUT_QUIET
+        TIMEOUT 120)
+    if(NOT result EQUAL 0 OR NOT EXISTS "${resultFile}")
+        message(FATAL_ERROR "La simulation avec ${partitions} partition(s) a echoue : ${result}")
+    endif()
+    file(READ "${resultFile}" content)
+    string(REGEX REPLACE "\"(wall|cpu)_seconds\": [^,\n]*" "" content "${content}")
+    set(results_${partitions} "${content}")
+endforeach()
+
+if(NOT results_1 STREQUAL results_${PARTITIONS})
+    message(FATAL_ERROR "Les resultats different entre 1 et ${PARTITIONS} partitions :\n${results_1}\n${results_${PARTITIONS}}")
+endif()
@@ -0,0 +1,496 @@
+// Verifie les cas limites des structures du coeur du simulateur, qui ne sont autrement exercees que par les benchmarks :
+// cascades de la roue de temporisation (comparee au monceau binaire), suppression par recul de FlatHashMap,
+// calcul des cases des histogrammes HDR, passage de la fin du buffer des files SPSC et numeros de timers du TimerService.
+// Les sequences aleatoires utilisent des graines fixes : un echec se reproduit a l'identique.
+//
+// Utilisation : CoreTests (retourne 0 si toutes les verifications reussissent)
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../DataStructures/CircularQueue.h"
+#include "../DataStructures/DataBuffer.h"
+#include "../DataStructures/FlatHashMap.h"
+#include "../DataStructures/ObjectQueue.h"
+#include "../General/Configuration.h"
+#include "../General/LatencyHistogram.h"
+#include "../General/Timer.h"
+#include "../General/TimerService.h"
+
+namespace
+{
+    size_t s_checkCount = 0;
+    size_t s_failureCount = 0;
+
+    void check(bool condition, const char* expression, const char* file, int line)
+    {
+        ++s_checkCount;
+        if (!condition)
+        {
+            ++s_failureCount;
+            std::cerr << file << ":" << line << " : echec de " << expression << std::endl;
+        }
+    }
+}
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+
+namespace
+{
+    using Clock = TimerQueue::Clock;
+
+    // Les deux files recoivent les memes operations. Avec une origine alignee et des instants en millisecondes entieres,
+    // la roue doit signaler exactement les memes timers que le monceau, au meme appel a popExpired.
+    void testTimingWheelMatchesHeap()
+    {
+        std::mt19937 random(13);
+        HeapTimerQueue heap;
+        TimingWheelTimerQueue wheel;
+        Clock::time_point now = Clock::now();
+        wheel.restartAll(now);
+
+        auto callback = [](size_t, NumberSequence) {};
+        std::vector<size_t> active; // Numeros du monceau
+        std::unordered_map<size_t, size_t> wheelIDs; // Numero du monceau vers numero de la roue
+        std::unordered_map<size_t, size_t> heapIDs; // Numero de la roue vers numero du monceau
+        std::vector<std::pair<size_t, size_t>> stale; // Timers retires ou expires
+
+        // Les intervalles couvrent chaque niveau de la roue et depassent son etendue (2^24 ticks)
+        const int intervalLimits[] = { 64, 4096, 262144, 1 << 25 };
+        std::uniform_int_distribution<int> percent(0, 99);
+
+        auto forget = [&](size_t index)
+        {
+            size_t heapID = active[index];
+            size_t wheelID = wheelIDs[heapID];
+            stale.push_back(std::make_pair(heapID, wheelID));
+            wheelIDs.erase(heapID);
+            heapIDs.erase(wheelID);
+            active[index] = active.back();
+            active.pop_back();
+        };
+
+        std::vector<TimerQueue::TimerInfo> heapExpired;
+        std::vector<TimerQueue::TimerInfo> wheelExpired;
+        for (size_t step = 0; step < 50000; ++step)
+        {
+            int operation = percent(random);
+            if (operation < 40 && active.size() < 2000)
+            {
+                int limit = intervalLimits[std::uniform_int_distribution<size_t>(0, 3)(random)];
+                std::chrono::milliseconds interval(std::uniform_int_distribution<int>(1, limit)(random));
+                size_t heapID = heap.add(interval, callback, (NumberSequence)step, now);
+                size_t wheelID = wheel.add(interval, callback, (NumberSequence)step, now);
+                active.push_back(heapID);
+                wheelIDs[heapID] = wheelID;
+                heapIDs[wheelID] = heapID;
+            }
+            else if (operation < 60 && !active.empty())
+            {
+                size_t heapID = active[std::uniform_int_distribution<size_t>(0, active.size() - 1)(random)];
+                CHECK(heap.restart(heapID, (NumberSequence)step, now));
+                CHECK(wheel.restart(wheelIDs[heapID], (NumberSequence)step, now));
+            }
+            else if (operation < 75 && !active.empty())
+            {
+                size_t index = std::uniform_int_distribution<size_t>(0, active.size() - 1)(random);
+                heap.remove(active[index]);
+                wheel.remove(wheelIDs[active[index]]);
+                forget(index);
+            }
+            else if (operation < 80 && !stale.empty())
+            {
+                // Un numero perime ne doit jamais designer un autre timer, meme si sa case a ete reutilisee
+                const std::pair<size_t, size_t>& ids = stale[std::uniform_int_distribution<size_t>(0, stale.size() - 1)(random)];
+                CHECK(!heap.restart(ids.first, 0, now));
+                CHECK(!wheel.restart(ids.second, 0, now));
+                wheel.remove(ids.second);
+            }
+
+            // Surtout de petits pas, parfois de grands sauts qui traversent plusieurs niveaux d'un coup
+            int advance = percent(random);
+            int maximumStep = advance < 60 ? 1 : advance < 90 ? 100 : advance < 99 ? 70000 : 5000000;
+            now += std::chrono::milliseconds(std::uniform_int_distribution<int>(1, maximumStep)(random));
+
+            heap.popExpired(now, heapExpired);
+            wheel.popExpired(now, wheelExpired);
+            std::vector<size_t> expectedIDs;
+            for (const TimerQueue::TimerInfo& info : heapExpired)
+            {
+                CHECK(info.NextTick <= now);
+                expectedIDs.push_back(info.ID);
+            }
+            std::vector<size_t> wheelAsHeapIDs;
+            for (const TimerQueue::TimerInfo& info : wheelExpired)
+            {
+                CHECK(info.NextTick <= now);
+                auto it = heapIDs.find(info.ID);
+                CHECK(it != heapIDs.end());
+                if (it != heapIDs.end())
+                {
+                    wheelAsHeapIDs.push_back(it->second);
+                }
+            }
+            std::sort(expectedIDs.begin(), expectedIDs.end());
+            std::sort(wheelAsHeapIDs.begin(), wheelAsHeapIDs.end());
+            CHECK(expectedIDs == wheelAsHeapIDs);
+            for (size_t heapID : expectedIDs)
+            {
+                auto it = std::find(active.begin(), active.end(), heapID);
+                if (it != active.end())
+                {
+                    forget((size_t)(it - active.begin()));
+                }
+            }
+            heapExpired.clear();
+            wheelExpired.clear();
+            CHECK(heap.size() == wheel.size());
+        }
+    }
+
+    // Une fonction de hachage qui regroupe les cles force de longues sequences de sondage, y compris par-dessus la fin de la table
+    struct ClusteredHash
+    {
+        size_t operator()(uint32_t key) const
+        {
+            return (size_t)(key / 4) * 7;
+        }
+    };
+
+    void testFlatHashMapMatchesUnorderedMap()
+    {
+        std::mt19937 random(17);
+        FlatHashMap<uint32_t, uint32_t, ClusteredHash> map;
+        std::unordered_map<uint32_t, uint32_t> reference;
+        std::uniform_int_distribution<uint32_t> keys(0, 199);
+        std::uniform_int_distribution<int> percent(0, 99);
+
+        for (uint32_t step = 0; step < 200000; ++step)
+        {
+            uint32_t key = keys(random);
+            int operation = percent(random);
+            if (operation < 35)
+            {
+                bool inserted = map.insert(std::make_pair(key, step)).second;
+                CHECK(inserted == reference.insert(std::make_pair(key, step)).second);
+            }
+            else if (operation < 45)
+            {
+                map[key] = step;
+                reference[key] = step;
+            }
+            else if (operation < 70)
+            {
+                CHECK(map.erase(key) == reference.erase(key));
+            }
+            else if (operation < 80)
+            {
+                auto it = map.find(key);
+                CHECK((it != map.end()) == (reference.count(key) == 1));
+                if (it != map.end())
+                {
+                    map.erase(it);
+                    reference.erase(key);
+                }
+            }
+            else
+            {
+                auto it = map.find(key);
+                auto expected = reference.find(key);
+                CHECK((it != map.end()) == (expected != reference.end()));
+                if (it != map.end() && expected != reference.end())
+                {
+                    CHECK(it->second == expected->second);
+                }
+            }
+            CHECK(map.size() == reference.size());
+
+            if (step % 1000 == 0)
+            {
+                // Apres les reculs, chaque element doit rester trouvable et apparaitre une seule fois au parcours
+                size_t visited = 0;
+                for (const auto& entry : map)
+                {
+                    auto expected = reference.find(entry.first);
+                    CHECK(expected != reference.end() && expected->second == entry.second);
+                    ++visited;
+                }
+                CHECK(visited == reference.size());
+                for (const auto& entry : reference)
+                {
+                    CHECK(map.count(entry.first) == 1);
+                }
+            }
+        }
+        map.clear();
+        CHECK(map.empty());
+        CHECK(map.begin() == map.end());
+    }
+
+    void testLatencyHistogramBuckets()
+    {
+        // Chaque case contient exactement les valeurs entre la plus grande valeur de la case precedente et la sienne
+        for (size_t index = 0; index < LatencyHistogram::BucketCount; ++index)
+        {
+            uint64_t highest = LatencyHistogram::HighestEquivalentValue(index);
+            CHECK(LatencyHistogram::IndexOf(highest) == index);
+            if (index + 1 < LatencyHistogram::BucketCount)
+            {
+                CHECK(LatencyHistogram::IndexOf(highest + 1) == index + 1);
+            }
+        }
+        CHECK(LatencyHistogram::HighestEquivalentValue(LatencyHistogram::BucketCount - 1) == std::numeric_limits<uint64_t>::max());
+        CHECK(LatencyHistogram::IndexOf(std::numeric_limits<uint64_t>::max()) == LatencyHistogram::BucketCount - 1);
+
+        // Erreur relative d'au plus 2 / SubBucketCount autour de chaque puissance de deux
+        for (uint32_t bit = 0; bit < 64; ++bit)
+        {
+            uint64_t power = (uint64_t)1 << bit;
+            for (uint64_t value : { power - 1, power, power + 1 })
+            {
+                if (value == 0)
+                {
+                    continue;
+                }
+                uint64_t highest = LatencyHistogram::HighestEquivalentValue(LatencyHistogram::IndexOf(value));
+                CHECK(highest >= value);
+                if (value < LatencyHistogram::SubBucketCount)
+                {
+                    CHECK(highest == value);
+                }
+                else
+                {
+                    CHECK(highest - value <= value / LatencyHistogram::SubBucketCount * 2);
+                }
+            }
+        }
+
+        LatencyHistogram histogram;
+        for (int64_t value = 1; value <= 100000; ++value)
+        {
+            histogram.record(std::chrono::nanoseconds(value));
+        }
+        CHECK(histogram.count() == 100000);
+        CHECK(histogram.max() == std::chrono::nanoseconds(100000));
+        CHECK(histogram.percentile(100.0) == histogram.max());
+        int64_t median = histogram.percentile(50.0).count();
+        CHECK(median >= 50000 && median <= 50000 + 50000 * 2 / (int64_t)LatencyHistogram::SubBucketCount);
+
+        LatencyHistogram merged;
+        merged.merge(histogram);
+        merged.merge(histogram);
+        CHECK(merged.count() == 200000);
+        CHECK(merged.sum() == histogram.sum() * 2);
+        merged.clear();
+        CHECK(merged.count() == 0);
+        CHECK(merged.percentile(50.0) == std::chrono::nanoseconds(0));
+    }
+
+    // Les enregistrements de tailles variees font passer les index par la fin du buffer a des positions differentes
+    void testCircularQueueWrapAround()
+    {
+        std::mt19937 random(19);
+        CircularQueue queue(64);
+        std::deque<DynamicDataBuffer> reference;
+        size_t highestSize = 0;
+        for (uint32_t step = 0; step < 20000; ++step)
+        {
+            DynamicDataBuffer record(std::uniform_int_distribution<uint32_t>(1, 40)(random));
+            for (uint32_t i = 0; i < record.size(); ++i)
+            {
+                record[i] = (uint8_t)(step + i);
+            }
+            if (queue.canWrite(record) && random() % 2 == 0)
+            {
+                queue.push(record);
+                reference.push_back(record);
+            }
+            else if (!reference.empty())
+            {
+                CHECK(queue.canRead<DynamicDataBuffer>());
+                DynamicDataBuffer popped = queue.pop<DynamicDataBuffer>();
+                CHECK(popped.size() == reference.front().size());
+                CHECK(std::equal(popped.data(), popped.data() + popped.size(), reference.front().data()));
+                reference.pop_front();
+            }
+            highestSize = std::max(highestSize, queue.size());
+        }
+        CHECK(queue.highWaterMark() == highestSize);
+
+        // Ecriture directe et lecture sans copie : les zones doivent se separer en deux segments a la fin du buffer
+        CircularQueue bytes(64);
+        bool splitSeen = false;
+        uint8_t next = 0;
+        uint8_t expected = 0;
+        for (uint32_t step = 0; step < 5000; ++step)
+        {
+            size_t count = std::uniform_int_distribution<size_t>(1, 30)(random);
+            if (bytes.enoughSpaceFor(count))
+            {
+                std::vector<uint8_t> data(count);
+                for (uint8_t& value : data)
+                {
+                    value = next++;
+                }
+                CircularQueue::WriteRegion region = bytes.reserve(count);
+                splitSeen = splitSeen || !region.contiguous();
+                region.copyFrom(0, data.data(), count);
+                bytes.commit(count);
+            }
+            size_t available = bytes.size();
+            if (available > 0)
+            {
+                size_t readCount = std::uniform_int_distribution<size_t>(1, available)(random);
+                std::vector<uint8_t> data(readCount);
+                CircularQueue::ReadRegion region = bytes.peek(readCount);
+                CHECK(region.size() == readCount);
+                region.copyTo(0, data.data(), readCount);
+                bool ordered = true;
+                for (uint8_t value : data)
+                {
+                    ordered = ordered && value == expected++;
+                }
+                CHECK(ordered);
+                bytes.consume(readCount);
+            }
+        }
+        CHECK(splitSeen);
+    }
+
+    void testObjectQueueWrapAround()
+    {
+        ObjectQueue<std::unique_ptr<uint32_t>> queue(8);
+        CHECK(queue.capacity() == 8);
+        uint32_t next = 0;
+        uint32_t expected = 0;
+        for (uint32_t round = 0; round < 100; ++round)
+        {
+            while (queue.canWrite())
+            {
+                queue.push(std::make_unique<uint32_t>(next++));
+            }
+            CHECK(queue.size() == 8);
+            // Un nombre de retraits different a chaque tour deplace la fin de la file dans le buffer
+            std::vector<std::unique_ptr<uint32_t>> values;
+            // popAll peut s'arreter a la derniere fin de file vue par le consommateur, mais retire toujours au moins un objet
+            size_t popped = queue.popAll(values, round % 7 + 1);
+            CHECK(popped >= 1 && popped <= round % 7 + 1);
+            for (const std::unique_ptr<uint32_t>& value : values)
+            {
+                CHECK(value && *value == expected++);
+            }
+            if (queue.canRead())
+            {
+                std::unique_ptr<uint32_t> value = queue.pop();
+                CHECK(value && *value == expected++);
+            }
+        }
+        CHECK(queue.highWaterMark() == 8);
+    }
+
+    // Un producteur et un consommateur dans des fils differents : aucun objet ne doit etre perdu, double ou desordonne
+    void testQueuesAcrossThreads()
+    {
+        const uint64_t count = 200000;
+
+        ObjectQueue<uint64_t> objects(16);
+        std::thread objectProducer([&objects, count]()
+        {
+            for (uint64_t value = 0; value < count; ++value)
+            {
+                while (!objects.canWrite())
+                {
+                    std::this_thread::yield();
+                }
+                objects.push(value);
+            }
+        });
+        bool objectsOrdered = true;
+        for (uint64_t expected = 0; expected < count; ++expected)
+        {
+            while (!objects.canRead())
+            {
+                std::this_thread::yield();
+            }
+            objectsOrdered = objectsOrdered && objects.pop() == expected;
+        }
+        objectProducer.join();
+        CHECK(objectsOrdered);
+
+        CircularQueue bytes(64);
+        std::thread byteProducer([&bytes, count]()
+        {
+            for (uint64_t value = 0; value < count; ++value)
+            {
+                while (!bytes.canWrite(value))
+                {
+                    std::this_thread::yield();
+                }
+                bytes.push(value);
+            }
+        });
+        bool bytesOrdered = true;
+        for (uint64_t expected = 0; expected < count; ++expected)
+        {
+            while (!bytes.canRead<uint64_t>())
+            {
+                std::this_thread::yield();
+            }
+            bytesOrdered = bytesOrdered && bytes.pop<uint64_t>() == expected;
+        }
+        byteProducer.join();
+        CHECK(bytesOrdered);
+    }
+
+    // Les proprietaires d'un meme fil de timers ne doivent jamais pouvoir redemarrer ou retirer les timers des autres
+    void testTimerHandleOwnership()
+    {
+        Configuration config;
+        TimerService service(1, config);
+        TimerHandle first(service);
+        TimerHandle second(service);
+        first.start();
+        second.start();
+
+        std::atomic<bool> fired(false);
+        size_t id = first.addTimer(std::chrono::milliseconds(20), [&fired](size_t, NumberSequence) { fired = true; }, 0);
+        CHECK(!second.restartTimer(id, 0));
+        second.removeTimer(id);
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!fired && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        CHECK(fired);
+        // Un timer arrive a echeance n'appartient plus a personne
+        CHECK(!first.restartTimer(id, 0));
+        first.stop();
+        second.stop();
+    }
+}
+
+int main()
+{
+    testTimingWheelMatchesHeap();
+    testFlatHashMapMatchesUnorderedMap();
+    testLatencyHistogramBuckets();
+    testCircularQueueWrapAround();
+    testObjectQueueWrapAround();
+    testQueuesAcrossThreads();
+    testTimerHandleOwnership();
+
+    std::cout << s_checkCount << " verifications, " << s_failureCount << " echecs" << std::endl;
+    return s_failureCount == 0 ? 0 : 1;
+}
\ No newline at end of file
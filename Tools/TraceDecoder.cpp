@@ -0,0 +1,237 @@
+// Convertit une trace binaire (voir Log::EnableBinaryTrace) en texte, dans le meme format que les journaux du simulateur,
+// precede du temps de l'evenement en microsecondes depuis le debut de la trace.
+//
+// Utilisation : TraceDecoder <trace> [niveau minimal : 0 trace, 1 debug, 2 info, 3 warning, 4 error]
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../DataStructures/MACAddress.h"
+#include "../General/LogTypes.h"
+
+namespace
+{
+    struct Definition
+    {
+        LogLevel Level;
+        LogCategory Category;
+        std::string Format;
+        std::string ArgumentCodes;
+    };
+
+    // Lecture sequentielle du contenu de la trace
+    class TraceReader
+    {
+        const std::vector<char>* m_data;
+        size_t m_position;
+
+    public:
+        TraceReader(const std::vector<char>& data, size_t position) : m_data(&data), m_position(position) {}
+
+        bool atEnd() const { return m_position >= m_data->size(); }
+        size_t position() const { return m_position; }
+
+        template<typename T>
+        T read()
+        {
+            T value;
+            readBytes(reinterpret_cast<char*>(&value), sizeof(value));
+            return value;
+        }
+
+        std::string readString(size_t size)
+        {
+            std::string value(size, '\0');
+            readBytes(&value[0], size);
+            return value;
+        }
+
+        void readBytes(char* out, size_t size)
+        {
+            if (size > m_data->size() - m_position)
+            {
+                throw std::out_of_range("La trace est tronquee.");
+            }
+            std::memcpy(out, &(*m_data)[m_position], size);
+            m_position += size;
+        }
+
+        void skip(size_t size)
+        {
+            if (size > m_data->size() - m_position)
+            {
+                throw std::out_of_range("La trace est tronquee.");
+            }
+            m_position += size;
+        }
+    };
+
+    Definition readDefinition(TraceReader& reader, uint32_t& id)
+    {
+        Definition definition;
+        id = reader.read<uint32_t>();
+        definition.Level = static_cast<LogLevel>(reader.read<uint8_t>());
+        definition.Category = static_cast<LogCategory>(reader.read<uint8_t>());
+        reader.read<uint32_t>(); // Ligne
+        reader.readString(reader.read<uint16_t>()); // Fichier
+        definition.Format = reader.readString(reader.read<uint16_t>());
+        definition.ArgumentCodes = reader.readString(reader.read<uint8_t>());
+        return definition;
+    }
+
+    void printArgument(std::ostream& out, TraceReader& reader, char code)
+    {
+        switch (code)
+        {
+        case TraceFormat::SignedArgument:
+            out << reader.read<int64_t>();
+            break;
+        case TraceFormat::UnsignedArgument:
+            out << reader.read<uint64_t>();
+            break;
+        case TraceFormat::FloatArgument:
+            out << reader.read<double>();
+            break;
+        case TraceFormat::MACAddressArgument:
+            out << MACAddress::FromValue(reader.read<uint64_t>());
+            break;
+        case TraceFormat::StringArgument:
+            out << reader.readString(reader.read<uint32_t>());
+            break;
+        default:
+            throw std::out_of_range("Code d'argument inconnu dans la trace.");
+        }
+    }
+
+    // Meme rendu que Log::print : chaque {} est remplace par l'argument suivant
+    void printEvent(std::ostream& out, TraceReader& reader, const Definition& definition)
+    {
+        size_t position = 0;
+        for (char code : definition.ArgumentCodes)
+        {
+            size_t next = definition.Format.find("{}", position);
+            out << definition.Format.substr(position, next == std::string::npos ? std::string::npos : next - position);
+            printArgument(out, reader, code);
+            position = next == std::string::npos ? definition.Format.size() : next + 2;
+        }
+        out << definition.Format.substr(position);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cout << "Utilisation : TraceDecoder <trace> [niveau minimal]" << std::endl;
+        return 1;
+    }
+    int minimumLevel = argc > 2 ? std::stoi(argv[2]) : 0;
+
+    std::ifstream file(argv[1], std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cout << "Impossible d'ouvrir la trace " << argv[1] << std::endl;
+        return 1;
+    }
+    const std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    try
+    {
+        TraceReader header(data, 0);
+        if (data.size() < TraceFormat::MagicSize || header.readString(TraceFormat::MagicSize) != TraceFormat::Magic())
+        {
+            std::cout << argv[1] << " n'est pas une trace du simulateur." << std::endl;
+            return 1;
+        }
+        if (header.read<uint32_t>() != TraceFormat::Version)
+        {
+            std::cout << "Version de trace non supportee." << std::endl;
+            return 1;
+        }
+        const size_t firstRecord = TraceFormat::MagicSize + sizeof(uint32_t);
+
+        // Premiere passe : les definitions peuvent suivre les evenements d'un autre fil qui les utilisent
+        std::unordered_map<uint32_t, Definition> definitions;
+        TraceReader reader(data, firstRecord);
+        while (!reader.atEnd())
+        {
+            uint8_t type = reader.read<uint8_t>();
+            if (type == TraceFormat::DefinitionRecord)
+            {
+                uint32_t id;
+                Definition definition = readDefinition(reader, id);
+                definitions[id] = definition;
+            }
+            else if (type == TraceFormat::EventRecord)
+            {
+                reader.read<uint32_t>();
+                reader.read<uint64_t>();
+                reader.skip(reader.read<uint32_t>());
+            }
+            else
+            {
+                throw std::out_of_range("Type d'enregistrement inconnu dans la trace.");
+            }
+        }
+
+        // Deuxieme passe : les evenements sont tries par temps, car chaque fil ecrit les siens par blocs
+        struct EventPosition
+        {
+            uint64_t Time;
+            size_t Position;
+        };
+        std::vector<EventPosition> events;
+        reader = TraceReader(data, firstRecord);
+        while (!reader.atEnd())
+        {
+            size_t position = reader.position();
+            uint8_t type = reader.read<uint8_t>();
+            if (type == TraceFormat::DefinitionRecord)
+            {
+                uint32_t id;
+                readDefinition(reader, id);
+                continue;
+            }
+
+            uint32_t id = reader.read<uint32_t>();
+            uint64_t time = reader.read<uint64_t>();
+            reader.skip(reader.read<uint32_t>());
+            auto it = definitions.find(id);
+            if (it != definitions.end() && static_cast<int>(it->second.Level) >= minimumLevel)
+            {
+                events.push_back(EventPosition{ time, position });
+            }
+        }
+        std::stable_sort(events.begin(), events.end(), [](const EventPosition& left, const EventPosition& right) { return left.Time < right.Time; });
+
+        for (const EventPosition& event : events)
+        {
+            TraceReader eventReader(data, event.Position + 1);
+            const Definition& definition = definitions[eventReader.read<uint32_t>()];
+            eventReader.skip(sizeof(uint64_t) + sizeof(uint32_t));
+
+            std::ostringstream time;
+            time << std::fixed << std::setprecision(3) << event.Time / 1000.0;
+            std::cout << std::setw(14) << time.str() << " [" << LogCategoryName(definition.Category) << "] ";
+            printEvent(std::cout, eventReader, definition);
+            std::cout << '\n';
+        }
+    }
+    catch (const std::out_of_range& e)
+    {
+        std::cout << std::flush;
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -3,11 +3,20 @@
 
 #include "../Computer/Hardware/NetworkInterfaceCard.h"
 #include "../DataStructures/DataBuffer.h"
+#include "../DataStructures/SharedDataBuffer.h"
+#include "../General/Log.h"
 
-Cable::Cable(TransmissionHub* hub, NetworkInterfaceCard& card)
-    : m_hub(hub)
-    , m_nic(card)
+#include <iostream>
+
+Cable::Cable(TransmissionHub* hub, NetworkInterfaceCard& card, size_t bufferSize, Notifier* hubNotifier, uint32_t port)
+    : m_nic(card)
+    , m_hub(hub)
+    , m_port(port)
+    , m_hubQueue(bufferSize)
+    , m_hubQueueWatch("hub_port", card.getDriver().getMACAddress(), m_hubQueue)
 {
+    // Le concentrateur attend sur un seul notificateur pour l'ensemble de ses ports
+    m_hubQueue.setDataNotifier(hubNotifier);
     m_nic.connect(this);
 }
 
@@ -16,12 +25,48 @@ const NetworkInterfaceCard& Cable::getConnectedNIC() const
     return m_nic;
 }
 
+uint32_t Cable::port() const
+{
+    return m_port;
+}
+
 void Cable::sendToHub(DynamicDataBuffer& data)
 {
-    m_hub->receive_data_to_dispatch(data, this);
+    // En simulation a evenements discrets, l'envoi ne passe pas par le buffer du cable : il est diffuse immediatement
+    if (m_hub->eventDriven())
+    {
+        m_hub->broadcast(SharedDataBuffer(data), this);
+        return;
+    }
+    // Chaque cable a son propre buffer : un ordinateur qui envoie ne bloque jamais les autres
+    if (m_hubQueue.canWrite<DynamicDataBuffer>(data))
+    {
+        m_hubQueue.push(data);
+    }
+    else
+    {
+        LOG_WARNING(LogCategory::Hub, "Data lost - Transmission buffer full : \n\tFrom : {}", m_nic.getDriver().getMACAddress());
+        Metrics::Add(Metric::HubDrops);
+    }
 }
 
-void Cable::sendToCard(DynamicDataBuffer& data)
+void Cable::sendToCard(const SharedDataBuffer& data)
 {
     m_nic.receive(data);
+}
+
+bool Cable::dataReady() const
+{
+    return m_hubQueue.canRead<DynamicDataBuffer>();
+}
+
+// Les octets sont lus une seule fois du buffer du cable vers un SharedDataBuffer qui sera partage entre tous les ports
+SharedDataBuffer Cable::getNextData()
+{
+    size_t recordSize = m_hubQueue.peekSize<DynamicDataBuffer>();
+    CircularQueue::ReadRegion record = m_hubQueue.peek(recordSize);
+    SharedDataBuffer data((uint32_t)(recordSize - sizeof(uint32_t)));
+    record.copyTo(sizeof(uint32_t), data.mutableData(), data.size());
+    m_hubQueue.consume(recordSize);
+    return data;
 }
\ No newline at end of file
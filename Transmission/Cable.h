@@ -1,25 +1,40 @@
 #ifndef _TRANSMISSION_CABLE_H_
 #define _TRANSMISSION_CABLE_H_
 
+#include "../DataStructures/CircularQueue.h"
+#include "../General/Metrics.h"
+
 #include <cstdint>
 
 class DynamicDataBuffer;
 class NetworkInterfaceCard;
+class Notifier;
+class SharedDataBuffer;
 class TransmissionHub;
 
 class Cable
 {
     NetworkInterfaceCard& m_nic;
     TransmissionHub* m_hub;
+    uint32_t m_port; // Position dans les ports du concentrateur
+
+    // Donnees en attente d'etre diffusees par le concentrateur.
+    // L'ordinateur connecte est le seul a y ecrire et le fil du concentrateur le seul a y lire : aucun verrou n'est necessaire.
+    CircularQueue m_hubQueue;
+    QueueWatch m_hubQueueWatch;
 
 public:
-    Cable(TransmissionHub* hub, NetworkInterfaceCard& card);
+    Cable(TransmissionHub* hub, NetworkInterfaceCard& card, size_t bufferSize, Notifier* hubNotifier, uint32_t port);
 
     const NetworkInterfaceCard& getConnectedNIC() const;
+    uint32_t port() const;
 
     void sendToHub(DynamicDataBuffer& data);
-    void sendToCard(DynamicDataBuffer& data);
+    void sendToCard(const SharedDataBuffer& data);
 
+    // Appeles seulement par le fil du concentrateur
+    bool dataReady() const;
+    SharedDataBuffer getNextData();
 };
 
 #endif //_TRANSMISSION_CABLE_H_
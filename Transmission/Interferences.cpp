@@ -1,18 +1,18 @@
 #include "Interferences.h"
-#include "../DataStructures/DataBuffer.h"
+#include "../DataStructures/SharedDataBuffer.h"
 #include "../General/Configuration.h"
-#include "../General/Logger.h"
+#include "../General/Log.h"
 
 #include <cmath>
 #include <iostream>
 
 
-std::unique_ptr<Interference> Interference::CreateInterferenceImplementation(const Configuration& config)
+std::unique_ptr<Interference> Interference::CreateInterferenceImplementation(const Configuration& config, unsigned int port)
 {
     int noiseConfig = config.get(Configuration::TRANSMISSION_HUB_NOISE);
     if (noiseConfig == 1)
     {
-        return std::make_unique<RandomInterference>(config.get(Configuration::TRANSMISSION_HUB_NOISE_FREQUENCY), config.get(Configuration::TRANSMISSION_HUB_NOISE_BYTE_ERROR_FREQUENCY));
+        return std::make_unique<RandomInterference>(config.get(Configuration::TRANSMISSION_HUB_NOISE_FREQUENCY), config.get(Configuration::TRANSMISSION_HUB_NOISE_BYTE_ERROR_FREQUENCY), config.get(Configuration::TRANSMISSION_HUB_NOISE_SEED) + port);
     }
     else
     {
@@ -22,13 +22,13 @@ std::unique_ptr<Interference> Interference::CreateInterferenceImplementation(con
 
 
 
-void NoInterference::noise(DynamicDataBuffer& data)
+void NoInterference::noise(SharedDataBuffer& data)
 {
 }
 
 
-RandomInterference::RandomInterference(unsigned int frequency, unsigned int byteErrorFrequency)
-    : m_randomGenerator()
+RandomInterference::RandomInterference(unsigned int frequency, unsigned int byteErrorFrequency, unsigned int seed)
+    : m_randomGenerator(seed)
     , m_frequency(frequency)
     , m_frequencyDistribution(0, 100)
     , m_errorGenerator(1, 255)
@@ -36,21 +36,21 @@ RandomInterference::RandomInterference(unsigned int frequency, unsigned int byte
 {
 }
 
-void RandomInterference::noise(DynamicDataBuffer& data)
+void RandomInterference::noise(SharedDataBuffer& data)
 {
     bool applyNoise = m_frequencyDistribution(m_randomGenerator) <= m_frequency;
     if (applyNoise)
     {
-        Logger log(std::cout);
-        log << "Random Noise applied on data" << std::endl;
+        LOG_DEBUG(LogCategory::Hub, "Random Noise applied on data");
         auto distribution = std::uniform_int_distribution<unsigned int>(0, data.size() - 1);
         // On veut au moins 1 octet modifie
         unsigned int errorByteCount = (unsigned int)std::ceil((data.size() * m_byteErrorFrequency) / 100.0);
+        uint8_t* bytes = data.mutableData();
         for (unsigned int i = 0; i < errorByteCount; ++i)
         {
             unsigned int byteNumberInError = distribution(m_randomGenerator);
             uint8_t error = (uint8_t)m_errorGenerator(m_randomGenerator);
-            data[byteNumberInError] = data[byteNumberInError] ^ error; // OU Exclusif
+            bytes[byteNumberInError] = bytes[byteNumberInError] ^ error; // OU Exclusif
         }
     }
 }
\ No newline at end of file
@@ -1,23 +1,26 @@
 #ifndef _TRANSMISSION_INTERFERENCES_H_
 #define _TRANSMISSION_INTERFERENCES_H_
 
+#include <memory>
 #include <random>
 
 class Configuration;
-class DynamicDataBuffer;
+class SharedDataBuffer;
 
 class Interference
 {
 public:
-    static std::unique_ptr<Interference> CreateInterferenceImplementation(const Configuration& config);
+    // Chaque port a son propre generateur : sa graine est celle de la configuration plus le numero du port
+    static std::unique_ptr<Interference> CreateInterferenceImplementation(const Configuration& config, unsigned int port);
 
-    virtual void noise(DynamicDataBuffer& data) = 0;
+    // Les octets ne sont copies (copy-on-write) que si du bruit est reellement applique
+    virtual void noise(SharedDataBuffer& data) = 0;
 };
 
 class NoInterference : public Interference
 {
 public:
-    void noise(DynamicDataBuffer& data) override;
+    void noise(SharedDataBuffer& data) override;
 };
 
 class RandomInterference : public Interference
@@ -28,8 +31,9 @@ class RandomInterference : public Interference
     unsigned int m_frequency;
     unsigned int m_byteErrorFrequency;
 public:
-    RandomInterference(unsigned int frequency, unsigned int byteErrorFrequency);
-    void noise(DynamicDataBuffer& data) override;
+    // Avec la meme graine, le bruit est le meme d'une execution a l'autre si les envois arrivent dans le meme ordre
+    RandomInterference(unsigned int frequency, unsigned int byteErrorFrequency, unsigned int seed);
+    void noise(SharedDataBuffer& data) override;
 };
 
 
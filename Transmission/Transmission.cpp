@@ -3,16 +3,25 @@
 #include "../Computer/Computer.h"
 #include "../Computer/Hardware/NetworkInterfaceCard.h"
 
-#include "../General/Logger.h"
+#include "../General/Log.h"
+#include "../General/Metrics.h"
 
 #include <iostream>
 
 TransmissionHub::TransmissionHub(const Configuration& config)
-    : m_transmissionThread()
-    , m_dataQueue(config.get(Configuration::TRANSMISSION_HUB_BUFFER_SIZE))
+    : m_config(config)
+    , m_portBufferSize(config.get(Configuration::TRANSMISSION_HUB_BUFFER_SIZE))
+    , m_simulator(EventSimulator::Enabled() ? &EventSimulator::Shared() : nullptr)
+    , m_latency(std::chrono::microseconds(config.get(Configuration::TRANSMISSION_HUB_LATENCY)))
     , m_stop(true)
+    , m_transmissionThread()
 {
-    m_interference = Interference::CreateInterferenceImplementation(config);
+    TaskScheduler* scheduler = TaskScheduler::Active();
+    if (scheduler && !m_simulator)
+    {
+        m_transmissionTask = std::make_unique<Task>(*scheduler, [this]() { return transmitStep(); });
+        m_dataNotifier.setTask(m_transmissionTask.get());
+    }
 }
 
 TransmissionHub::~TransmissionHub()
@@ -28,67 +37,139 @@ TransmissionHub::~TransmissionHub()
 void TransmissionHub::start()
 {
     m_stop = false;
-    m_transmissionThread = std::thread(&TransmissionHub::transmit, this);
+    if (m_simulator)
+    {
+        m_partitionPorts.assign(m_simulator->partitionCount(), std::vector<uint32_t>());
+        for (uint32_t port = 0; port < m_connections.size(); ++port)
+        {
+            m_partitionPorts[m_simulator->partitionOf(port)].push_back(port);
+        }
+    }
+    else if (m_transmissionTask)
+    {
+        m_transmissionTask->start();
+    }
+    else
+    {
+        m_transmissionThread = std::thread(&TransmissionHub::transmit, this);
+    }
 }
 
 void TransmissionHub::stop()
 {
     m_stop = true;
+    if (m_transmissionTask)
+    {
+        m_transmissionTask->stop();
+    }
+    m_dataNotifier.notify();
     if (m_transmissionThread.joinable())
     {
         m_transmissionThread.join();
     }
 }
 
+// Doit etre appele avant start() : la liste des ports n'est plus modifiee une fois le concentrateur demarre
 void TransmissionHub::connect_computer(Computer* computer)
 {
-    Cable* cable = new Cable(this, computer->getNetworkInterfaceCard());
-    m_connections.insert(cable);
+    // Le numero du port est aussi celui du noeud dans la simulation a evenements discrets
+    m_interferences.push_back(Interference::CreateInterferenceImplementation(m_config, (unsigned int)m_connections.size()));
+    Cable* cable = new Cable(this, computer->getNetworkInterfaceCard(), m_portBufferSize, &m_dataNotifier, (uint32_t)m_connections.size());
+    m_connections.push_back(cable);
+}
+
+bool TransmissionHub::eventDriven() const
+{
+    return m_simulator != nullptr;
+}
+
+// Appele dans le contexte du noeud qui envoie : le bruit et la livraison ne dependent que de ce noeud
+void TransmissionHub::broadcast(SharedDataBuffer data, Cable* from)
+{
+    noise(data, from->port());
+    for (size_t partition = 0; partition < m_partitionPorts.size(); ++partition)
+    {
+        if (!m_partitionPorts[partition].empty())
+        {
+            m_simulator->scheduleOnPartition(partition, m_latency, [this, data, from, partition]() { dispatchToPartition(data, from, partition); });
+        }
+    }
+}
+
+bool TransmissionHub::dataReceived() const
+{
+    for (auto it = m_connections.cbegin(); it != m_connections.cend(); ++it)
+    {
+        if ((*it)->dataReady())
+        {
+            return true;
+        }
+    }
+    return false;
 }
 
 void TransmissionHub::transmit()
 {
     while (!m_stop)
     {        
-        if (m_dataQueue.canRead<HubData>())
+        if (!transmitStep())
         {
-            HubData data = m_dataQueue.pop<HubData>();
-            for (auto it = m_connections.cbegin(); it != m_connections.cend(); ++it)
-            {
-                if (data.from != (*it))
-                {
-                    //Logger log(std::cout);
-                    //log << "HUB - Sending data to " << (*it)->getConnectedNIC().getDriver().getMACAddress() << std::endl;
-                    DynamicDataBuffer buffer = data.data;
-                    (*it)->sendToCard(buffer);
-                }
-            }
+            m_dataNotifier.wait([this]() { return m_stop || dataReceived(); });
         }
     }
 }
 
-void TransmissionHub::noise(DynamicDataBuffer& buffer)
+// Fait un tour des ports. Retourne faux si aucun port n'avait de donnees.
+bool TransmissionHub::transmitStep()
 {
-    m_interference->noise(buffer);
+    // On passe les ports a tour de role et on diffuse au plus un envoi par port a chaque tour
+    // pour qu'un ordinateur tres actif ne puisse pas monopoliser le concentrateur
+    bool transmitted = false;
+    for (size_t port = 0; port < m_connections.size(); ++port)
+    {
+        if (m_connections[port]->dataReady())
+        {
+            SharedDataBuffer data = m_connections[port]->getNextData();
+            // Le bruit est applique par le fil du concentrateur, une seule fois par envoi, sans bloquer les ordinateurs
+            noise(data, port);
+            dispatch(data, m_connections[port]);
+            transmitted = true;
+        }
+    }
+    return transmitted;
 }
 
-void TransmissionHub::receive_data_to_dispatch(const DynamicDataBuffer& data, Cable* from)
+void TransmissionHub::dispatch(const SharedDataBuffer& data, Cable* from)
 {
-    // Plusieurs ordinateurs peuvent envoyer un signal en meme temps. Il faut les synchroniser!
-    std::lock_guard<std::mutex> guard(m_mutex);
-    HubData hubData = { from, data };
-    // On applique le bruit sur le signal
-    noise(hubData.data);
-    if (m_dataQueue.canWrite<HubData>(hubData))
+    // Chaque port recoit une reference sur les memes octets : la diffusion ne copie rien
+    for (auto it = m_connections.cbegin(); it != m_connections.cend(); ++it)
     {
-        //Logger log(std::cout);
-        //log << "HUB - Received data from " << from->getConnectedNIC()->getDriver()->getMACAddress() << std::endl;
-        m_dataQueue.push(hubData);
+        if (from != (*it))
+        {
+            LOG_TRACE(LogCategory::Hub, "HUB - Sending data to {}", (*it)->getConnectedNIC().getDriver().getMACAddress());
+            Metrics::Add(Metric::HubFramesDispatched);
+            (*it)->sendToCard(data);
+        }
     }
-    else
+}
+
+void TransmissionHub::dispatchToPartition(const SharedDataBuffer& data, Cable* from, size_t partition)
+{
+    for (uint32_t port : m_partitionPorts[partition])
     {
-        Logger log(std::cout);
-        log << "Data lost - Transmission buffer full : " << std::endl;
-        log << "\tFrom : " << from->getConnectedNIC().getDriver().getMACAddress() << std::endl;
+        Cable* cable = m_connections[port];
+        if (from != cable)
+        {
+            LOG_TRACE(LogCategory::Hub, "HUB - Sending data to {}", cable->getConnectedNIC().getDriver().getMACAddress());
+            // La reception et ce qu'elle programme appartiennent au noeud destinataire
+            EventSimulator::NodeScope scope(*m_simulator, port);
+            Metrics::Add(Metric::HubFramesDispatched);
+            cable->sendToCard(data);
+        }
     }
+}
+
+void TransmissionHub::noise(SharedDataBuffer& buffer, size_t port)
+{
+    m_interferences[port]->noise(buffer);
 }
\ No newline at end of file
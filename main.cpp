@@ -1,8 +1,22 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "Computer/Computer.h"
+#include "DataStructures/BufferPool.h"
+#include "General/Executor.h"
+#include "General/LatencyHistogram.h"
+#include "General/Log.h"
+#include "General/LogWriter.h"
+#include "General/MetricsExporter.h"
+#include "General/TimerService.h"
+#include "Simulation/EventSimulator.h"
+#include "Simulation/GoodputBenchmark.h"
+#include "Simulation/Scenario.h"
 #include "Transmission/Transmission.h"
 
 struct Config
@@ -10,6 +24,13 @@ struct Config
     size_t NumberComputer = 2;
     size_t FirstNumber = 1;
     std::string GlobalConfigName = "";
+    std::string LogFileName = "";
+    std::string TraceFileName = "";
+    std::string ScenarioFileName = "";
+    std::string BenchmarkFileName = "";
+    std::string MetricsFileName = "";
+    double WallTimeLimit = 0.0; // En secondes, 0 pour aucune limite
+    double SimulatedTimeLimit = 0.0; // En secondes de temps simule, ou de temps reel hors simulation a evenements discrets
 };
 
 Config parse_arguments(int argc, char *argv[])
@@ -72,6 +93,90 @@ Config parse_arguments(int argc, char *argv[])
                 std::cout << "Le parametre -g doit etre suivi du nom de fichier de configuration principal de la simulation." << std::endl;
             }
         }
+        else if (std::string(arg) == "-l")
+        {
+            if (i + 1 < argc)
+            {
+                std::cout << "Fichier de journalisation : " << argv[i + 1] << std::endl;
+                config.LogFileName = std::string(argv[i + 1]);
+            }
+            else
+            {
+                std::cout << "Le parametre -l doit etre suivi du nom du fichier de journalisation." << std::endl;
+            }
+        }
+        else if (std::string(arg) == "-t")
+        {
+            if (i + 1 < argc)
+            {
+                std::cout << "Trace binaire : " << argv[i + 1] << std::endl;
+                config.TraceFileName = std::string(argv[i + 1]);
+            }
+            else
+            {
+                std::cout << "Le parametre -t doit etre suivi du nom du fichier de trace binaire." << std::endl;
+            }
+        }
+        else if (std::string(arg) == "-s")
+        {
+            if (i + 1 < argc)
+            {
+                std::cout << "Scenario : " << argv[i + 1] << std::endl;
+                config.ScenarioFileName = std::string(argv[i + 1]);
+            }
+            else
+            {
+                std::cout << "Le parametre -s doit etre suivi du nom du fichier de scenario." << std::endl;
+            }
+        }
+        else if (std::string(arg) == "-b")
+        {
+            if (i + 1 < argc)
+            {
+                std::cout << "Resultats de la mesure de debit : " << argv[i + 1] << std::endl;
+                config.BenchmarkFileName = std::string(argv[i + 1]);
+            }
+            else
+            {
+                std::cout << "Le parametre -b doit etre suivi du nom du fichier JSON des resultats." << std::endl;
+            }
+        }
+        else if (std::string(arg) == "-m")
+        {
+            if (i + 1 < argc)
+            {
+                std::cout << "Export des metriques : " << argv[i + 1] << std::endl;
+                config.MetricsFileName = std::string(argv[i + 1]);
+            }
+            else
+            {
+                std::cout << "Le parametre -m doit etre suivi du nom du fichier des metriques (format Prometheus, ou CSV si le nom finit par .csv)." << std::endl;
+            }
+        }
+        else if (std::string(arg) == "-w")
+        {
+            if (i + 1 < argc)
+            {
+                std::cout << "Duree maximale en temps reel : " << argv[i + 1] << " s" << std::endl;
+                config.WallTimeLimit = std::stod(argv[i + 1]);
+            }
+            else
+            {
+                std::cout << "Le parametre -w doit etre suivi de la duree maximale de la simulation en secondes de temps reel." << std::endl;
+            }
+        }
+        else if (std::string(arg) == "-d")
+        {
+            if (i + 1 < argc)
+            {
+                std::cout << "Duree maximale en temps simule : " << argv[i + 1] << " s" << std::endl;
+                config.SimulatedTimeLimit = std::stod(argv[i + 1]);
+            }
+            else
+            {
+                std::cout << "Le parametre -d doit etre suivi de la duree maximale de la simulation en secondes de temps simule." << std::endl;
+            }
+        }
     }
 
     return config;
@@ -82,34 +187,124 @@ int main(int argc, char *argv[])
     Config config = parse_arguments(argc, argv);
     Configuration globalConfig(config.GlobalConfigName);
 
+    // Le scenario remplace -c, -f et les fichiers ComputerN.txt ; ses instructions global s'ajoutent a la configuration de -g
+    std::unique_ptr<Scenario> scenario;
+    if (!config.ScenarioFileName.empty())
+    {
+        try
+        {
+            scenario = std::make_unique<Scenario>(Scenario::Load(config.ScenarioFileName, globalConfig));
+        }
+        catch (const std::invalid_argument& e)
+        {
+            std::cout << e.what() << std::endl;
+            return 1;
+        }
+        globalConfig = scenario->globalConfiguration();
+    }
+
+    // Avant la creation des fils qui journalisent, pour que leurs buffers aient la taille configuree
+    LogWriter::Instance().setThreadBufferSize((size_t)std::max(globalConfig.get(Configuration::LOG_THREAD_BUFFER_SIZE), 1));
+
+    // En simulation a evenements discrets, le fil principal execute tout en temps virtuel : ni timers ni Executor ne sont crees
+    EventSimulator::ConfigureShared(globalConfig);
+    if (!EventSimulator::Enabled())
+    {
+        // Les timers de tous les ordinateurs sont partages : leur configuration vient de la configuration globale
+        TimerService::ConfigureShared(globalConfig);
+        // Les boucles des couches s'executent dans leurs propres fils ou comme des taches de l'Executor, pour tous les ordinateurs
+        Executor::ConfigureShared(globalConfig);
+    }
+    if (!config.LogFileName.empty() && !LogWriter::Instance().setOutputFile(config.LogFileName))
+    {
+        std::cout << "Impossible d'ouvrir le fichier de journalisation " << config.LogFileName << ", les journaux restent sur la sortie standard." << std::endl;
+    }
+    // La trace binaire remplace les journaux texte, elle se lit avec TraceDecoder
+    if (!config.TraceFileName.empty() && !Log::EnableBinaryTrace(config.TraceFileName))
+    {
+        std::cout << "Impossible de creer la trace binaire " << config.TraceFileName << ", les journaux restent en texte." << std::endl;
+    }
+    // Mesure sans interface : seuls les avertissements et les erreurs sont journalises, pour ne pas fausser le debit
+    if (!config.BenchmarkFileName.empty())
+    {
+        Log::SetMinimumLevel(LogLevel::Warning);
+    }
+
     std::cout << "Demarrage du simulateur..." << std::endl;
 
     TransmissionHub hub(globalConfig);
 
-    std::vector<Computer*> computers;
-    // Create computer and connect it to Hub
-    for (size_t i = 0; i < config.NumberComputer; ++i)
+    // Les ordinateurs sont construits en parallele, sans demarrer leurs fils d'execution
+    // Une adresse MAC invalide ou deja utilisee est signalee comme une erreur de scenario
+    std::vector<std::unique_ptr<Computer>> computers;
+    try
     {
-        Computer* computer = new Computer(i+config.FirstNumber);
-        hub.connect_computer(computer);
-        computers.push_back(computer);
+        if (scenario)
+        {
+            computers = scenario->createComputers();
+            scenario.reset();
+        }
+        else
+        {
+            computers = Scenario::CreateInParallel(config.NumberComputer, [&config](size_t index)
+            {
+                return std::make_unique<Computer>(index + config.FirstNumber);
+            });
+        }
+    }
+    catch (const std::invalid_argument& e)
+    {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+    for (const std::unique_ptr<Computer>& computer : computers)
+    {
+        hub.connect_computer(computer.get());
+    }
+    // Les metriques sont exportees en temps reel pendant toute la simulation, jusqu'a l'arret du trafic
+    std::unique_ptr<MetricsExporter> metricsExporter;
+    if (!config.MetricsFileName.empty())
+    {
+        metricsExporter = std::make_unique<MetricsExporter>(config.MetricsFileName, globalConfig);
+        if (!metricsExporter->start())
+        {
+            std::cout << "Impossible de creer le fichier des metriques " << config.MetricsFileName << "." << std::endl;
+            metricsExporter.reset();
+        }
+    }
+    std::unique_ptr<GoodputBenchmark> benchmark;
+    if (!config.BenchmarkFileName.empty())
+    {
+        benchmark = std::make_unique<GoodputBenchmark>(computers);
     }
     hub.start();
 
-    for (auto computer : computers)
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+    if (benchmark)
+    {
+        benchmark->start();
+    }
+
+    for (size_t i = 0; i < computers.size(); ++i)
     {
-        computer->start();
+        if (EventSimulator::Enabled())
+        {
+            // Le noeud d'un ordinateur est son port sur le concentrateur : ses premiers evenements vont dans la file de sa partition
+            EventSimulator::NodeScope scope(EventSimulator::Shared(), (uint32_t)i);
+            computers[i]->start();
+        }
+        else
+        {
+            computers[i]->start();
+        }
     }
 
-    unsigned int numbercomputerFinished = 0;
-    unsigned int numberFileReceived = 0;
-    unsigned int numberFileSent = 0;
-    do
+    auto simulationFinished = [&computers]()
     {
-        numbercomputerFinished = 0;
-        numberFileReceived = 0;
-        numberFileSent = 0;
-        for (const Computer* computer : computers)
+        unsigned int numbercomputerFinished = 0;
+        unsigned int numberFileReceived = 0;
+        unsigned int numberFileSent = 0;
+        for (const std::unique_ptr<Computer>& computer : computers)
         {
             if (computer->sendingTerminated())
             {
@@ -118,14 +313,88 @@ int main(int argc, char *argv[])
             numberFileSent += computer->sentFileCount();
             numberFileReceived += computer->receivedFileCount();
         }
-    } while (numbercomputerFinished != computers.size() || numberFileReceived != numberFileSent);
+        return numbercomputerFinished == computers.size() && numberFileReceived == numberFileSent;
+    };
+
+    // Avec du bruit, un transfert peut ne jamais se terminer : les limites de -w et -d arretent la simulation quand meme
+    auto timeLimitReached = [&config, wallStart]()
+    {
+        double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        double simulatedSeconds = EventSimulator::Enabled() ? std::chrono::duration<double>(EventSimulator::Shared().now()).count() : wallSeconds;
+        return (config.WallTimeLimit > 0.0 && wallSeconds >= config.WallTimeLimit)
+            || (config.SimulatedTimeLimit > 0.0 && simulatedSeconds >= config.SimulatedTimeLimit);
+    };
+
+    bool completed = false;
+    bool limitReached = false;
+    if (EventSimulator::Enabled())
+    {
+        EventSimulator& simulator = EventSimulator::Shared();
+        completed = simulator.run([&simulationFinished, &timeLimitReached, &limitReached]()
+        {
+            if (simulationFinished())
+            {
+                return true;
+            }
+            limitReached = timeLimitReached();
+            return limitReached;
+        });
+        if (!completed)
+        {
+            std::cout << "La simulation s'est arretee avant la fin des envois : plus aucun evenement n'etait programme." << std::endl;
+        }
+        completed = completed && !limitReached;
+        std::cout << "Temps simule : " << std::chrono::duration_cast<std::chrono::milliseconds>(simulator.now()).count() << " ms, "
+                  << simulator.processedEventCount() << " evenements, " << simulator.partitionCount() << " partitions." << std::endl;
+        // Les taches encore programmees ne seront jamais executees : l'arret des ordinateurs ne doit pas les attendre
+        simulator.stop();
+    }
+    else
+    {
+        while (!simulationFinished())
+        {
+            if (timeLimitReached())
+            {
+                limitReached = true;
+                break;
+            }
+            // Le fil principal ne fait que surveiller : il laisse le processeur aux ordinateurs entre deux verifications
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        completed = !limitReached;
+    }
+    if (limitReached)
+    {
+        std::cout << "La duree maximale est atteinte avant la fin des envois : la simulation est arretee." << std::endl;
+    }
+
+    if (benchmark)
+    {
+        benchmark->finish(completed);
+        std::ofstream benchmarkFile(config.BenchmarkFileName);
+        if (benchmarkFile)
+        {
+            benchmark->writeJson(benchmarkFile, globalConfig);
+        }
+        else
+        {
+            std::cout << "Impossible d'ouvrir le fichier de resultats " << config.BenchmarkFileName << "." << std::endl;
+        }
+        benchmark.reset();
+    }
+    if (metricsExporter)
+    {
+        metricsExporter->stop();
+    }
     
+    // Les journaux en attente sont ecrits avant les messages d'arret
+    LogWriter::Instance().flush();
 
     std::cout << "Arret du simulateur..." << std::endl;
     hub.stop();
-    for (auto computer : computers)
-    {
-        delete computer;
-    }
     computers.clear();
+    LogWriter::Instance().flush();
+
+    std::cout << "Statistiques du pool de buffers : " << BufferPool::statistics() << std::endl;
+    Latencies::WriteSummary(std::cout);
 }
\ No newline at end of file